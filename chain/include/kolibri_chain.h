@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "kolibri_pack.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,24 +16,52 @@ extern "C" {
 #define CHAIN_HASH_SIZE 32
 #define CHAIN_PUBKEY_SIZE 32
 #define CHAIN_SIGNATURE_SIZE 64
-#define CHAIN_MAX_FORMULAS_PER_BLOCK 100
+#define CHAIN_MAX_FORMULAS_PER_BLOCK (1u << 20) /* Sanity bound for decoding */
 
-/* Block structure */
+/* Block structure. formula_ids points to formula_count IDs: the caller's
+ * array for blocks built by chain_create_block, chain-owned storage for
+ * blocks returned by the chain (valid until chain_destroy). */
 typedef struct {
     uint8_t prev_hash[CHAIN_HASH_SIZE];
     uint8_t merkle_root[CHAIN_HASH_SIZE];
     uint8_t author_pub[CHAIN_PUBKEY_SIZE];
     uint64_t timestamp;
     uint32_t block_number;
-    uint8_t formula_ids[CHAIN_MAX_FORMULAS_PER_BLOCK][32];
     uint32_t formula_count;
+    const uint8_t (*formula_ids)[32];
     uint8_t signature[CHAIN_SIGNATURE_SIZE];
 } kolibri_block_t;
 
+/*
+ * Compact block encoding, used for hashing, export and the block log.
+ * All integers are little-endian:
+ *
+ *   0    prev_hash[32]
+ *   32   merkle_root[32]
+ *   64   author_pub[32]
+ *   96   timestamp      u64
+ *   104  block_number   u32
+ *   108  formula_count  u32
+ *   112  formula_ids[formula_count][32]
+ *   ...  signature[64]
+ *
+ * The block hash covers everything before the signature.
+ */
+#define CHAIN_BLOCK_HEADER_SIZE 112
+#define CHAIN_BLOCK_ENCODED_SIZE(count) \
+    (CHAIN_BLOCK_HEADER_SIZE + (size_t)(count) * 32 + CHAIN_SIGNATURE_SIZE)
+
+size_t chain_block_encode(const kolibri_block_t* block, uint8_t* buf, size_t buf_size);
+int chain_block_decode(const uint8_t* buf, size_t len, kolibri_block_t* block, size_t* consumed);
+int chain_block_hash(const kolibri_block_t* block, uint8_t* hash);
+
 /* Chain context */
 typedef struct kolibri_chain_t kolibri_chain_t;
 
-/* Initialize chain */
+/* Initialize chain. When storage_path names a writable directory, blocks are
+ * persisted to an append-only log there and replayed on the next init; a
+ * torn final record is dropped, but a log that is otherwise unreadable or
+ * fails verification makes init return NULL and is left untouched. */
 kolibri_chain_t* chain_init(const char* storage_path);
 void chain_destroy(kolibri_chain_t* chain);
 
@@ -40,10 +69,33 @@ void chain_destroy(kolibri_chain_t* chain);
 int chain_create_block(kolibri_chain_t* chain, const uint8_t* author_private_key,
                       const uint8_t formula_ids[][32], uint32_t formula_count,
                       kolibri_block_t* block);
-int chain_add_block(kolibri_chain_t* chain, const kolibri_block_t* block);
+int chain_add_block(kolibri_chain_t* chain, const kolibri_block_t* block); /* Appends block_count */
 int chain_get_block(kolibri_chain_t* chain, uint32_t block_number, kolibri_block_t* block);
 int chain_get_latest_block(kolibri_chain_t* chain, kolibri_block_t* block);
-int chain_verify_block(kolibri_chain_t* chain, const kolibri_block_t* block);
+int chain_verify_block(kolibri_chain_t* chain, const kolibri_block_t* block); /* Merkle root and link */
+
+/*
+ * Merkle tree over a block's formula IDs. Leaves are H(0x00 || id), inner
+ * nodes H(0x01 || left || right); an unpaired node is promoted to the next
+ * level unchanged. A proof lists the siblings from leaf to root.
+ */
+#define CHAIN_MERKLE_MAX_DEPTH 32
+
+typedef struct {
+    uint32_t block_number;
+    uint32_t leaf_index;
+    uint32_t leaf_count;
+    uint32_t sibling_count;
+    uint8_t siblings[CHAIN_MERKLE_MAX_DEPTH][CHAIN_HASH_SIZE];
+} chain_merkle_proof_t;
+
+/* Formula index: most recent block committing formula_id */
+int chain_find_formula(kolibri_chain_t* chain, const uint8_t* formula_id,
+                       uint32_t* block_number, uint32_t* leaf_index);
+int chain_merkle_prove(kolibri_chain_t* chain, const uint8_t* formula_id,
+                       chain_merkle_proof_t* proof);
+int chain_merkle_verify(const uint8_t* merkle_root, const uint8_t* formula_id,
+                        const chain_merkle_proof_t* proof);
 
 /* Chain info */
 typedef struct {
@@ -56,7 +108,48 @@ int chain_get_info(kolibri_chain_t* chain, chain_info_t* info);
 
 /* Export/Import chain */
 int chain_export(kolibri_chain_t* chain, const char* path);
-int chain_import(kolibri_chain_t* chain, const char* path);
+int chain_import(kolibri_chain_t* chain, const char* path); /* Also accepts packs */
+
+/* Compressed packs (kolibri_pack.h) of the encoded blocks. Import hashes
+ * and appends each frame while up to `threads` workers (0 = one per CPU)
+ * decompress the next ones. stats may be NULL. */
+int chain_export_pack(kolibri_chain_t* chain, const char* path, kolibri_pack_stats_t* stats);
+int chain_import_pack(kolibri_chain_t* chain, const char* path, uint32_t threads,
+                      kolibri_pack_stats_t* stats);
+
+/*
+ * Whole-chain verification of an export file or a blocks.log, streamed
+ * through a pipeline: read -> hash -> Merkle -> signature -> link. Blocks
+ * signed by chain_create_block carry an Ed25519 signature over their hash;
+ * unsigned blocks have an all-zero author_pub and signature.
+ *
+ * With a checkpoint, blocks before checkpoint->block_number are skipped and
+ * that block is accepted if its hash matches; the report's last field can
+ * be saved as the next checkpoint. threads = 0 uses one per online CPU.
+ * Returns CHAIN_ERROR_VERIFICATION with failed_block/failed_stage set at
+ * the first failing block.
+ */
+#define CHAIN_STAGE_NONE 0
+#define CHAIN_STAGE_READ 1      /* Bad record, or data ended early */
+#define CHAIN_STAGE_HASH 2      /* Checkpoint hash mismatch */
+#define CHAIN_STAGE_MERKLE 3
+#define CHAIN_STAGE_SIGNATURE 4
+#define CHAIN_STAGE_LINK 5      /* Block number or prev_hash mismatch */
+
+typedef struct {
+    uint32_t block_number;
+    uint8_t hash[CHAIN_HASH_SIZE];
+} chain_checkpoint_t;
+
+typedef struct {
+    uint32_t blocks_verified;  /* Blocks after the checkpoint that passed */
+    chain_checkpoint_t last;   /* Last block that passed */
+    uint32_t failed_block;
+    int failed_stage;          /* CHAIN_STAGE_* */
+} chain_verify_report_t;
+
+int chain_verify_file(const char* path, const chain_checkpoint_t* checkpoint, uint32_t threads,
+                      chain_verify_report_t* report);
 
 /* Error codes */
 #define CHAIN_OK 0
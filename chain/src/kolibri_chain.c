@@ -3,34 +3,593 @@
  */
 
 #include "kolibri_chain.h"
+#include "kolibri_sha256.h"
+#include "kolibri_ed25519.h"
+#include "kolibri_pack.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
-/* Simple hash function (would use SHA-256 in production) */
-static void simple_hash(const void* data, size_t len, uint8_t* hash) {
-    memset(hash, 0, CHAIN_HASH_SIZE);
-    const uint8_t* bytes = (const uint8_t*)data;
-    for (size_t i = 0; i < len; i++) {
-        hash[i % CHAIN_HASH_SIZE] ^= bytes[i];
-        hash[(i + 1) % CHAIN_HASH_SIZE] = (hash[(i + 1) % CHAIN_HASH_SIZE] + bytes[i]) & 0xFF;
+#define CHAIN_EXPORT_MAGIC 0x4B434832 /* "KCH2" */
+#define CHAIN_LOG_MAGIC 0x4B434C32    /* "KCL2" */
+#define CHAIN_LOG_NAME "blocks.log"
+#define CHAIN_INITIAL_CAPACITY 64
+#define CHAIN_ID_SLAB_SIZE 4096
+#define CHAIN_INDEX_INITIAL_SIZE 1024
+#define CHAIN_READ_WINDOW 64
+#define MERKLE_BATCH 256
+#define VERIFY_SLOT_BLOCKS 64
+#define VERIFY_SLOT_BYTES (1u << 20)
+#define VERIFY_MAX_THREADS 16
+
+/* Little-endian field helpers for the compact encoding */
+static void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static void encode_header(const kolibri_block_t* block, uint8_t* header) {
+    memcpy(header, block->prev_hash, CHAIN_HASH_SIZE);
+    memcpy(header + 32, block->merkle_root, CHAIN_HASH_SIZE);
+    memcpy(header + 64, block->author_pub, CHAIN_PUBKEY_SIZE);
+    put_u64(header + 96, block->timestamp);
+    put_u32(header + 104, block->block_number);
+    put_u32(header + 108, block->formula_count);
+}
+
+/* Encode block; returns bytes written, or 0 if buf is too small */
+size_t chain_block_encode(const kolibri_block_t* block, uint8_t* buf, size_t buf_size) {
+    if (!block || !buf || (block->formula_count > 0 && !block->formula_ids)) return 0;
+    
+    size_t size = CHAIN_BLOCK_ENCODED_SIZE(block->formula_count);
+    if (buf_size < size) return 0;
+    
+    encode_header(block, buf);
+    if (block->formula_count > 0) {
+        memcpy(buf + CHAIN_BLOCK_HEADER_SIZE, block->formula_ids, (size_t)block->formula_count * 32);
     }
+    memcpy(buf + size - CHAIN_SIGNATURE_SIZE, block->signature, CHAIN_SIGNATURE_SIZE);
+    
+    return size;
+}
+
+/* Decode block; formula_ids points into buf */
+int chain_block_decode(const uint8_t* buf, size_t len, kolibri_block_t* block, size_t* consumed) {
+    if (!buf || !block) return CHAIN_ERROR_INVALID_PARAM;
+    if (len < CHAIN_BLOCK_HEADER_SIZE) return CHAIN_ERROR;
+    
+    uint32_t count = get_u32(buf + 108);
+    if (count > CHAIN_MAX_FORMULAS_PER_BLOCK) return CHAIN_ERROR;
+    
+    size_t size = CHAIN_BLOCK_ENCODED_SIZE(count);
+    if (len < size) return CHAIN_ERROR;
+    
+    memcpy(block->prev_hash, buf, CHAIN_HASH_SIZE);
+    memcpy(block->merkle_root, buf + 32, CHAIN_HASH_SIZE);
+    memcpy(block->author_pub, buf + 64, CHAIN_PUBKEY_SIZE);
+    block->timestamp = get_u64(buf + 96);
+    block->block_number = get_u32(buf + 104);
+    block->formula_count = count;
+    block->formula_ids = count > 0 ? (const uint8_t (*)[32])(buf + CHAIN_BLOCK_HEADER_SIZE) : NULL;
+    memcpy(block->signature, buf + size - CHAIN_SIGNATURE_SIZE, CHAIN_SIGNATURE_SIZE);
+    
+    if (consumed) *consumed = size;
+    return CHAIN_OK;
 }
 
-/* Block storage */
-typedef struct block_entry_t {
+/* Hash of the compact encoding without the signature */
+int chain_block_hash(const kolibri_block_t* block, uint8_t* hash) {
+    if (!block || !hash) return CHAIN_ERROR_INVALID_PARAM;
+    if (block->formula_count > 0 && !block->formula_ids) return CHAIN_ERROR_INVALID_PARAM;
+    
+    uint8_t header[CHAIN_BLOCK_HEADER_SIZE];
+    encode_header(block, header);
+    
+    kolibri_sha256_ctx_t ctx;
+    kolibri_sha256_init(&ctx);
+    kolibri_sha256_update(&ctx, header, sizeof(header));
+    if (block->formula_count > 0) {
+        kolibri_sha256_update(&ctx, block->formula_ids, (size_t)block->formula_count * 32);
+    }
+    kolibri_sha256_final(&ctx, hash);
+    
+    return CHAIN_OK;
+}
+
+/* Number of nodes in a Merkle tree over count leaves, all levels included */
+static size_t merkle_node_count(uint32_t count) {
+    size_t total = 0;
+    size_t level = count;
+    while (level > 1) {
+        total += level;
+        level = (level + 1) / 2;
+    }
+    return total + level;
+}
+
+static void merkle_leaf(const uint8_t* id, uint8_t* hash) {
+    uint8_t msg[1 + 32];
+    msg[0] = 0x00;
+    memcpy(msg + 1, id, 32);
+    kolibri_sha256(msg, sizeof(msg), hash);
+}
+
+static void merkle_node(const uint8_t* left, const uint8_t* right, uint8_t* hash) {
+    uint8_t msg[1 + 2 * CHAIN_HASH_SIZE];
+    msg[0] = 0x01;
+    memcpy(msg + 1, left, CHAIN_HASH_SIZE);
+    memcpy(msg + 1 + CHAIN_HASH_SIZE, right, CHAIN_HASH_SIZE);
+    kolibri_sha256(msg, sizeof(msg), hash);
+}
+
+/* Hash count messages of one prefix byte followed by parts * 32 input bytes */
+static void merkle_hash_batch(uint8_t prefix, const uint8_t (*in)[32], size_t parts,
+                              size_t count, uint8_t (*out)[32]) {
+    uint8_t msgs[MERKLE_BATCH][1 + 2 * CHAIN_HASH_SIZE];
+    const uint8_t* ptrs[MERKLE_BATCH];
+    size_t lens[MERKLE_BATCH];
+    
+    for (size_t done = 0; done < count; ) {
+        size_t n = count - done < MERKLE_BATCH ? count - done : MERKLE_BATCH;
+        for (size_t i = 0; i < n; i++) {
+            msgs[i][0] = prefix;
+            memcpy(msgs[i] + 1, in[(done + i) * parts], parts * 32);
+            ptrs[i] = msgs[i];
+            lens[i] = 1 + parts * 32;
+        }
+        kolibri_sha256_batch(ptrs, lens, n, out + done);
+        done += n;
+    }
+}
+
+/* Build every level of the tree into nodes, leaves first, root last */
+static void merkle_build(const uint8_t (*ids)[32], uint32_t count, uint8_t (*nodes)[32]) {
+    merkle_hash_batch(0x00, ids, 1, count, nodes);
+    
+    size_t level = 0;
+    size_t size = count;
+    while (size > 1) {
+        uint8_t (*parent)[32] = nodes + level + size;
+        merkle_hash_batch(0x01, (const uint8_t (*)[32])(nodes + level), 2, size / 2, parent);
+        if (size & 1) {
+            memcpy(parent[size / 2], nodes[level + size - 1], CHAIN_HASH_SIZE);
+        }
+        level += size;
+        size = (size + 1) / 2;
+    }
+}
+
+/* Block storage: blocks[n] holds block number n */
+typedef struct {
     kolibri_block_t block;
-    struct block_entry_t* next;
+    const uint8_t (*tree)[32];     /* merkle_build() levels, NULL if empty */
+    uint8_t hash[CHAIN_HASH_SIZE]; /* Cached chain_block_hash() */
 } block_entry_t;
 
+/* IDs and tree nodes are packed into slabs so block pointers stay stable */
+typedef struct hash_slab_t {
+    struct hash_slab_t* next;
+    size_t used;
+    size_t capacity;
+    uint8_t hashes[][32];
+} hash_slab_t;
+
+/* Formula index slot; block_number is stored +1 so zero marks an empty slot */
+typedef struct {
+    uint8_t id[32];
+    uint32_t block_plus_one;
+    uint32_t leaf_index;
+} index_slot_t;
+
 /* Chain context */
 struct kolibri_chain_t {
     char storage_path[256];
-    block_entry_t* head;
+    block_entry_t* blocks;
     uint32_t block_count;
+    uint32_t block_capacity;
+    uint64_t total_formulas;
+    hash_slab_t* slabs;
+    index_slot_t* index;
+    uint32_t index_size; /* Power of two */
+    uint32_t index_used;
+    FILE* log; /* Append-only block log, NULL when running in memory */
+    uint8_t* scratch; /* Blocks read from a file */
+    size_t scratch_size;
+    uint8_t* encoded; /* Block being written */
+    size_t encoded_size;
+    uint8_t (*tree)[32]; /* Merkle tree of the block being verified */
+    size_t tree_size;
+};
+
+/* Grow a buffer to at least size bytes */
+static uint8_t* grow_buffer(uint8_t** buf, size_t* capacity, size_t size) {
+    if (*capacity < size) {
+        size_t grown = *capacity * 2 > size ? *capacity * 2 : size;
+        uint8_t* resized = (uint8_t*)realloc(*buf, grown);
+        if (!resized) return NULL;
+        *buf = resized;
+        *capacity = grown;
+    }
+    return *buf;
+}
+
+/* Make sure the newest slab has room for count more hashes */
+static int reserve_hashes(kolibri_chain_t* chain, size_t count) {
+    hash_slab_t* slab = chain->slabs;
+    if (slab && slab->capacity - slab->used >= count) return CHAIN_OK;
+    
+    size_t capacity = count > CHAIN_ID_SLAB_SIZE ? count : CHAIN_ID_SLAB_SIZE;
+    slab = (hash_slab_t*)malloc(sizeof(hash_slab_t) + capacity * 32);
+    if (!slab) return CHAIN_ERROR;
+    slab->used = 0;
+    slab->capacity = capacity;
+    slab->next = chain->slabs;
+    chain->slabs = slab;
+    return CHAIN_OK;
+}
+
+/* Copy count hashes into chain-owned storage */
+static const uint8_t (*store_hashes(kolibri_chain_t* chain, const uint8_t (*hashes)[32],
+                                    size_t count))[32] {
+    if (reserve_hashes(chain, count) != CHAIN_OK) return NULL;
+    
+    hash_slab_t* slab = chain->slabs;
+    uint8_t (*dest)[32] = &slab->hashes[slab->used];
+    memcpy(dest, hashes, count * 32);
+    slab->used += count;
+    return (const uint8_t (*)[32])dest;
+}
+
+/* Build the Merkle tree of ids into chain->tree */
+static int chain_build_tree(kolibri_chain_t* chain, const uint8_t (*ids)[32], uint32_t count) {
+    size_t nodes = merkle_node_count(count);
+    if (chain->tree_size < nodes) {
+        uint8_t (*tree)[32] = (uint8_t (*)[32])realloc(chain->tree, nodes * 32);
+        if (!tree) return CHAIN_ERROR;
+        chain->tree = tree;
+        chain->tree_size = nodes;
+    }
+    
+    merkle_build(ids, count, chain->tree);
+    return CHAIN_OK;
+}
+
+/* Root of the tree last built by chain_build_tree */
+static void chain_tree_root(kolibri_chain_t* chain, uint32_t count, uint8_t* root) {
+    if (count == 0) {
+        memset(root, 0, CHAIN_HASH_SIZE);
+        return;
+    }
+    memcpy(root, chain->tree[merkle_node_count(count) - 1], CHAIN_HASH_SIZE);
+}
+
+/* Mix a formula ID down to a table position; IDs may share long prefixes */
+static uint32_t index_hash(const uint8_t* id) {
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 32; i += 8) {
+        h ^= get_u64(id + i);
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    return (uint32_t)h;
+}
+
+static index_slot_t* index_lookup(index_slot_t* index, uint32_t size, const uint8_t* id) {
+    uint32_t mask = size - 1;
+    uint32_t pos = index_hash(id) & mask;
+    while (index[pos].block_plus_one != 0 && memcmp(index[pos].id, id, 32) != 0) {
+        pos = (pos + 1) & mask;
+    }
+    return &index[pos];
+}
+
+static int index_grow(kolibri_chain_t* chain) {
+    uint32_t size = chain->index_size ? chain->index_size * 2 : CHAIN_INDEX_INITIAL_SIZE;
+    index_slot_t* index = (index_slot_t*)calloc(size, sizeof(index_slot_t));
+    if (!index) return CHAIN_ERROR;
+    
+    for (uint32_t i = 0; i < chain->index_size; i++) {
+        if (chain->index[i].block_plus_one != 0) {
+            *index_lookup(index, size, chain->index[i].id) = chain->index[i];
+        }
+    }
+    
+    free(chain->index);
+    chain->index = index;
+    chain->index_size = size;
+    return CHAIN_OK;
+}
+
+/* Point each ID of block at its leaf, replacing older commitments */
+static int index_add_block(kolibri_chain_t* chain, const kolibri_block_t* block) {
+    for (uint32_t i = 0; i < block->formula_count; i++) {
+        if ((chain->index_used + 1) * 2 > chain->index_size && index_grow(chain) != CHAIN_OK) {
+            return CHAIN_ERROR;
+        }
+        
+        index_slot_t* slot = index_lookup(chain->index, chain->index_size, block->formula_ids[i]);
+        if (slot->block_plus_one == 0) {
+            memcpy(slot->id, block->formula_ids[i], 32);
+            chain->index_used++;
+        }
+        slot->block_plus_one = block->block_number + 1;
+        slot->leaf_index = i;
+    }
+    return CHAIN_OK;
+}
+
+/* Make room for one more block of formula_count formulas, so that
+ * chain_append cannot fail once this succeeds */
+static int chain_reserve(kolibri_chain_t* chain, uint32_t formula_count) {
+    if (chain->block_count == chain->block_capacity) {
+        uint32_t capacity = chain->block_capacity ? chain->block_capacity * 2 : CHAIN_INITIAL_CAPACITY;
+        block_entry_t* blocks = (block_entry_t*)realloc(chain->blocks, sizeof(block_entry_t) * capacity);
+        if (!blocks) return CHAIN_ERROR;
+        
+        chain->blocks = blocks;
+        chain->block_capacity = capacity;
+    }
+    
+    /* IDs and tree go to the same slab */
+    if (formula_count > 0 &&
+        reserve_hashes(chain, formula_count + merkle_node_count(formula_count)) != CHAIN_OK) {
+        return CHAIN_ERROR;
+    }
+    while ((uint64_t)(chain->index_used + formula_count) * 2 > chain->index_size) {
+        if (index_grow(chain) != CHAIN_OK) return CHAIN_ERROR;
+    }
+    return CHAIN_OK;
+}
+
+/* Drop all blocks; used when adopting an imported genesis */
+static void chain_reset(kolibri_chain_t* chain) {
+    chain->block_count = 0;
+    chain->total_formulas = 0;
+    chain->index_used = 0;
+    if (chain->index) memset(chain->index, 0, sizeof(index_slot_t) * chain->index_size);
+}
+
+/* Append a block whose Merkle tree is in chain->tree; hash may be precomputed */
+static int chain_append(kolibri_chain_t* chain, const kolibri_block_t* block, const uint8_t* hash) {
+    if (chain_reserve(chain, block->formula_count) != CHAIN_OK) return CHAIN_ERROR;
+    
+    block_entry_t* entry = &chain->blocks[chain->block_count];
+    entry->block = *block;
+    entry->block.formula_ids = NULL;
+    entry->tree = NULL;
+    if (block->formula_count > 0) {
+        entry->block.formula_ids = store_hashes(chain, block->formula_ids, block->formula_count);
+        entry->tree = store_hashes(chain, (const uint8_t (*)[32])chain->tree,
+                                   merkle_node_count(block->formula_count));
+        if (!entry->block.formula_ids || !entry->tree) return CHAIN_ERROR;
+    }
+    if (index_add_block(chain, &entry->block) != CHAIN_OK) return CHAIN_ERROR;
+    
+    if (hash) {
+        memcpy(entry->hash, hash, CHAIN_HASH_SIZE);
+    } else {
+        chain_block_hash(block, entry->hash);
+    }
+    chain->block_count++;
+    chain->total_formulas += block->formula_count;
+    
+    return CHAIN_OK;
+}
+
+/* Write one encoded block */
+static int write_block(kolibri_chain_t* chain, FILE* f, const kolibri_block_t* block) {
+    size_t size = CHAIN_BLOCK_ENCODED_SIZE(block->formula_count);
+    uint8_t* buf = grow_buffer(&chain->encoded, &chain->encoded_size, size);
+    if (!buf || chain_block_encode(block, buf, size) != size) return CHAIN_ERROR;
+    
+    return fwrite(buf, size, 1, f) == 1 ? CHAIN_OK : CHAIN_ERROR;
+}
+
+/* Outcome of reading one block record */
+enum {
+    RECORD_OK,
+    RECORD_END,  /* End of file where a record would start */
+    RECORD_TORN, /* The record runs past end of file */
+    RECORD_BAD,  /* Impossible header, or a read error */
+    RECORD_NOMEM
 };
 
+/* A run of blocks read from a file, hashed together */
+typedef struct {
+    kolibri_block_t blocks[CHAIN_READ_WINDOW];
+    uint8_t hashes[CHAIN_READ_WINDOW][CHAIN_HASH_SIZE];
+    size_t offsets[CHAIN_READ_WINDOW];
+    long ends[CHAIN_READ_WINDOW]; /* File position after each block */
+    uint32_t count;
+    int status; /* RECORD_* that ended the window; RECORD_OK if it filled up */
+} block_window_t;
+
+/* Read len bytes; a short read is a torn record unless nothing at all was
+ * read where a record may start */
+static int read_record_bytes(FILE* f, uint8_t* dest, size_t len, int at_start) {
+    size_t got = fread(dest, 1, len, f);
+    if (got == len) return RECORD_OK;
+    if (ferror(f)) return RECORD_BAD;
+    return got == 0 && at_start ? RECORD_END : RECORD_TORN;
+}
+
+/* Read the header of the next encoded block to *buf + used */
+static int read_header(FILE* f, uint8_t** buf, size_t* capacity, size_t used) {
+    if (!grow_buffer(buf, capacity, used + CHAIN_BLOCK_HEADER_SIZE)) return RECORD_NOMEM;
+    int status = read_record_bytes(f, *buf + used, CHAIN_BLOCK_HEADER_SIZE, 1);
+    if (status != RECORD_OK) return status;
+    
+    return get_u32(*buf + used + 108) <= CHAIN_MAX_FORMULAS_PER_BLOCK ? RECORD_OK : RECORD_BAD;
+}
+
+/* Read the rest of the block whose header is at *buf + used */
+static int read_body(FILE* f, uint8_t** buf, size_t* capacity, size_t used) {
+    size_t size = CHAIN_BLOCK_ENCODED_SIZE(get_u32(*buf + used + 108));
+    if (!grow_buffer(buf, capacity, used + size)) return RECORD_NOMEM;
+    
+    return read_record_bytes(f, *buf + used + CHAIN_BLOCK_HEADER_SIZE, size - CHAIN_BLOCK_HEADER_SIZE, 0);
+}
+
+/* Read up to max encoded blocks into the scratch buffer and batch-hash them.
+ * Stops early at end of file, at a torn record or at a bad header, recording
+ * which in w->status. */
+static int read_window(kolibri_chain_t* chain, FILE* f, uint32_t max, block_window_t* w) {
+    size_t used = 0;
+    w->count = 0;
+    w->status = RECORD_OK;
+    
+    while (w->count < max && w->count < CHAIN_READ_WINDOW) {
+        int got = read_header(f, &chain->scratch, &chain->scratch_size, used);
+        if (got == RECORD_OK) got = read_body(f, &chain->scratch, &chain->scratch_size, used);
+        if (got == RECORD_NOMEM) return CHAIN_ERROR;
+        if (got != RECORD_OK) {
+            w->status = got;
+            break;
+        }
+        
+        size_t size = CHAIN_BLOCK_ENCODED_SIZE(get_u32(chain->scratch + used + 108));
+        w->offsets[w->count] = used;
+        w->ends[w->count] = ftell(f);
+        w->count++;
+        used += size;
+    }
+    
+    /* The hash input is the encoded record minus its signature */
+    const uint8_t* ptrs[CHAIN_READ_WINDOW];
+    size_t lens[CHAIN_READ_WINDOW];
+    for (uint32_t i = 0; i < w->count; i++) {
+        chain_block_decode(chain->scratch + w->offsets[i], (size_t)-1, &w->blocks[i], NULL);
+        ptrs[i] = chain->scratch + w->offsets[i];
+        lens[i] = CHAIN_BLOCK_ENCODED_SIZE(w->blocks[i].formula_count) - CHAIN_SIGNATURE_SIZE;
+    }
+    kolibri_sha256_batch(ptrs, lens, w->count, w->hashes);
+    
+    return CHAIN_OK;
+}
+
+/* Write a block record to the log; a failed write is cut off again so the
+ * next record does not land behind a partial one */
+static int log_write_block(kolibri_chain_t* chain, const kolibri_block_t* block) {
+    if (!chain->log) return CHAIN_OK;
+    
+    long end = ftell(chain->log);
+    if (write_block(chain, chain->log, block) == CHAIN_OK && fflush(chain->log) == 0) return CHAIN_OK;
+    
+    clearerr(chain->log);
+    if (end >= 0 && ftruncate(fileno(chain->log), end) == 0) fseek(chain->log, end, SEEK_SET);
+    return CHAIN_ERROR;
+}
+
+/* Start a fresh log holding only the current genesis block */
+static int log_reset(kolibri_chain_t* chain) {
+    if (!chain->log) return CHAIN_OK;
+    
+    uint32_t magic = CHAIN_LOG_MAGIC;
+    if (ftruncate(fileno(chain->log), 0) != 0) return CHAIN_ERROR;
+    rewind(chain->log);
+    if (fwrite(&magic, sizeof(magic), 1, chain->log) != 1) return CHAIN_ERROR;
+    
+    return log_write_block(chain, &chain->blocks[0].block);
+}
+
+/* Verify and append a block whose hash is already known */
+static int chain_add_hashed(kolibri_chain_t* chain, const kolibri_block_t* block,
+                            const uint8_t* hash) {
+    /* Blocks are appended strictly in order */
+    if (block->block_number != chain->block_count) return CHAIN_ERROR_VERIFICATION;
+    
+    /* Verify block; leaves its Merkle tree in chain->tree */
+    int result = chain_verify_block(chain, block);
+    if (result != CHAIN_OK) return result;
+    
+    /* Log the block only once appending it cannot fail */
+    if (chain_reserve(chain, block->formula_count) != CHAIN_OK) return CHAIN_ERROR;
+    if (log_write_block(chain, block) != CHAIN_OK) return CHAIN_ERROR;
+    return chain_append(chain, block, hash);
+}
+
+/*
+ * Replay an existing block log. Only a final record running past end of
+ * file is treated as an interrupted append and cut off; anything else that
+ * does not read back or verify fails the load and leaves the file alone.
+ * Returns CHAIN_ERROR_NOT_FOUND for an empty log, or one whose genesis
+ * record was never completed.
+ */
+static int log_load(kolibri_chain_t* chain) {
+    uint8_t magic[4];
+    int status = read_record_bytes(chain->log, magic, sizeof(magic), 1);
+    if (status == RECORD_END) return CHAIN_ERROR_NOT_FOUND;
+    if (status != RECORD_OK || get_u32(magic) != CHAIN_LOG_MAGIC) return CHAIN_ERROR;
+    
+    long good_end = ftell(chain->log);
+    block_window_t* w = (block_window_t*)malloc(sizeof(block_window_t));
+    if (!w) return CHAIN_ERROR;
+    
+    int result = CHAIN_OK;
+    do {
+        if (read_window(chain, chain->log, CHAIN_READ_WINDOW, w) != CHAIN_OK) {
+            result = CHAIN_ERROR;
+            break;
+        }
+        for (uint32_t i = 0; i < w->count && result == CHAIN_OK; i++) {
+            const kolibri_block_t* block = &w->blocks[i];
+            if (block->block_number != chain->block_count) {
+                result = CHAIN_ERROR_VERIFICATION;
+            } else {
+                result = chain_verify_block(chain, block);
+            }
+            if (result == CHAIN_OK) result = chain_append(chain, block, w->hashes[i]);
+            good_end = w->ends[i];
+        }
+        if (result == CHAIN_OK && w->status == RECORD_BAD) result = CHAIN_ERROR;
+    } while (result == CHAIN_OK && w->status == RECORD_OK);
+    status = w->status;
+    free(w);
+    if (result != CHAIN_OK) return result;
+    
+    if (chain->block_count == 0) return CHAIN_ERROR_NOT_FOUND;
+    if (status == RECORD_TORN && ftruncate(fileno(chain->log), good_end) != 0) return CHAIN_ERROR;
+    
+    return fseek(chain->log, 0, SEEK_END) == 0 ? CHAIN_OK : CHAIN_ERROR;
+}
+
+/* Open the block log under storage_path; runs in memory if the log cannot
+ * be created. Fails on a log that exists but does not load. */
+static int log_open(kolibri_chain_t* chain) {
+    if (chain->storage_path[0] == '\0') return CHAIN_OK;
+    
+    char path[sizeof(chain->storage_path) + sizeof(CHAIN_LOG_NAME) + 1];
+    snprintf(path, sizeof(path), "%s/%s", chain->storage_path, CHAIN_LOG_NAME);
+    
+    chain->log = fopen(path, "r+b");
+    if (!chain->log) {
+        chain->log = fopen(path, "w+b");
+    }
+    if (!chain->log) return CHAIN_OK;
+    
+    int result = log_load(chain);
+    return result == CHAIN_ERROR_NOT_FOUND ? CHAIN_OK : result;
+}
+
 /* Initialize chain */
 kolibri_chain_t* chain_init(const char* storage_path) {
     kolibri_chain_t* chain = (kolibri_chain_t*)calloc(1, sizeof(kolibri_chain_t));
@@ -40,23 +599,23 @@ kolibri_chain_t* chain_init(const char* storage_path) {
         strncpy(chain->storage_path, storage_path, sizeof(chain->storage_path) - 1);
     }
     
+    if (log_open(chain) != CHAIN_OK) {
+        chain_destroy(chain);
+        return NULL;
+    }
+    if (chain->block_count > 0) return chain;
+    
     /* Create genesis block */
     kolibri_block_t genesis;
     memset(&genesis, 0, sizeof(genesis));
     genesis.timestamp = (uint64_t)time(NULL);
     genesis.block_number = 0;
     
-    block_entry_t* entry = (block_entry_t*)malloc(sizeof(block_entry_t));
-    if (!entry) {
-        free(chain);
+    if (chain_append(chain, &genesis, NULL) != CHAIN_OK || log_reset(chain) != CHAIN_OK) {
+        chain_destroy(chain);
         return NULL;
     }
     
-    entry->block = genesis;
-    entry->next = NULL;
-    chain->head = entry;
-    chain->block_count = 1;
-    
     return chain;
 }
 
@@ -64,35 +623,30 @@ kolibri_chain_t* chain_init(const char* storage_path) {
 void chain_destroy(kolibri_chain_t* chain) {
     if (!chain) return;
     
-    block_entry_t* entry = chain->head;
-    while (entry) {
-        block_entry_t* next = entry->next;
-        free(entry);
-        entry = next;
-    }
+    if (chain->log) fclose(chain->log);
     
-    free(chain);
-}
-
-/* Calculate merkle root */
-static void calculate_merkle_root(const uint8_t formula_ids[][32], uint32_t count,
-                                 uint8_t* merkle_root) {
-    if (count == 0) {
-        memset(merkle_root, 0, CHAIN_HASH_SIZE);
-        return;
+    hash_slab_t* slab = chain->slabs;
+    while (slab) {
+        hash_slab_t* next = slab->next;
+        free(slab);
+        slab = next;
     }
     
-    /* Simple merkle: hash all IDs together */
-    simple_hash(formula_ids, count * 32, merkle_root);
+    free(chain->blocks);
+    free(chain->index);
+    free(chain->scratch);
+    free(chain->encoded);
+    free(chain->tree);
+    free(chain);
 }
 
 /* Get latest block */
 int chain_get_latest_block(kolibri_chain_t* chain, kolibri_block_t* block) {
     if (!chain || !block) return CHAIN_ERROR_INVALID_PARAM;
     
-    if (!chain->head) return CHAIN_ERROR_NOT_FOUND;
+    if (chain->block_count == 0) return CHAIN_ERROR_NOT_FOUND;
     
-    *block = chain->head->block;
+    *block = chain->blocks[chain->block_count - 1].block;
     return CHAIN_OK;
 }
 
@@ -100,45 +654,42 @@ int chain_get_latest_block(kolibri_chain_t* chain, kolibri_block_t* block) {
 int chain_create_block(kolibri_chain_t* chain, const uint8_t* author_private_key,
                       const uint8_t formula_ids[][32], uint32_t formula_count,
                       kolibri_block_t* block) {
-    if (!chain || !block || formula_count > CHAIN_MAX_FORMULAS_PER_BLOCK) {
+    if (!chain || !block || formula_count > CHAIN_MAX_FORMULAS_PER_BLOCK ||
+        (formula_count > 0 && !formula_ids)) {
         return CHAIN_ERROR_INVALID_PARAM;
     }
     
     /* Get previous block hash */
-    kolibri_block_t prev;
-    if (chain_get_latest_block(chain, &prev) == CHAIN_OK) {
-        simple_hash(&prev, sizeof(kolibri_block_t) - CHAIN_SIGNATURE_SIZE, block->prev_hash);
-        block->block_number = prev.block_number + 1;
+    if (chain->block_count > 0) {
+        const block_entry_t* prev = &chain->blocks[chain->block_count - 1];
+        memcpy(block->prev_hash, prev->hash, CHAIN_HASH_SIZE);
+        block->block_number = prev->block.block_number + 1;
     } else {
         memset(block->prev_hash, 0, CHAIN_HASH_SIZE);
         block->block_number = 0;
     }
     
-    /* Set block data */
+    /* Set block data; IDs are referenced, not copied */
     block->timestamp = (uint64_t)time(NULL);
     block->formula_count = formula_count;
-    
-    if (formula_ids && formula_count > 0) {
-        memcpy(block->formula_ids, formula_ids, formula_count * 32);
-    }
+    block->formula_ids = formula_count > 0 ? formula_ids : NULL;
     
     /* Calculate merkle root */
-    calculate_merkle_root(block->formula_ids, formula_count, block->merkle_root);
+    if (chain_build_tree(chain, block->formula_ids, formula_count) != CHAIN_OK) return CHAIN_ERROR;
+    chain_tree_root(chain, formula_count, block->merkle_root);
     
-    /* Set author */
+    /* Set author and sign the block hash, which covers author_pub */
     if (author_private_key) {
-        /* Derive public key (simplified) */
-        for (int i = 0; i < CHAIN_PUBKEY_SIZE; i++) {
-            block->author_pub[i] = author_private_key[i] ^ 0xAA;
-        }
-        
-        /* Sign block */
-        uint8_t block_hash[CHAIN_HASH_SIZE];
-        simple_hash(block, sizeof(kolibri_block_t) - CHAIN_SIGNATURE_SIZE, block_hash);
+        kolibri_ed25519_public_key(author_private_key, block->author_pub);
         
-        for (int i = 0; i < CHAIN_SIGNATURE_SIZE; i++) {
-            block->signature[i] = (block_hash[i % CHAIN_HASH_SIZE] ^ author_private_key[i % 32]) & 0xFF;
-        }
+        uint8_t hash[CHAIN_HASH_SIZE];
+        chain_block_hash(block, hash);
+        kolibri_ed25519_sign(author_private_key, block->author_pub, hash, CHAIN_HASH_SIZE,
+                             block->signature);
+    } else {
+        /* Unsigned block */
+        memset(block->author_pub, 0, CHAIN_PUBKEY_SIZE);
+        memset(block->signature, 0, CHAIN_SIGNATURE_SIZE);
     }
     
     return CHAIN_OK;
@@ -148,63 +699,128 @@ int chain_create_block(kolibri_chain_t* chain, const uint8_t* author_private_key
 int chain_add_block(kolibri_chain_t* chain, const kolibri_block_t* block) {
     if (!chain || !block) return CHAIN_ERROR_INVALID_PARAM;
     
-    /* Verify block */
-    int result = chain_verify_block(chain, block);
-    if (result != CHAIN_OK) return result;
-    
-    /* Add to chain */
-    block_entry_t* entry = (block_entry_t*)malloc(sizeof(block_entry_t));
-    if (!entry) return CHAIN_ERROR;
-    
-    entry->block = *block;
-    entry->next = chain->head;
-    chain->head = entry;
-    chain->block_count++;
-    
-    return CHAIN_OK;
+    return chain_add_hashed(chain, block, NULL);
 }
 
 /* Get block by number */
 int chain_get_block(kolibri_chain_t* chain, uint32_t block_number, kolibri_block_t* block) {
     if (!chain || !block) return CHAIN_ERROR_INVALID_PARAM;
     
-    block_entry_t* entry = chain->head;
-    while (entry) {
-        if (entry->block.block_number == block_number) {
-            *block = entry->block;
-            return CHAIN_OK;
-        }
-        entry = entry->next;
-    }
+    if (block_number >= chain->block_count) return CHAIN_ERROR_NOT_FOUND;
     
-    return CHAIN_ERROR_NOT_FOUND;
+    *block = chain->blocks[block_number].block;
+    return CHAIN_OK;
 }
 
 /* Verify block */
 int chain_verify_block(kolibri_chain_t* chain, const kolibri_block_t* block) {
     if (!chain || !block) return CHAIN_ERROR_INVALID_PARAM;
     
+    if (block->formula_count > CHAIN_MAX_FORMULAS_PER_BLOCK ||
+        (block->formula_count > 0 && !block->formula_ids)) {
+        return CHAIN_ERROR_VERIFICATION;
+    }
+    
     /* Verify merkle root */
     uint8_t calculated_merkle[CHAIN_HASH_SIZE];
-    calculate_merkle_root(block->formula_ids, block->formula_count, calculated_merkle);
+    if (chain_build_tree(chain, block->formula_ids, block->formula_count) != CHAIN_OK) {
+        return CHAIN_ERROR;
+    }
+    chain_tree_root(chain, block->formula_count, calculated_merkle);
     
     if (memcmp(calculated_merkle, block->merkle_root, CHAIN_HASH_SIZE) != 0) {
         return CHAIN_ERROR_VERIFICATION;
     }
     
     /* Verify previous hash */
-    if (block->block_number > 0) {
-        kolibri_block_t prev;
-        if (chain_get_block(chain, block->block_number - 1, &prev) == CHAIN_OK) {
-            uint8_t prev_hash[CHAIN_HASH_SIZE];
-            simple_hash(&prev, sizeof(kolibri_block_t) - CHAIN_SIGNATURE_SIZE, prev_hash);
-            
-            if (memcmp(prev_hash, block->prev_hash, CHAIN_HASH_SIZE) != 0) {
-                return CHAIN_ERROR_VERIFICATION;
+    if (block->block_number > 0 && block->block_number - 1 < chain->block_count) {
+        const block_entry_t* prev = &chain->blocks[block->block_number - 1];
+        if (memcmp(prev->hash, block->prev_hash, CHAIN_HASH_SIZE) != 0) {
+            return CHAIN_ERROR_VERIFICATION;
+        }
+    }
+    
+    return CHAIN_OK;
+}
+
+/* Find the block committing a formula */
+int chain_find_formula(kolibri_chain_t* chain, const uint8_t* formula_id,
+                       uint32_t* block_number, uint32_t* leaf_index) {
+    if (!chain || !formula_id) return CHAIN_ERROR_INVALID_PARAM;
+    if (chain->index_used == 0) return CHAIN_ERROR_NOT_FOUND;
+    
+    const index_slot_t* slot = index_lookup(chain->index, chain->index_size, formula_id);
+    if (slot->block_plus_one == 0) return CHAIN_ERROR_NOT_FOUND;
+    
+    if (block_number) *block_number = slot->block_plus_one - 1;
+    if (leaf_index) *leaf_index = slot->leaf_index;
+    return CHAIN_OK;
+}
+
+/* Build an inclusion proof from the stored tree */
+int chain_merkle_prove(kolibri_chain_t* chain, const uint8_t* formula_id,
+                       chain_merkle_proof_t* proof) {
+    if (!chain || !formula_id || !proof) return CHAIN_ERROR_INVALID_PARAM;
+    
+    uint32_t block_number, leaf_index;
+    int result = chain_find_formula(chain, formula_id, &block_number, &leaf_index);
+    if (result != CHAIN_OK) return result;
+    
+    const block_entry_t* entry = &chain->blocks[block_number];
+    proof->block_number = block_number;
+    proof->leaf_index = leaf_index;
+    proof->leaf_count = entry->block.formula_count;
+    proof->sibling_count = 0;
+    
+    size_t level = 0;
+    size_t size = entry->block.formula_count;
+    size_t index = leaf_index;
+    while (size > 1) {
+        size_t sibling = index ^ 1;
+        if (sibling < size) {
+            memcpy(proof->siblings[proof->sibling_count++], entry->tree[level + sibling],
+                   CHAIN_HASH_SIZE);
+        }
+        level += size;
+        size = (size + 1) / 2;
+        index /= 2;
+    }
+    
+    return CHAIN_OK;
+}
+
+/* Check an inclusion proof against a block's merkle_root */
+int chain_merkle_verify(const uint8_t* merkle_root, const uint8_t* formula_id,
+                        const chain_merkle_proof_t* proof) {
+    if (!merkle_root || !formula_id || !proof) return CHAIN_ERROR_INVALID_PARAM;
+    if (proof->leaf_index >= proof->leaf_count ||
+        proof->sibling_count > CHAIN_MERKLE_MAX_DEPTH) {
+        return CHAIN_ERROR_VERIFICATION;
+    }
+    
+    uint8_t hash[CHAIN_HASH_SIZE];
+    merkle_leaf(formula_id, hash);
+    
+    uint32_t used = 0;
+    size_t size = proof->leaf_count;
+    size_t index = proof->leaf_index;
+    while (size > 1) {
+        if ((index ^ 1) < size) {
+            if (used == proof->sibling_count) return CHAIN_ERROR_VERIFICATION;
+            if (index & 1) {
+                merkle_node(proof->siblings[used], hash, hash);
+            } else {
+                merkle_node(hash, proof->siblings[used], hash);
             }
+            used++;
         }
+        size = (size + 1) / 2;
+        index /= 2;
     }
     
+    if (used != proof->sibling_count || memcmp(hash, merkle_root, CHAIN_HASH_SIZE) != 0) {
+        return CHAIN_ERROR_VERIFICATION;
+    }
     return CHAIN_OK;
 }
 
@@ -213,17 +829,10 @@ int chain_get_info(kolibri_chain_t* chain, chain_info_t* info) {
     if (!chain || !info) return CHAIN_ERROR_INVALID_PARAM;
     
     info->block_count = chain->block_count;
-    info->total_formulas = 0;
+    info->total_formulas = chain->total_formulas;
     
-    block_entry_t* entry = chain->head;
-    while (entry) {
-        info->total_formulas += entry->block.formula_count;
-        entry = entry->next;
-    }
-    
-    if (chain->head) {
-        simple_hash(&chain->head->block, sizeof(kolibri_block_t) - CHAIN_SIGNATURE_SIZE,
-                   info->latest_hash);
+    if (chain->block_count > 0) {
+        memcpy(info->latest_hash, chain->blocks[chain->block_count - 1].hash, CHAIN_HASH_SIZE);
     }
     
     return CHAIN_OK;
@@ -237,32 +846,51 @@ int chain_export(kolibri_chain_t* chain, const char* path) {
     if (!f) return CHAIN_ERROR;
     
     /* Write header */
-    uint32_t magic = 0x4B434841; /* "KCHA" */
-    fwrite(&magic, sizeof(magic), 1, f);
-    fwrite(&chain->block_count, sizeof(uint32_t), 1, f);
-    
-    /* Write blocks in reverse order (oldest first) */
-    block_entry_t** entries = (block_entry_t**)malloc(sizeof(block_entry_t*) * chain->block_count);
-    if (!entries) {
+    uint8_t header[8];
+    put_u32(header, CHAIN_EXPORT_MAGIC);
+    put_u32(header + 4, chain->block_count);
+    if (fwrite(header, sizeof(header), 1, f) != 1) {
         fclose(f);
         return CHAIN_ERROR;
     }
     
-    block_entry_t* entry = chain->head;
-    int i = chain->block_count - 1;
-    while (entry && i >= 0) {
-        entries[i] = entry;
-        entry = entry->next;
-        i--;
+    /* Write blocks (oldest first) */
+    for (uint32_t i = 0; i < chain->block_count; i++) {
+        if (write_block(chain, f, &chain->blocks[i].block) != CHAIN_OK) {
+            fclose(f);
+            return CHAIN_ERROR;
+        }
     }
     
-    for (uint32_t j = 0; j < chain->block_count; j++) {
-        fwrite(&entries[j]->block, sizeof(kolibri_block_t), 1, f);
+    if (fclose(f) != 0) return CHAIN_ERROR;
+    return CHAIN_OK;
+}
+
+/* Apply one imported block; the first block of a file may replace our genesis */
+static int import_block(kolibri_chain_t* chain, const kolibri_block_t* block, const uint8_t* hash,
+                        int first) {
+    /* A chain holding only its own genesis adopts the imported one */
+    if (first && chain->block_count == 1 && block->block_number == 0 &&
+        memcmp(hash, chain->blocks[0].hash, CHAIN_HASH_SIZE) != 0) {
+        int result = chain_verify_block(chain, block);
+        if (result == CHAIN_OK && chain_reserve(chain, block->formula_count) != CHAIN_OK) {
+            result = CHAIN_ERROR;
+        }
+        if (result != CHAIN_OK) return result;
+        
+        chain_reset(chain);
+        chain_append(chain, block, hash);
+        return log_reset(chain);
     }
     
-    free(entries);
-    fclose(f);
-    return CHAIN_OK;
+    /* Blocks we already hold must be the same blocks */
+    if (block->block_number < chain->block_count) {
+        return memcmp(hash, chain->blocks[block->block_number].hash, CHAIN_HASH_SIZE) == 0
+                   ? CHAIN_OK
+                   : CHAIN_ERROR_VERIFICATION;
+    }
+    
+    return chain_add_hashed(chain, block, hash);
 }
 
 /* Import chain */
@@ -273,28 +901,492 @@ int chain_import(kolibri_chain_t* chain, const char* path) {
     if (!f) return CHAIN_ERROR;
     
     /* Read header */
-    uint32_t magic, count;
-    fread(&magic, sizeof(magic), 1, f);
-    if (magic != 0x4B434841) {
+    uint8_t header[8];
+    if (fread(header, 4, 1, f) != 1) {
+        fclose(f);
+        return CHAIN_ERROR;
+    }
+    if (get_u32(header) == KOLIBRI_PACK_MAGIC) {
+        fclose(f);
+        return chain_import_pack(chain, path, 0, NULL);
+    }
+    if (get_u32(header) != CHAIN_EXPORT_MAGIC || fread(header + 4, 4, 1, f) != 1) {
         fclose(f);
         return CHAIN_ERROR;
     }
-    fread(&count, sizeof(uint32_t), 1, f);
+    uint32_t count = get_u32(header + 4);
+    
+    block_window_t* w = (block_window_t*)malloc(sizeof(block_window_t));
+    if (!w) {
+        fclose(f);
+        return CHAIN_ERROR;
+    }
+    
+    /* Read blocks a window at a time so their hashes are computed in one batch */
+    int result = CHAIN_OK;
+    for (uint32_t i = 0; i < count && result == CHAIN_OK; ) {
+        result = read_window(chain, f, count - i, w);
+        if (result == CHAIN_OK && w->status != RECORD_OK) result = CHAIN_ERROR; /* Fewer blocks than declared */
+        
+        for (uint32_t j = 0; j < w->count && result == CHAIN_OK; j++, i++) {
+            result = import_block(chain, &w->blocks[j], w->hashes[j], i == 0);
+        }
+    }
+    
+    free(w);
+    fclose(f);
+    return result;
+}
+
+/* Export chain as a compressed pack */
+int chain_export_pack(kolibri_chain_t* chain, const char* path, kolibri_pack_stats_t* stats) {
+    if (!chain || !path) return CHAIN_ERROR_INVALID_PARAM;
+    
+    kolibri_pack_writer_t* w = kolibri_pack_create(path, KOLIBRI_PACK_KIND_BLOCKS);
+    if (!w) return CHAIN_ERROR;
+    
+    int result = CHAIN_OK;
+    for (uint32_t i = 0; i < chain->block_count && result == CHAIN_OK; i++) {
+        const kolibri_block_t* block = &chain->blocks[i].block;
+        size_t size = CHAIN_BLOCK_ENCODED_SIZE(block->formula_count);
+        uint8_t* buf = grow_buffer(&chain->encoded, &chain->encoded_size, size);
+        if (!buf || chain_block_encode(block, buf, size) != size ||
+            kolibri_pack_append(w, buf, size) != KOLIBRI_PACK_OK) {
+            result = CHAIN_ERROR;
+        }
+    }
     
-    /* Read blocks */
-    for (uint32_t i = 0; i < count; i++) {
-        kolibri_block_t block;
-        if (fread(&block, sizeof(kolibri_block_t), 1, f) != 1) {
+    if (kolibri_pack_finish(w, stats) != KOLIBRI_PACK_OK) result = CHAIN_ERROR;
+    return result;
+}
+
+/* Pack import state; frames arrive in order on the calling thread */
+typedef struct {
+    kolibri_chain_t* chain;
+    kolibri_block_t* blocks;
+    uint8_t (*hashes)[CHAIN_HASH_SIZE];
+    const uint8_t** ptrs;
+    size_t* lens;
+    uint32_t capacity;
+    uint64_t imported;
+    int result;
+} pack_import_t;
+
+static int import_pack_frame(void* ctx, const uint8_t* data, size_t len, uint32_t record_count) {
+    pack_import_t* im = (pack_import_t*)ctx;
+    
+    if (record_count > im->capacity) {
+        free(im->blocks);
+        free(im->hashes);
+        free(im->ptrs);
+        free(im->lens);
+        im->blocks = (kolibri_block_t*)malloc(record_count * sizeof(kolibri_block_t));
+        im->hashes = (uint8_t (*)[CHAIN_HASH_SIZE])malloc((size_t)record_count * CHAIN_HASH_SIZE);
+        im->ptrs = (const uint8_t**)malloc(record_count * sizeof(const uint8_t*));
+        im->lens = (size_t*)malloc(record_count * sizeof(size_t));
+        im->capacity = im->blocks && im->hashes && im->ptrs && im->lens ? record_count : 0;
+        if (im->capacity == 0) {
+            im->result = CHAIN_ERROR;
+            return 1;
+        }
+    }
+    
+    /* Decode the frame's blocks and hash them in one batch */
+    size_t offset = 0;
+    for (uint32_t i = 0; i < record_count; i++) {
+        size_t consumed;
+        if (chain_block_decode(data + offset, len - offset, &im->blocks[i], &consumed) != CHAIN_OK) {
+            im->result = CHAIN_ERROR;
+            return 1;
+        }
+        im->ptrs[i] = data + offset;
+        im->lens[i] = consumed - CHAIN_SIGNATURE_SIZE;
+        offset += consumed;
+    }
+    if (offset != len) {
+        im->result = CHAIN_ERROR;
+        return 1;
+    }
+    kolibri_sha256_batch(im->ptrs, im->lens, record_count, im->hashes);
+    
+    for (uint32_t i = 0; i < record_count; i++, im->imported++) {
+        im->result = import_block(im->chain, &im->blocks[i], im->hashes[i], im->imported == 0);
+        if (im->result != CHAIN_OK) return 1;
+    }
+    return 0;
+}
+
+/* Import a compressed pack */
+int chain_import_pack(kolibri_chain_t* chain, const char* path, uint32_t threads,
+                      kolibri_pack_stats_t* stats) {
+    if (!chain || !path) return CHAIN_ERROR_INVALID_PARAM;
+    
+    kolibri_pack_reader_t* r = kolibri_pack_open(path);
+    if (!r) return CHAIN_ERROR;
+    if (kolibri_pack_kind(r) != KOLIBRI_PACK_KIND_BLOCKS) {
+        kolibri_pack_close(r);
+        return CHAIN_ERROR;
+    }
+    if (stats) kolibri_pack_stats(r, stats);
+    
+    pack_import_t im;
+    memset(&im, 0, sizeof(im));
+    im.chain = chain;
+    int result = kolibri_pack_stream(r, 0, threads, import_pack_frame, &im);
+    if (im.result != CHAIN_OK) result = im.result;
+    else if (result != KOLIBRI_PACK_OK) result = CHAIN_ERROR;
+    
+    free(im.blocks);
+    free(im.hashes);
+    free(im.ptrs);
+    free(im.lens);
+    kolibri_pack_close(r);
+    return result;
+}
+
+/* ---- Whole-chain verification ----
+ *
+ * The calling thread reads blocks into a ring of slots and, in block order,
+ * runs the link check on slots the workers have finished. Workers take
+ * slots in order and run the hash, Merkle and signature stages on each. */
+
+enum { SLOT_FREE, SLOT_READY, SLOT_WORKING, SLOT_DONE };
+
+typedef struct {
+    int state;
+    uint8_t* buf;
+    size_t buf_size;
+    uint32_t count;
+    kolibri_block_t blocks[VERIFY_SLOT_BLOCKS];
+    uint8_t hashes[VERIFY_SLOT_BLOCKS][CHAIN_HASH_SIZE];
+    size_t offsets[VERIFY_SLOT_BLOCKS];
+    uint8_t failed[VERIFY_SLOT_BLOCKS]; /* CHAIN_STAGE_* of a failed check, or 0 */
+} verify_slot_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    verify_slot_t* slots;
+    uint32_t slot_count;
+    uint32_t next_work; /* Sequence numbers; slot = n % slot_count */
+    uint32_t published;
+    int shutdown;
+    const chain_checkpoint_t* checkpoint;
+} verify_pipeline_t;
+
+static int is_zero(const uint8_t* p, size_t len) {
+    uint8_t acc = 0;
+    for (size_t i = 0; i < len; i++) acc |= p[i];
+    return acc == 0;
+}
+
+/* Hash, Merkle and signature stages for one slot */
+static void verify_slot(const verify_pipeline_t* p, verify_slot_t* s,
+                        uint8_t (**tree)[32], size_t* tree_size) {
+    const uint8_t* ptrs[VERIFY_SLOT_BLOCKS];
+    const uint8_t* keys[VERIFY_SLOT_BLOCKS];
+    const uint8_t* sigs[VERIFY_SLOT_BLOCKS];
+    size_t lens[VERIFY_SLOT_BLOCKS];
+    uint32_t signed_index[VERIFY_SLOT_BLOCKS];
+    int valid[VERIFY_SLOT_BLOCKS];
+    uint32_t signed_count = 0;
+    
+    /* Hash stage */
+    for (uint32_t i = 0; i < s->count; i++) {
+        chain_block_decode(s->buf + s->offsets[i], (size_t)-1, &s->blocks[i], NULL);
+        ptrs[i] = s->buf + s->offsets[i];
+        lens[i] = CHAIN_BLOCK_ENCODED_SIZE(s->blocks[i].formula_count) - CHAIN_SIGNATURE_SIZE;
+        s->failed[i] = 0;
+    }
+    kolibri_sha256_batch(ptrs, lens, s->count, s->hashes);
+    
+    for (uint32_t i = 0; i < s->count; i++) {
+        const kolibri_block_t* block = &s->blocks[i];
+        
+        /* The checkpoint block is trusted by hash alone */
+        if (p->checkpoint && block->block_number == p->checkpoint->block_number) continue;
+        
+        /* Merkle stage */
+        uint8_t root[CHAIN_HASH_SIZE] = {0};
+        if (block->formula_count > 0) {
+            size_t nodes = merkle_node_count(block->formula_count);
+            if (*tree_size < nodes) {
+                uint8_t (*grown)[32] = (uint8_t (*)[32])realloc(*tree, nodes * 32);
+                if (!grown) {
+                    s->failed[i] = CHAIN_STAGE_MERKLE;
+                    continue;
+                }
+                *tree = grown;
+                *tree_size = nodes;
+            }
+            merkle_build(block->formula_ids, block->formula_count, *tree);
+            memcpy(root, (*tree)[nodes - 1], CHAIN_HASH_SIZE);
+        }
+        if (memcmp(root, block->merkle_root, CHAIN_HASH_SIZE) != 0) {
+            s->failed[i] = CHAIN_STAGE_MERKLE;
+            continue;
+        }
+        
+        /* Unsigned blocks carry an all-zero key and signature */
+        if (is_zero(block->author_pub, CHAIN_PUBKEY_SIZE) &&
+            is_zero(block->signature, CHAIN_SIGNATURE_SIZE)) {
+            continue;
+        }
+        ptrs[signed_count] = s->hashes[i];
+        lens[signed_count] = CHAIN_HASH_SIZE;
+        keys[signed_count] = block->author_pub;
+        sigs[signed_count] = block->signature;
+        signed_index[signed_count++] = i;
+    }
+    
+    /* Signature stage, batched across the slot */
+    if (signed_count > 0 &&
+        kolibri_ed25519_verify_batch(ptrs, lens, keys, sigs, signed_count, valid) != 0) {
+        for (uint32_t k = 0; k < signed_count; k++) {
+            if (!valid[k]) s->failed[signed_index[k]] = CHAIN_STAGE_SIGNATURE;
+        }
+    }
+}
+
+static void* verify_worker(void* arg) {
+    verify_pipeline_t* p = (verify_pipeline_t*)arg;
+    uint8_t (*tree)[32] = NULL;
+    size_t tree_size = 0;
+    
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        while (!p->shutdown && p->next_work == p->published) {
+            pthread_cond_wait(&p->work_ready, &p->lock);
+        }
+        if (p->next_work == p->published) break;
+        
+        verify_slot_t* s = &p->slots[p->next_work++ % p->slot_count];
+        s->state = SLOT_WORKING;
+        pthread_mutex_unlock(&p->lock);
+        
+        verify_slot(p, s, &tree, &tree_size);
+        
+        pthread_mutex_lock(&p->lock);
+        s->state = SLOT_DONE;
+        pthread_cond_broadcast(&p->work_done);
+    }
+    pthread_mutex_unlock(&p->lock);
+    
+    free(tree);
+    return NULL;
+}
+
+/* Read stage: fill a slot, skipping blocks before the checkpoint.
+ * remaining counts the blocks an export still declares (UINT32_MAX for a
+ * log); *end is set once no more blocks follow, *unreadable if a record has
+ * a bad header or the data ran out before an export's declared count. A
+ * log may only end in a torn record. */
+static int read_slot(FILE* f, long file_size, const chain_checkpoint_t* checkpoint, verify_slot_t* s,
+                     uint32_t* remaining, int* end, int* unreadable) {
+    size_t used = 0;
+    s->count = 0;
+    
+    while (s->count < VERIFY_SLOT_BLOCKS && used < VERIFY_SLOT_BYTES) {
+        if (*remaining == 0) {
+            *end = 1;
+            break;
+        }
+        
+        int got = read_header(f, &s->buf, &s->buf_size, used);
+        if (got == RECORD_OK && checkpoint && get_u32(s->buf + used + 104) < checkpoint->block_number) {
+            /* Already verified history: step over the body */
+            long body = (long)(CHAIN_BLOCK_ENCODED_SIZE(get_u32(s->buf + used + 108)) -
+                               CHAIN_BLOCK_HEADER_SIZE);
+            if (fseek(f, body, SEEK_CUR) != 0 || ftell(f) > file_size) {
+                got = RECORD_TORN;
+            } else {
+                if (*remaining != UINT32_MAX) (*remaining)--;
+                continue;
+            }
+        }
+        if (got == RECORD_OK) got = read_body(f, &s->buf, &s->buf_size, used);
+        if (got == RECORD_NOMEM) return CHAIN_ERROR;
+        if (got != RECORD_OK) {
+            /* A log may end in a torn record; an export must hold every block */
+            *end = 1;
+            if (got == RECORD_BAD || *remaining != UINT32_MAX) *unreadable = 1;
+            break;
+        }
+        
+        s->offsets[s->count++] = used;
+        used += CHAIN_BLOCK_ENCODED_SIZE(get_u32(s->buf + used + 108));
+        if (*remaining != UINT32_MAX) (*remaining)--;
+    }
+    
+    return CHAIN_OK;
+}
+
+/* Link stage for one finished slot; returns CHAIN_ERROR_VERIFICATION at the
+ * first failing block */
+static int link_slot(const verify_pipeline_t* p, const verify_slot_t* s,
+                     chain_verify_report_t* report, uint32_t* expected, uint8_t* prev_hash) {
+    for (uint32_t i = 0; i < s->count; i++) {
+        const kolibri_block_t* block = &s->blocks[i];
+        int stage = CHAIN_STAGE_NONE;
+        
+        if (block->block_number != *expected) {
+            stage = CHAIN_STAGE_LINK;
+        } else if (p->checkpoint && block->block_number == p->checkpoint->block_number) {
+            if (memcmp(s->hashes[i], p->checkpoint->hash, CHAIN_HASH_SIZE) != 0) {
+                stage = CHAIN_STAGE_HASH;
+            }
+        } else if (s->failed[i]) {
+            stage = s->failed[i];
+        } else if (memcmp(block->prev_hash, prev_hash, CHAIN_HASH_SIZE) != 0) {
+            stage = CHAIN_STAGE_LINK;
+        }
+        
+        if (stage != CHAIN_STAGE_NONE) {
+            report->failed_block = *expected;
+            report->failed_stage = stage;
+            return CHAIN_ERROR_VERIFICATION;
+        }
+        
+        if (!p->checkpoint || block->block_number != p->checkpoint->block_number) {
+            report->blocks_verified++;
+        }
+        report->last.block_number = block->block_number;
+        memcpy(report->last.hash, s->hashes[i], CHAIN_HASH_SIZE);
+        memcpy(prev_hash, s->hashes[i], CHAIN_HASH_SIZE);
+        (*expected)++;
+    }
+    return CHAIN_OK;
+}
+
+/* Verify a chain export or block log */
+int chain_verify_file(const char* path, const chain_checkpoint_t* checkpoint, uint32_t threads,
+                      chain_verify_report_t* report) {
+    if (!path || !report) return CHAIN_ERROR_INVALID_PARAM;
+    
+    memset(report, 0, sizeof(*report));
+    FILE* f = fopen(path, "rb");
+    if (!f) return CHAIN_ERROR;
+    
+    /* Exports declare their block count; a log runs to end of file */
+    uint8_t header[8];
+    uint32_t remaining = UINT32_MAX;
+    if (fread(header, 4, 1, f) != 1) {
+        fclose(f);
+        return CHAIN_ERROR;
+    }
+    struct stat st;
+    if (fstat(fileno(f), &st) != 0) {
+        fclose(f);
+        return CHAIN_ERROR;
+    }
+    if (get_u32(header) == CHAIN_EXPORT_MAGIC) {
+        if (fread(header + 4, 4, 1, f) != 1) {
             fclose(f);
             return CHAIN_ERROR;
         }
+        remaining = get_u32(header + 4);
+    } else if (get_u32(header) != CHAIN_LOG_MAGIC) {
+        fclose(f);
+        return CHAIN_ERROR;
+    }
+    
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (uint32_t)cpus : 1;
+    }
+    if (threads > VERIFY_MAX_THREADS) threads = VERIFY_MAX_THREADS;
+    
+    verify_pipeline_t p;
+    memset(&p, 0, sizeof(p));
+    p.checkpoint = checkpoint;
+    p.slot_count = threads * 2 + 2;
+    p.slots = (verify_slot_t*)calloc(p.slot_count, sizeof(verify_slot_t));
+    if (!p.slots) {
+        fclose(f);
+        return CHAIN_ERROR;
+    }
+    pthread_mutex_init(&p.lock, NULL);
+    pthread_cond_init(&p.work_ready, NULL);
+    pthread_cond_init(&p.work_done, NULL);
+    
+    /* With a single thread, or if none can be started, slots are processed inline */
+    pthread_t workers[VERIFY_MAX_THREADS];
+    uint32_t started = 0;
+    if (threads > 1) {
+        while (started < threads && pthread_create(&workers[started], NULL, verify_worker, &p) == 0) {
+            started++;
+        }
+    }
+    uint8_t (*tree)[32] = NULL;
+    size_t tree_size = 0;
+    
+    uint32_t expected = checkpoint ? checkpoint->block_number : 0;
+    uint8_t prev_hash[CHAIN_HASH_SIZE] = {0};
+    if (checkpoint) {
+        report->last = *checkpoint;
+        memcpy(prev_hash, checkpoint->hash, CHAIN_HASH_SIZE);
+    }
+    
+    int result = CHAIN_OK;
+    int end = 0, unreadable = 0;
+    uint32_t next_link = 0;
+    pthread_mutex_lock(&p.lock);
+    for (;;) {
+        verify_slot_t* linkable = &p.slots[next_link % p.slot_count];
+        if (next_link < p.published && linkable->state == SLOT_DONE) {
+            /* Link stage, in block order */
+            pthread_mutex_unlock(&p.lock);
+            if (result == CHAIN_OK) result = link_slot(&p, linkable, report, &expected, prev_hash);
+            pthread_mutex_lock(&p.lock);
+            linkable->state = SLOT_FREE;
+            next_link++;
+            continue;
+        }
         
-        /* Skip genesis if it already exists */
-        if (i == 0 && chain->block_count > 0) continue;
+        verify_slot_t* readable = &p.slots[p.published % p.slot_count];
+        if (!end && result == CHAIN_OK && readable->state == SLOT_FREE) {
+            /* Read stage */
+            pthread_mutex_unlock(&p.lock);
+            int read = read_slot(f, (long)st.st_size, checkpoint, readable, &remaining, &end, &unreadable);
+            if (read == CHAIN_OK && readable->count > 0 && started == 0) {
+                verify_slot(&p, readable, &tree, &tree_size);
+            }
+            pthread_mutex_lock(&p.lock);
+            if (read != CHAIN_OK) {
+                result = read;
+                end = 1;
+            } else if (readable->count > 0) {
+                readable->state = started ? SLOT_READY : SLOT_DONE;
+                p.published++;
+                if (started == 0) p.next_work = p.published;
+                pthread_cond_signal(&p.work_ready);
+            }
+            continue;
+        }
         
-        chain_add_block(chain, &block);
+        if (next_link == p.published && (end || result != CHAIN_OK)) break;
+        pthread_cond_wait(&p.work_done, &p.lock);
     }
+    p.shutdown = 1;
+    pthread_cond_broadcast(&p.work_ready);
+    pthread_mutex_unlock(&p.lock);
+    
+    for (uint32_t t = 0; t < started; t++) pthread_join(workers[t], NULL);
     
+    /* A bad record, data ending before the declared count, or before the checkpoint */
+    if (result == CHAIN_OK && (unreadable || (checkpoint && expected == checkpoint->block_number))) {
+        report->failed_block = expected;
+        report->failed_stage = CHAIN_STAGE_READ;
+        result = CHAIN_ERROR_VERIFICATION;
+    }
+    
+    for (uint32_t i = 0; i < p.slot_count; i++) free(p.slots[i].buf);
+    free(p.slots);
+    free(tree);
+    pthread_mutex_destroy(&p.lock);
+    pthread_cond_destroy(&p.work_ready);
+    pthread_cond_destroy(&p.work_done);
     fclose(f);
-    return CHAIN_OK;
+    return result;
 }
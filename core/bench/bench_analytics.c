@@ -0,0 +1,155 @@
+/**
+ * KOLIBRI.AI Benchmarks - Formula sketches, similarity queries and
+ * duplicate-checked creates
+ *
+ * Formulas are sums of 16 constant-times-input terms with constants unique
+ * to each formula; queries are the stored formulas with one constant changed.
+ * Usage: bench_analytics [formulas]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "kolibri_analytics.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TERMS 16
+#define CODE_SIZE 256
+#define QUERIES 2000
+
+static uint32_t rng_state = 11;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* Formula n with term changed_term (-1 for none) set to 7 */
+static void make_formula(kolibri_formula_t* formula, char* code, uint32_t n, int changed_term) {
+    memset(formula, 0, sizeof(*formula));
+    memcpy(formula->id, &n, sizeof(n));
+    formula->id[31] = 2;
+    formula->version = 1;
+    formula->input_count = 2;
+    strcpy(formula->inputs[0], "x");
+    strcpy(formula->inputs[1], "z");
+    formula->output_count = 1;
+    strcpy(formula->outputs[0], "y");
+    
+    uint32_t state = n * 2654435761u + 1;
+    int len = sprintf(code, "y =");
+    for (int t = 0; t < TERMS; t++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        uint32_t constant = t == changed_term ? 7 : 1000 + state % 1000000;
+        len += sprintf(code + len, "%s %u %c %c", t == 0 ? "" : state & 1 ? " +" : " -", constant,
+                       state & 2 ? '*' : '/', state & 4 ? 'x' : 'z');
+    }
+    formula->code_size = (uint32_t)len;
+    formula->code = (uint8_t*)code;
+}
+
+/* Create every formula; returns seconds or -1 on failure */
+static double create_all(kolibri_core_t* core, char* codes, uint32_t count) {
+    double start = bench_now();
+    for (uint32_t i = 0; i < count; i++) {
+        kolibri_formula_t formula;
+        make_formula(&formula, codes + (size_t)i * CODE_SIZE, i, -1);
+        if (kolibri_formula_create(core, &formula) != KOLIBRI_OK) return -1.0;
+    }
+    return bench_now() - start;
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 100000;
+    if (count == 0) return 1;
+    char* codes = (char*)malloc((size_t)count * CODE_SIZE);
+    kolibri_sketch_t* sketches = (kolibri_sketch_t*)malloc((size_t)count * sizeof(kolibri_sketch_t));
+    if (!codes || !sketches) return 1;
+    
+    /* Sketch cost alone, code generation excluded */
+    kolibri_formula_t* formulas = (kolibri_formula_t*)malloc(sizeof(kolibri_formula_t) * 1024);
+    if (!formulas) return 1;
+    double sketch_seconds = 0.0;
+    for (uint32_t at = 0; at < count; at += 1024) {
+        uint32_t n = count - at < 1024 ? count - at : 1024;
+        for (uint32_t i = 0; i < n; i++) make_formula(&formulas[i], codes + (size_t)(at + i) * CODE_SIZE, at + i, -1);
+        double start = bench_now();
+        for (uint32_t i = 0; i < n; i++) kolibri_formula_sketch(&formulas[i], &sketches[at + i]);
+        sketch_seconds += bench_now() - start;
+    }
+    free(formulas);
+    printf("%u formulas of about %u bytes of code\n", count,
+           (uint32_t)strlen(codes + (size_t)(count - 1) * CODE_SIZE));
+    printf("  sketch                      %6.2f us/formula\n", sketch_seconds / count * 1e6);
+    
+    kolibri_core_t* plain = kolibri_init(NULL);
+    kolibri_core_t* checked = kolibri_init(NULL);
+    if (!plain || !checked) return 1;
+    kolibri_set_duplicate_threshold(checked, 0.9f);
+    double plain_seconds = create_all(plain, codes, count);
+    double checked_seconds = create_all(checked, codes, count);
+    if (plain_seconds < 0 || checked_seconds < 0) {
+        fprintf(stderr, "bench_analytics: create failed\n");
+        return 1;
+    }
+    printf("  create                      %6.2f us/formula\n", plain_seconds / count * 1e6);
+    printf("  create, threshold 0.9       %6.2f us/formula\n", checked_seconds / count * 1e6);
+    
+    /* One-constant variants of random stored formulas */
+    uint32_t found = 0, results_total = 0;
+    double query_seconds = 0.0;
+    for (uint32_t q = 0; q < QUERIES; q++) {
+        uint32_t n = rng() % count;
+        kolibri_formula_t variant;
+        char code[CODE_SIZE];
+        make_formula(&variant, code, n, (int)(q % TERMS));
+        variant.id[31] = 3;
+        
+        kolibri_similar_t results[8];
+        uint32_t got;
+        double start = bench_now();
+        kolibri_formula_find_similar(plain, &variant, 0.5f, results, 8, &got);
+        query_seconds += bench_now() - start;
+        results_total += got;
+        found += got > 0 && memcmp(results[0].id, &n, sizeof(n)) == 0;
+    }
+    printf("  find_similar at 0.5         %6.2f us/query, recall %.1f%%, %.2f results/query\n",
+           query_seconds / QUERIES * 1e6, 100.0 * found / QUERIES, (double)results_total / QUERIES);
+    
+    /* The same queries by scoring every sketch */
+    rng_state = 11;
+    uint32_t brute_found = 0;
+    double start = bench_now();
+    for (uint32_t q = 0; q < QUERIES / 20; q++) {
+        uint32_t n = rng() % count;
+        kolibri_formula_t variant;
+        char code[CODE_SIZE];
+        make_formula(&variant, code, n, (int)(q % TERMS));
+        kolibri_sketch_t sketch;
+        kolibri_formula_sketch(&variant, &sketch);
+        uint32_t best = 0;
+        float best_similarity = -1.0f;
+        for (uint32_t i = 0; i < count; i++) {
+            float similarity = kolibri_sketch_similarity(&sketch, &sketches[i]);
+            if (similarity > best_similarity) {
+                best_similarity = similarity;
+                best = i;
+            }
+        }
+        brute_found += best == n && best_similarity >= 0.5f;
+    }
+    double brute_seconds = bench_now() - start;
+    printf("  linear scan baseline        %6.0f us/query, recall %.1f%%\n",
+           brute_seconds / (QUERIES / 20) * 1e6, 100.0 * brute_found / (QUERIES / 20));
+    
+    kolibri_destroy(plain);
+    kolibri_destroy(checked);
+    free(codes);
+    free(sketches);
+    return 0;
+}
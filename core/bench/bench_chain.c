@@ -0,0 +1,145 @@
+/**
+ * KOLIBRI.AI Benchmarks - Block creation, export size, import and log reload
+ *
+ * Sizes and hash rates are printed beside those of the fixed-size block
+ * struct the compact encoding replaced.
+ * Usage: bench_chain [blocks]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "kolibri_chain.h"
+#include "kolibri_sha256.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BENCH_DIR "bench_chain.d"
+#define BENCH_LOG BENCH_DIR "/blocks.log"
+#define BENCH_EXPORT "bench_chain.kch"
+
+static long file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+/* The block before the compact encoding: always 100 ID slots, exported
+ * and hashed as the padded struct */
+typedef struct {
+    uint8_t prev_hash[CHAIN_HASH_SIZE];
+    uint8_t merkle_root[CHAIN_HASH_SIZE];
+    uint8_t author_pub[CHAIN_PUBKEY_SIZE];
+    uint64_t timestamp;
+    uint32_t block_number;
+    uint8_t formula_ids[100][32];
+    uint32_t formula_count;
+    uint8_t signature[CHAIN_SIGNATURE_SIZE];
+} fixed_block_t;
+
+/* Blocks hashed per second in the compact encoding and as the fixed struct */
+static void hash_rates(uint32_t blocks, uint32_t ids_per_block, double* compact, double* fixed) {
+    static uint8_t ids[100][32];
+    static fixed_block_t fixed_block;
+    memset(ids, 0x5A, sizeof(ids));
+    memset(&fixed_block, 0, sizeof(fixed_block));
+    memcpy(fixed_block.formula_ids, ids, (size_t)ids_per_block * 32);
+    fixed_block.formula_count = ids_per_block;
+    
+    kolibri_block_t block;
+    memset(&block, 0, sizeof(block));
+    block.formula_count = ids_per_block;
+    block.formula_ids = (const uint8_t (*)[32])ids;
+    
+    uint8_t hash[CHAIN_HASH_SIZE];
+    double start = bench_now();
+    for (uint32_t i = 0; i < blocks; i++) {
+        block.block_number = i;
+        chain_block_hash(&block, hash);
+    }
+    *compact = blocks / (bench_now() - start);
+    
+    start = bench_now();
+    for (uint32_t i = 0; i < blocks; i++) {
+        fixed_block.block_number = i;
+        kolibri_sha256(&fixed_block, sizeof(fixed_block) - CHAIN_SIGNATURE_SIZE, hash);
+    }
+    *fixed = blocks / (bench_now() - start);
+}
+
+/* Unsigned blocks of ids_per_block IDs each in an in-memory chain, then
+ * the same blocks replayed from a block log under BENCH_DIR */
+static int run(uint32_t blocks, uint32_t ids_per_block) {
+    static uint8_t ids[100][32];
+    kolibri_chain_t* chain = chain_init(NULL);
+    if (!chain) return 1;
+    
+    double start = bench_now();
+    for (uint32_t i = 0; i < blocks; i++) {
+        memset(ids, (int)i, sizeof(ids));
+        memcpy(ids[0], &i, sizeof(i));
+        kolibri_block_t block;
+        if (chain_create_block(chain, NULL, (const uint8_t (*)[32])ids, ids_per_block, &block) != CHAIN_OK ||
+            chain_add_block(chain, &block) != CHAIN_OK) {
+            chain_destroy(chain);
+            return 1;
+        }
+    }
+    double add_seconds = bench_now() - start;
+    int result = chain_export(chain, BENCH_EXPORT);
+    chain_destroy(chain);
+    if (result != CHAIN_OK) return 1;
+    
+    chain = chain_init(NULL);
+    start = bench_now();
+    result = chain ? chain_import(chain, BENCH_EXPORT) : CHAIN_ERROR;
+    double import_seconds = bench_now() - start;
+    chain_destroy(chain);
+    if (result != CHAIN_OK) return 1;
+    
+    /* Importing into a chain with storage writes the log */
+    remove(BENCH_LOG);
+    mkdir(BENCH_DIR, 0755);
+    chain = chain_init(BENCH_DIR);
+    start = bench_now();
+    result = chain ? chain_import(chain, BENCH_EXPORT) : CHAIN_ERROR;
+    double logged_seconds = bench_now() - start;
+    chain_destroy(chain);
+    if (result != CHAIN_OK) return 1;
+    
+    start = bench_now();
+    chain = chain_init(BENCH_DIR);
+    double reload_seconds = bench_now() - start;
+    if (!chain) return 1;
+    chain_destroy(chain);
+    
+    double compact_rate, fixed_rate;
+    hash_rates(blocks, ids_per_block, &compact_rate, &fixed_rate);
+    
+    long size = file_size(BENCH_EXPORT);
+    printf("%3u IDs/block               compact    fixed struct\n", ids_per_block);
+    printf("  export           %9.0f B  %9zu B per block\n", (double)size / blocks, sizeof(fixed_block_t));
+    printf("  block hash       %9.0f    %9.0f blocks/s\n", compact_rate, fixed_rate);
+    printf("  create+add       %9.0f blocks/s\n", blocks / add_seconds);
+    printf("  import+verify    %9.0f blocks/s\n", blocks / import_seconds);
+    printf("  import to log    %9.0f blocks/s\n", blocks / logged_seconds);
+    printf("  log reload       %9.0f blocks/s\n", blocks / reload_seconds);
+    
+    remove(BENCH_EXPORT);
+    remove(BENCH_LOG);
+    rmdir(BENCH_DIR);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t blocks = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 20000;
+    if (blocks == 0) return 1;
+    
+    printf("%u blocks\n", blocks);
+    if (run(blocks, 1) != 0 || run(blocks, 100) != 0) {
+        fprintf(stderr, "bench_chain failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * KOLIBRI.AI Benchmarks - Ed25519 single and batch verification
+ *
+ * Usage: bench_ed25519 [signatures]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "kolibri_core.h"
+#include "kolibri_ed25519.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MESSAGE_SIZE 64
+
+typedef struct {
+    uint8_t (*keys)[32];
+    uint8_t (*signatures)[64];
+    uint8_t (*messages)[MESSAGE_SIZE];
+    const uint8_t** message_ptrs;
+    const uint8_t** key_ptrs;
+    const uint8_t** signature_ptrs;
+    size_t* lens;
+} signed_set_t;
+
+/* count signed messages from signers distinct keys, round robin */
+static int make_set(signed_set_t* set, size_t count, size_t signers) {
+    set->keys = (uint8_t (*)[32])malloc(count * sizeof(*set->keys));
+    set->signatures = (uint8_t (*)[64])malloc(count * sizeof(*set->signatures));
+    set->messages = (uint8_t (*)[MESSAGE_SIZE])malloc(count * sizeof(*set->messages));
+    set->message_ptrs = (const uint8_t**)malloc(count * sizeof(*set->message_ptrs));
+    set->key_ptrs = (const uint8_t**)malloc(count * sizeof(*set->key_ptrs));
+    set->signature_ptrs = (const uint8_t**)malloc(count * sizeof(*set->signature_ptrs));
+    set->lens = (size_t*)malloc(count * sizeof(*set->lens));
+    if (!set->keys || !set->signatures || !set->messages || !set->message_ptrs ||
+        !set->key_ptrs || !set->signature_ptrs || !set->lens) {
+        return -1;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        uint8_t seed[32];
+        memset(seed, 0, sizeof(seed));
+        size_t signer = i % signers;
+        memcpy(seed, &signer, sizeof(signer));
+        for (size_t k = 0; k < MESSAGE_SIZE; k++) set->messages[i][k] = (uint8_t)(i * 31 + k);
+        set->lens[i] = MESSAGE_SIZE;
+        kolibri_ed25519_public_key(seed, set->keys[i]);
+        kolibri_ed25519_sign(seed, set->keys[i], set->messages[i], MESSAGE_SIZE, set->signatures[i]);
+        set->message_ptrs[i] = set->messages[i];
+        set->key_ptrs[i] = set->keys[i];
+        set->signature_ptrs[i] = set->signatures[i];
+    }
+    return 0;
+}
+
+static void free_set(signed_set_t* set) {
+    free(set->keys);
+    free(set->signatures);
+    free(set->messages);
+    free(set->message_ptrs);
+    free(set->key_ptrs);
+    free(set->signature_ptrs);
+    free(set->lens);
+}
+
+static int bench_set(const char* label, size_t count, size_t signers) {
+    signed_set_t set;
+    if (make_set(&set, count, signers) != 0) {
+        free_set(&set);
+        return -1;
+    }
+    
+    int bad = 0;
+    double start = bench_now();
+    for (size_t i = 0; i < count; i++) {
+        bad |= kolibri_ed25519_verify(set.key_ptrs[i], set.message_ptrs[i], set.lens[i], set.signature_ptrs[i]);
+    }
+    double single = bench_now() - start;
+    
+    start = bench_now();
+    bad |= kolibri_ed25519_verify_batch(set.message_ptrs, set.lens, set.key_ptrs, set.signature_ptrs, count, NULL);
+    double batch = bench_now() - start;
+    
+    printf("%-16s single %6.1f us/sig, batch %6.1f us/sig (%.1fx)\n", label,
+           single / count * 1e6, batch / count * 1e6, single / batch);
+    free_set(&set);
+    return bad;
+}
+
+/* Signed formulas verified one by one and with the threaded batch */
+static int bench_formulas(uint32_t count) {
+    static const uint8_t private_key[32] = { 7 };
+    uint8_t public_key[32];
+    kolibri_derive_public_key(private_key, public_key);
+    
+    kolibri_formula_t* formulas = (kolibri_formula_t*)calloc(count, sizeof(kolibri_formula_t));
+    char* code = (char*)malloc((size_t)count * 32);
+    if (!formulas || !code) {
+        free(formulas);
+        free(code);
+        return -1;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        kolibri_formula_t* formula = &formulas[i];
+        memcpy(formula->id, &i, sizeof(i));
+        formula->version = 1;
+        formula->code_size = (uint32_t)snprintf(code + (size_t)i * 32, 32, "y = x * %u", i);
+        formula->code = (uint8_t*)code + (size_t)i * 32;
+        kolibri_sign_formula(formula, private_key);
+    }
+    
+    int bad = 0;
+    double start = bench_now();
+    for (uint32_t i = 0; i < count; i++) bad |= kolibri_verify_formula(&formulas[i], public_key) != KOLIBRI_OK;
+    double single = bench_now() - start;
+    
+    start = bench_now();
+    bad |= kolibri_verify_formula_batch(formulas, count, public_key, NULL) != KOLIBRI_OK;
+    double batch = bench_now() - start;
+    
+    printf("%u signed formulas: verify pass %.2fs, individually %.2fs\n", count, batch, single);
+    free(formulas);
+    free(code);
+    return bad;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 2048;
+    if (count == 0) return 1;
+    
+    printf("%zu signatures\n", count);
+    if (bench_set("one signer", count, 1) != 0 || bench_set("distinct keys", count, count) != 0 ||
+        bench_formulas(20000) != 0) {
+        fprintf(stderr, "bench_ed25519 failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * KOLIBRI.AI Benchmarks - Pack compression ratio and throughput
+ *
+ * Usage: bench_pack [formulas]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "kolibri_core.h"
+#include "kolibri_chain.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define RAW_PATH "bench_pack.kfr"
+#define PACK_PATH "bench_pack.kpk"
+#define CHAIN_RAW_PATH "bench_pack.kch"
+
+static long file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static void make_formula(kolibri_formula_t* formula, char* code, uint32_t n) {
+    memset(formula, 0, sizeof(*formula));
+    memcpy(formula->id, &n, sizeof(n));
+    formula->id[31] = 1;
+    formula->version = 1 + n % 3;
+    formula->input_count = 2;
+    strcpy(formula->inputs[0], "x");
+    strcpy(formula->inputs[1], "z");
+    formula->output_count = 1;
+    strcpy(formula->outputs[0], "y");
+    formula->code_size = (uint32_t)sprintf(code, "y = %s(x * %u.%u) + z / %u",
+                                           n % 3 ? "sin" : "log", n % 1000, n % 7, n % 13 + 1);
+    formula->code = (uint8_t*)code;
+    formula->cost = n % 50;
+    formula->fitness = (float)(n % 100) / 100.0f;
+    formula->provenance_count = 1;
+    formula->provenances[0][0] = (uint8_t)n;
+    formula->tag_count = 2;
+    strcpy(formula->tags[0], "physics");
+    strcpy(formula->tags[1], n % 2 ? "wave" : "decay");
+}
+
+/* Decompress and checksum every frame without storing anything */
+static double decode_seconds(void) {
+    kolibri_pack_reader_t* reader = kolibri_pack_open(PACK_PATH);
+    if (!reader) return -1.0;
+    kolibri_pack_stats_t stats;
+    kolibri_pack_stats(reader, &stats);
+    
+    uint32_t largest = 0;
+    for (uint32_t i = 0; i < stats.frames; i++) {
+        const kolibri_pack_frame_t* frame = kolibri_pack_frame(reader, i);
+        if (frame->raw_size > largest) largest = frame->raw_size;
+    }
+    uint8_t* raw = (uint8_t*)malloc(largest);
+    double start = bench_now();
+    int result = raw ? KOLIBRI_PACK_OK : KOLIBRI_PACK_ERROR;
+    for (uint32_t i = 0; i < stats.frames && result == KOLIBRI_PACK_OK; i++) {
+        result = kolibri_pack_read_frame(reader, i, raw);
+    }
+    double elapsed = bench_now() - start;
+    free(raw);
+    kolibri_pack_close(reader);
+    return result == KOLIBRI_PACK_OK ? elapsed : -1.0;
+}
+
+static int bench_formulas(uint32_t count, int sign) {
+    static const uint8_t private_key[32] = { 7 };
+    kolibri_core_t* source = kolibri_init(NULL);
+    if (!source) return -1;
+    for (uint32_t i = 0; i < count; i++) {
+        kolibri_formula_t formula;
+        char code[128];
+        make_formula(&formula, code, i);
+        if (sign) kolibri_sign_formula(&formula, private_key);
+        if (kolibri_formula_create(source, &formula) != KOLIBRI_OK) {
+            kolibri_destroy(source);
+            return -1;
+        }
+    }
+    
+    kolibri_pack_stats_t stats;
+    int result = kolibri_storage_export(source, RAW_PATH);
+    double start = bench_now();
+    if (result == KOLIBRI_OK) result = kolibri_storage_export_pack(source, PACK_PATH, &stats);
+    double export_seconds = bench_now() - start;
+    kolibri_destroy(source);
+    if (result != KOLIBRI_OK) return -1;
+    
+    long raw = file_size(RAW_PATH);
+    printf("%u %s formulas: raw export %ld B, pack %llu B (%.1fx), %u frames\n",
+           count, sign ? "signed" : "unsigned", raw, (unsigned long long)stats.packed_bytes,
+           (double)raw / (double)stats.packed_bytes, stats.frames);
+    printf("  pack export          %7.0f MB/s of raw data\n", (double)stats.raw_bytes / export_seconds / 1e6);
+    double decode = decode_seconds();
+    if (decode < 0) return -1;
+    printf("  decode + CRC         %7.0f MB/s of raw data\n", (double)stats.raw_bytes / decode / 1e6);
+    
+    for (uint32_t threads = 1; threads <= 4; threads *= 4) {
+        kolibri_core_t* core = kolibri_init(NULL);
+        start = bench_now();
+        result = core ? kolibri_storage_import_pack(core, PACK_PATH, threads, NULL) : KOLIBRI_ERROR;
+        double import_seconds = bench_now() - start;
+        kolibri_destroy(core);
+        if (result != KOLIBRI_OK) return -1;
+        printf("  import, %u thread%s    %7.0f MB/s of raw data\n", threads, threads == 1 ? " " : "s",
+               (double)stats.raw_bytes / import_seconds / 1e6);
+    }
+    
+    remove(RAW_PATH);
+    remove(PACK_PATH);
+    return 0;
+}
+
+/* Blocks with sparse formula IDs, half of them signed */
+static int bench_chain(uint32_t blocks) {
+    static const uint8_t private_key[32] = { 7 };
+    kolibri_chain_t* chain = chain_init(NULL);
+    if (!chain) return -1;
+    uint8_t ids[16][32];
+    for (uint32_t b = 0; b < blocks; b++) {
+        for (uint32_t k = 0; k < 16; k++) {
+            uint32_t n = b * 16 + k;
+            memset(ids[k], 0, 32);
+            memcpy(ids[k], &n, sizeof(n));
+            ids[k][31] = 1;
+        }
+        kolibri_block_t block;
+        if (chain_create_block(chain, b % 2 ? private_key : NULL, (const uint8_t (*)[32])ids,
+                               1 + b % 16, &block) != CHAIN_OK ||
+            chain_add_block(chain, &block) != CHAIN_OK) {
+            chain_destroy(chain);
+            return -1;
+        }
+    }
+    
+    kolibri_pack_stats_t stats;
+    int result = chain_export(chain, CHAIN_RAW_PATH);
+    if (result == CHAIN_OK) result = chain_export_pack(chain, PACK_PATH, &stats);
+    chain_destroy(chain);
+    if (result != CHAIN_OK) return -1;
+    
+    long raw = file_size(CHAIN_RAW_PATH);
+    printf("%u blocks: raw export %ld B, pack %llu B (%.2fx)\n", blocks, raw,
+           (unsigned long long)stats.packed_bytes, (double)raw / (double)stats.packed_bytes);
+    
+    chain = chain_init(NULL);
+    double start = bench_now();
+    result = chain ? chain_import_pack(chain, PACK_PATH, 0, NULL) : CHAIN_ERROR;
+    double import_seconds = bench_now() - start;
+    chain_destroy(chain);
+    if (result != CHAIN_OK) return -1;
+    printf("  import               %7.0f blocks/s\n", blocks / import_seconds);
+    
+    remove(CHAIN_RAW_PATH);
+    remove(PACK_PATH);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 20000;
+    if (count == 0) return 1;
+    
+    if (bench_formulas(count, 1) != 0 || bench_formulas(count, 0) != 0 || bench_chain(count / 4) != 0) {
+        fprintf(stderr, "bench_pack failed\n");
+        return 1;
+    }
+    return 0;
+}
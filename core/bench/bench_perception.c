@@ -0,0 +1,206 @@
+/**
+ * KOLIBRI.AI Benchmarks - Tokenizer, dictionary mapping and signal statistics
+ *
+ * Text is English-like words with 10% Cyrillic, em dashes, NBSP and CJK
+ * full stops, streamed through a 1 MB buffer.
+ * Usage: bench_perception [megabytes]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "kolibri_perception.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_SIZE (1u << 20)
+#define WORD_COUNT 20000
+#define DICT_WORDS 5000
+
+static uint32_t rng_state = 7;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static char words[WORD_COUNT][16];
+
+static void make_words(void) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGH";
+    for (int i = 0; i < WORD_COUNT; i++) {
+        int len = 2 + (int)(rng() % 9);
+        for (int k = 0; k < len; k++) words[i][k] = letters[rng() % (sizeof(letters) - 1)];
+        words[i][len] = '\0';
+    }
+}
+
+/* Fill text[0..len) with words and separators, skewed towards common words */
+static void make_text(uint8_t* text, size_t len) {
+    static const char* cyrillic[] = {
+        "\xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82", "\xD0\xBC\xD0\xB8\xD1\x80",
+        "\xD0\xB4\xD0\xB0\xD0\xBD\xD0\xBD\xD1\x8B\xD0\xB5",
+    };
+    static const char* separators[] = {
+        " ", " ", " ", " ", ", ", ". ", "\n", " \xE2\x80\x94 ", "\xC2\xA0", "; ", "\xE3\x80\x82",
+    };
+    size_t at = 0;
+    while (at < len) {
+        uint32_t r = rng();
+        uint32_t pick = (r >> 4) % WORD_COUNT;
+        const char* word = r % 10 == 0 ? cyrillic[r % 3] : words[pick * pick % WORD_COUNT];
+        const char* separator = separators[(r >> 20) % 11];
+        size_t word_len = strlen(word), separator_len = strlen(separator);
+        if (at + word_len + separator_len > len) break;
+        memcpy(text + at, word, word_len);
+        memcpy(text + at + word_len, separator, separator_len);
+        at += word_len + separator_len;
+    }
+    memset(text + at, ' ', len - at);
+}
+
+static int is_word_byte(uint8_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
+}
+
+/* The per-character loop a bytecode interpreter stepping over a string
+ * would run; it ignores the Unicode separators */
+static size_t naive_tokenize(const uint8_t* text, size_t len, kolibri_token_t* tokens) {
+    size_t count = 0, i = 0;
+    while (i < len) {
+        if (!is_word_byte(text[i])) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        while (i < len && is_word_byte(text[i])) i++;
+        tokens[count].offset = (uint32_t)start;
+        tokens[count].length = (uint32_t)(i - start);
+        count++;
+    }
+    return count;
+}
+
+#define MODE_TOKENIZE 0
+#define MODE_MAP 1
+#define MODE_NAIVE 2
+
+/* Stream text through a CHUNK_SIZE buffer; returns compute seconds */
+static double stream(const uint8_t* text, size_t len, int mode, const kolibri_dict_t* dict,
+                     size_t* token_total, size_t* found_total) {
+    uint8_t* buffer = (uint8_t*)malloc(CHUNK_SIZE);
+    kolibri_token_t* tokens = (kolibri_token_t*)malloc(CHUNK_SIZE * sizeof(kolibri_token_t));
+    uint32_t* codes = (uint32_t*)malloc(CHUNK_SIZE * sizeof(uint32_t));
+    if (!buffer || !tokens || !codes) exit(1);
+    
+    size_t at = 0, have = 0;
+    double seconds = 0.0;
+    *token_total = 0;
+    *found_total = 0;
+    for (;;) {
+        size_t take = len - at < CHUNK_SIZE - have ? len - at : CHUNK_SIZE - have;
+        memcpy(buffer + have, text + at, take);
+        at += take;
+        have += take;
+        int final = at == len;
+        
+        double start = bench_now();
+        size_t consumed, count;
+        if (mode == MODE_NAIVE) {
+            count = naive_tokenize(buffer, have, tokens);
+            consumed = have;
+        } else {
+            uint32_t flags = (final ? KOLIBRI_TOKENIZE_FINAL : 0) | (mode == MODE_MAP ? KOLIBRI_TOKENIZE_LOWER : 0);
+            count = kolibri_tokenize(buffer, have, flags, tokens, CHUNK_SIZE, &consumed);
+        }
+        if (mode == MODE_MAP) *found_total += kolibri_dict_map(dict, buffer, tokens, count, UINT32_MAX, codes);
+        seconds += bench_now() - start;
+        
+        *token_total += count;
+        memmove(buffer, buffer + consumed, have - consumed);
+        have -= consumed;
+        if (final && have == 0) break;
+    }
+    
+    free(buffer);
+    free(tokens);
+    free(codes);
+    return seconds;
+}
+
+/* A dictionary of the first distinct lower-cased words */
+static kolibri_dict_t* make_dict(void) {
+    static char lowered[DICT_WORDS][16];
+    static const char* entries[DICT_WORDS];
+    static uint32_t codes[DICT_WORDS];
+    uint32_t count = 0;
+    for (int i = 0; i < WORD_COUNT && count < DICT_WORDS; i++) {
+        char word[16];
+        size_t k;
+        for (k = 0; words[i][k]; k++) word[k] = (char)(words[i][k] | 0x20);
+        word[k] = '\0';
+        int duplicate = 0;
+        for (uint32_t j = 0; j < count && !duplicate; j++) duplicate = strcmp(lowered[j], word) == 0;
+        if (duplicate) continue;
+        strcpy(lowered[count], word);
+        entries[count] = lowered[count];
+        codes[count] = count;
+        count++;
+    }
+    return kolibri_dict_build(entries, codes, count);
+}
+
+static void bench_signal(size_t count) {
+    float* values = (float*)malloc(count * sizeof(float));
+    if (!values) exit(1);
+    for (size_t i = 0; i < count; i++) values[i] = 1000.0f + (float)(rng() % 100000) / 1000.0f;
+    
+    kolibri_signal_stats_t stats;
+    kolibri_signal_init(&stats);
+    double start = bench_now();
+    for (size_t at = 0; at < count; at += 65536) {
+        kolibri_signal_update(&stats, values + at, count - at < 65536 ? count - at : 65536);
+    }
+    double update = bench_now() - start;
+    
+    start = bench_now();
+    kolibri_signal_normalize(&stats, KOLIBRI_NORMALIZE_ZSCORE, values, values, count);
+    double normalize = bench_now() - start;
+    
+    double bytes = (double)count * sizeof(float);
+    printf("signal, %.0f MB of floats: update %.2f GB/s, normalize %.2f GB/s\n",
+           bytes / 1e6, bytes / update / 1e9, bytes / normalize / 1e9);
+    free(values);
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+    if (megabytes == 0) return 1;
+    size_t len = megabytes << 20;
+    uint8_t* text = (uint8_t*)malloc(len);
+    if (!text) return 1;
+    make_words();
+    make_text(text, len);
+    kolibri_dict_t* dict = make_dict();
+    if (!dict) return 1;
+    
+    static const char* labels[] = {
+        "kolibri_tokenize", "tokenize + lowercase + map", "per-character loop baseline",
+    };
+    printf("%zu MB of text, %u-word dictionary\n", megabytes, kolibri_dict_size(dict));
+    for (int mode = MODE_TOKENIZE; mode <= MODE_NAIVE; mode++) {
+        size_t tokens, found;
+        double seconds = stream(text, len, mode, dict, &tokens, &found);
+        printf("  %-28s %5.2f GB/s, %zu tokens, %.1f ns/token", labels[mode],
+               (double)len / seconds / 1e9, tokens, seconds / (double)tokens * 1e9);
+        if (mode == MODE_MAP) printf(", %zu found", found);
+        printf("\n");
+    }
+    
+    kolibri_dict_free(dict);
+    free(text);
+    bench_signal(len / sizeof(float));
+    return 0;
+}
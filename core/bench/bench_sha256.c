@@ -0,0 +1,70 @@
+/**
+ * KOLIBRI.AI Benchmarks - SHA-256 throughput per backend
+ *
+ * Includes the implementation so each supported backend can be timed.
+ * Usage: bench_sha256
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "../src/kolibri_sha256.c"
+#include "bench_util.h"
+#include <stdio.h>
+
+/* Hash count messages of len bytes with the batch API */
+static double batch_seconds(const uint8_t* buffer, size_t len, size_t count) {
+    const uint8_t** data = (const uint8_t**)malloc(count * sizeof(*data));
+    size_t* lens = (size_t*)malloc(count * sizeof(*lens));
+    uint8_t (*hashes)[KOLIBRI_SHA256_SIZE] = (uint8_t (*)[KOLIBRI_SHA256_SIZE])malloc(count * KOLIBRI_SHA256_SIZE);
+    if (!data || !lens || !hashes) exit(1);
+    for (size_t i = 0; i < count; i++) {
+        data[i] = buffer + i * len;
+        lens[i] = len;
+    }
+    
+    double start = bench_now();
+    kolibri_sha256_batch(data, lens, count, hashes);
+    double elapsed = bench_now() - start;
+    
+    free(data);
+    free(lens);
+    free(hashes);
+    return elapsed;
+}
+
+int main(void) {
+    const size_t total = 64u << 20;
+    uint8_t* buffer = (uint8_t*)malloc(total);
+    if (!buffer) return 1;
+    for (size_t i = 0; i < total; i++) buffer[i] = (uint8_t)(i * 131);
+    
+    int backends[3];
+    int backend_count = 0;
+    backends[backend_count++] = SHA256_GENERIC;
+#ifdef KOLIBRI_SHA256_X86
+    if (__builtin_cpu_supports("avx2")) backends[backend_count++] = SHA256_AVX2;
+    if (sha256_detect() == SHA256_SHANI) backends[backend_count++] = SHA256_SHANI;
+#endif
+    
+    for (int b = 0; b < backend_count; b++) {
+        atomic_store(&sha256_selected, backends[b]);
+        printf("%s\n", kolibri_sha256_backend());
+        
+        uint8_t hash[KOLIBRI_SHA256_SIZE];
+        double start = bench_now();
+        kolibri_sha256(buffer, total, hash);
+        double elapsed = bench_now() - start;
+        printf("  bulk 64 MiB          %6.2f GB/s\n", (double)total / elapsed / 1e9);
+        
+        static const size_t sizes[] = { 32, 176, 4096 };
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            size_t count = total / sizes[s];
+            if (count > (1u << 20)) count = 1u << 20;
+            elapsed = batch_seconds(buffer, sizes[s], count);
+            printf("  batch %4zu B messages %6.2f M hashes/s, %5.2f GB/s\n", sizes[s],
+                   (double)count / elapsed / 1e6, (double)(count * sizes[s]) / elapsed / 1e9);
+        }
+    }
+    
+    free(buffer);
+    return 0;
+}
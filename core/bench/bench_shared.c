@@ -0,0 +1,120 @@
+/**
+ * KOLIBRI.AI Benchmarks - Worker reads from a shared segment
+ *
+ * Forked workers attach one segment and each read every formula twice;
+ * each reports its read rate and how much private memory that cost, which
+ * the code cache bounds at KOLIBRI_SHARED_CODE_CACHE. Linux only, for the
+ * memfd segment and /proc/self/statm.
+ * Usage: bench_shared [formulas] [workers]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include "kolibri_shared.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define CODE_SIZE 1024
+
+static void make_formula(kolibri_formula_t* formula, uint8_t* code, uint32_t n) {
+    memset(formula, 0, sizeof(*formula));
+    memcpy(formula->id, &n, sizeof(n));
+    formula->id[31] = 4;
+    formula->version = 1;
+    formula->code_size = CODE_SIZE / 2 + n % (CODE_SIZE / 2);
+    for (uint32_t i = 0; i < formula->code_size; i++) code[i] = (uint8_t)(n + i);
+    formula->code = code;
+}
+
+/* Resident pages not shared with other processes, in KB, or -1 */
+static long private_kb(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return -1;
+    long size, resident, shared;
+    int read = fscanf(f, "%ld %ld %ld", &size, &resident, &shared);
+    fclose(f);
+    return read == 3 ? (resident - shared) * (sysconf(_SC_PAGESIZE) / 1024) : -1;
+}
+
+static int run_worker(int worker, kolibri_shared_t* shared, uint32_t count) {
+    kolibri_shared_t* mapping;
+    if (kolibri_shared_attach_fd(kolibri_shared_fd(shared), &mapping) != KOLIBRI_OK) return 1;
+    kolibri_core_t* core = kolibri_init(NULL);
+    if (!core || kolibri_attach_shared(core, mapping) != KOLIBRI_OK) return 1;
+    long before = private_kb();
+    
+    uint64_t code_bytes = 0;
+    double start = bench_now();
+    for (uint32_t round = 0; round < 2; round++) {
+        for (uint32_t n = 0; n < count; n++) {
+            uint8_t id[KOLIBRI_ID_SIZE] = { 0 };
+            memcpy(id, &n, sizeof(n));
+            id[31] = 4;
+            kolibri_formula_t formula;
+            if (kolibri_formula_get(core, id, &formula) != KOLIBRI_OK) return 1;
+            code_bytes += formula.code_size;
+        }
+    }
+    double seconds = bench_now() - start;
+    long after = private_kb();
+    
+    printf("  worker %d: %6.2f us/get, %.1f MB of code read, private memory %+ld KB\n", worker,
+           seconds / (2.0 * count) * 1e6, (double)code_bytes / 1e6, after - before);
+    kolibri_destroy(core);
+    kolibri_shared_close(mapping);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 20000;
+    int workers = argc > 2 ? atoi(argv[2]) : 4;
+    if (count == 0 || workers <= 0) return 1;
+    
+    kolibri_shared_t* shared;
+    kolibri_core_t* coordinator = kolibri_init(NULL);
+    if (!coordinator ||
+        kolibri_shared_create(NULL, count + count / 2, count * (CODE_SIZE + 256), &shared) != KOLIBRI_OK ||
+        kolibri_attach_shared(coordinator, shared) != KOLIBRI_OK) {
+        fprintf(stderr, "bench_shared: no segment\n");
+        return 1;
+    }
+    static uint8_t code[CODE_SIZE];
+    for (uint32_t n = 0; n < count; n++) {
+        kolibri_formula_t formula;
+        make_formula(&formula, code, n);
+        if (kolibri_formula_create(coordinator, &formula) != KOLIBRI_OK) {
+            fprintf(stderr, "bench_shared: create failed\n");
+            return 1;
+        }
+    }
+    
+    printf("%u formulas, %d workers, code cache %u KB per worker\n", count, workers,
+           KOLIBRI_SHARED_CODE_CACHE / 1024);
+    fflush(stdout);
+    int failed = 0, started = 0;
+    for (int w = 0; w < workers; w++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            failed = 1;
+            break;
+        }
+        if (pid == 0) {
+            int result = run_worker(w, shared, count);
+            fflush(stdout);
+            _exit(result);
+        }
+        started++;
+    }
+    for (int w = 0; w < started; w++) {
+        int status;
+        failed |= wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    
+    kolibri_destroy(coordinator);
+    kolibri_shared_close(shared);
+    if (failed) fprintf(stderr, "bench_shared: worker failed\n");
+    return failed;
+}
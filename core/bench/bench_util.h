@@ -0,0 +1,17 @@
+/**
+ * KOLIBRI.AI Benchmarks - Timing helpers shared by the bench programs
+ */
+
+#ifndef KOLIBRI_BENCH_UTIL_H
+#define KOLIBRI_BENCH_UTIL_H
+
+#include <time.h>
+
+/* Monotonic wall time in seconds */
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+#endif /* KOLIBRI_BENCH_UTIL_H */
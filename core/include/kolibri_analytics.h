@@ -0,0 +1,84 @@
+/**
+ * KOLIBRI.AI Analytics - Formula similarity (Role 4)
+ * Structural hashes and MinHash/LSH over canonicalized formula code
+ */
+
+#ifndef KOLIBRI_ANALYTICS_H
+#define KOLIBRI_ANALYTICS_H
+
+#include "kolibri_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Canonical form: code is split into identifier, number and symbol tokens,
+ * whitespace and // comments are dropped, and identifiers naming an input
+ * or output are replaced by its position, so reformatting or renaming
+ * parameters leaves it unchanged. The structure hash is SHA-256 of the
+ * canonical tokens and the input/output counts.
+ *
+ * MinHash runs over 3-token shingles. Its values are split into
+ * KOLIBRI_LSH_BANDS bands of KOLIBRI_LSH_ROWS; two formulas are candidates
+ * when any band matches, which makes pairs above ~0.5 Jaccard similarity
+ * likely to be found and pairs below ~0.3 unlikely.
+ */
+#define KOLIBRI_MINHASH_SIZE 64
+#define KOLIBRI_LSH_BANDS 16
+#define KOLIBRI_LSH_ROWS (KOLIBRI_MINHASH_SIZE / KOLIBRI_LSH_BANDS)
+
+typedef struct {
+    uint8_t structure[32];
+    uint32_t minhash[KOLIBRI_MINHASH_SIZE];
+} kolibri_sketch_t;
+
+void kolibri_formula_sketch(const kolibri_formula_t* formula, kolibri_sketch_t* sketch);
+
+/* Estimated Jaccard similarity of the canonical shingle sets; 1 when the
+ * structures are identical */
+float kolibri_sketch_similarity(const kolibri_sketch_t* a, const kolibri_sketch_t* b);
+
+/* Index from formula ID to sketch, with structure and LSH band lookups */
+typedef struct kolibri_similarity_index_t kolibri_similarity_index_t;
+
+typedef struct {
+    uint8_t id[KOLIBRI_ID_SIZE];
+    float similarity;
+} kolibri_similar_t;
+
+kolibri_similarity_index_t* kolibri_similarity_create(void);
+void kolibri_similarity_destroy(kolibri_similarity_index_t* index);
+
+/* Make room for one more formula so the next insert cannot fail */
+int kolibri_similarity_reserve(kolibri_similarity_index_t* index);
+void kolibri_similarity_insert(kolibri_similarity_index_t* index, const uint8_t* id,
+                               const kolibri_sketch_t* sketch); /* Replaces id */
+void kolibri_similarity_remove(kolibri_similarity_index_t* index, const uint8_t* id);
+
+/* Formulas other than exclude_id (may be NULL) at least threshold similar
+ * to sketch, most similar first; *count receives how many were written */
+int kolibri_similarity_query(kolibri_similarity_index_t* index, const kolibri_sketch_t* sketch,
+                             const uint8_t* exclude_id, float threshold,
+                             kolibri_similar_t* results, uint32_t max_results, uint32_t* count);
+
+/* Core API: search the stored formulas for ones similar to formula */
+int kolibri_formula_find_similar(kolibri_core_t* core, const kolibri_formula_t* formula,
+                                 float threshold, kolibri_similar_t* results,
+                                 uint32_t max_results, uint32_t* count);
+
+/*
+ * Reject creating a formula under a new ID when a stored one is a
+ * duplicate: with threshold 1 only structurally identical code counts,
+ * below 1 anything at least that similar. 0 (the default) disables it.
+ * Rejected creates return KOLIBRI_ERROR_DUPLICATE. Import and sync store
+ * such formulas anyway: peers would otherwise never agree on the stored set,
+ * and an import would depend on the order of the file.
+ */
+int kolibri_set_duplicate_threshold(kolibri_core_t* core, float threshold);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KOLIBRI_ANALYTICS_H */
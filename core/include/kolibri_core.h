@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "kolibri_pack.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -74,6 +75,7 @@ int kolibri_formula_get(kolibri_core_t* core, const uint8_t* id, kolibri_formula
 int kolibri_formula_update(kolibri_core_t* core, const kolibri_formula_t* formula);
 int kolibri_formula_delete(kolibri_core_t* core, const uint8_t* id);
 int kolibri_formula_list(kolibri_core_t* core, kolibri_formula_t** formulas, uint32_t* count);
+void kolibri_generate_id(uint8_t* id); /* What create uses for an all-zero ID */
 
 /* Formula execution */
 typedef struct {
@@ -92,9 +94,21 @@ int kolibri_formula_mutate(kolibri_core_t* core, const uint8_t* parent_id,
 int kolibri_formula_crossover(kolibri_core_t* core, const uint8_t* parent1_id,
                               const uint8_t* parent2_id, kolibri_formula_t* child);
 
-/* Storage operations */
+/* Storage operations. Exports carry each formula's code bytes. When a
+ * trusted key is set, import reads the file into memory once, verifies every
+ * signature and returns KOLIBRI_ERROR_SIGNATURE without importing anything
+ * if one fails; what is stored is exactly what was verified. */
 int kolibri_storage_export(kolibri_core_t* core, const char* path);
 int kolibri_storage_import(kolibri_core_t* core, const char* path);
+int kolibri_set_trusted_key(kolibri_core_t* core, const uint8_t* public_key); /* NULL clears */
+
+/* Compressed packs (kolibri_pack.h) of little-endian formula records in the
+ * kolibri_ring.h layout, each preceded by its length u32. Import stores each
+ * frame while up to `threads` workers (0 = one per CPU) decompress the next
+ * ones; kolibri_storage_import also accepts packs. stats may be NULL. */
+int kolibri_storage_export_pack(kolibri_core_t* core, const char* path, kolibri_pack_stats_t* stats);
+int kolibri_storage_import_pack(kolibri_core_t* core, const char* path, uint32_t threads,
+                                kolibri_pack_stats_t* stats);
 
 /* Metrics */
 typedef struct {
@@ -107,10 +121,17 @@ typedef struct {
 
 int kolibri_get_metrics(kolibri_core_t* core, kolibri_metrics_t* metrics);
 
-/* Signature operations */
+/* Signature operations (Ed25519; private keys are 32-byte seeds). The
+ * signature covers everything except fitness, timestamp and itself. */
+int kolibri_derive_public_key(const uint8_t* private_key, uint8_t* public_key);
 int kolibri_sign_formula(kolibri_formula_t* formula, const uint8_t* private_key);
 int kolibri_verify_formula(const kolibri_formula_t* formula, const uint8_t* public_key);
 
+/* Batch-verify count formulas signed by public_key across worker threads.
+ * Returns KOLIBRI_OK if all are valid; valid (optional) gets 1/0 per formula. */
+int kolibri_verify_formula_batch(const kolibri_formula_t* formulas, uint32_t count,
+                                 const uint8_t* public_key, int* valid);
+
 /* Error codes */
 #define KOLIBRI_OK 0
 #define KOLIBRI_ERROR -1
@@ -119,6 +140,8 @@ int kolibri_verify_formula(const kolibri_formula_t* formula, const uint8_t* publ
 #define KOLIBRI_ERROR_STORAGE -4
 #define KOLIBRI_ERROR_EXECUTION -5
 #define KOLIBRI_ERROR_SIGNATURE -6
+#define KOLIBRI_ERROR_TRANSPORT -7
+#define KOLIBRI_ERROR_DUPLICATE -8
 
 #ifdef __cplusplus
 }
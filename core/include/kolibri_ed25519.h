@@ -0,0 +1,56 @@
+/**
+ * KOLIBRI.AI Ed25519
+ * Self-contained Ed25519 (RFC 8032) signing with batch verification
+ */
+
+#ifndef KOLIBRI_ED25519_H
+#define KOLIBRI_ED25519_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KOLIBRI_ED25519_SEED_SIZE 32
+#define KOLIBRI_ED25519_PUBLIC_KEY_SIZE 32
+#define KOLIBRI_ED25519_SIGNATURE_SIZE 64
+
+/* Signatures per multi-scalar multiplication in batch verification */
+#define KOLIBRI_ED25519_BATCH_SIZE 64
+
+/* Derive the public key for a 32-byte secret seed */
+void kolibri_ed25519_public_key(const uint8_t* seed, uint8_t* public_key);
+
+/* Sign message with seed; public_key must be the seed's public key */
+void kolibri_ed25519_sign(const uint8_t* seed, const uint8_t* public_key,
+                          const void* message, size_t len, uint8_t* signature);
+
+/* Returns 0 if the signature is valid, -1 otherwise. Uses the cofactored
+ * equation [8][S]B = [8]R + [8][h]A so results agree with batch mode. */
+int kolibri_ed25519_verify(const uint8_t* public_key, const void* message, size_t len,
+                           const uint8_t* signature);
+
+/* Verify count signatures using a randomized multi-scalar multiplication
+ * per KOLIBRI_ED25519_BATCH_SIZE signatures. Returns 0 if all are valid.
+ * If valid is non-NULL, valid[i] is set to 1 or 0 for each signature;
+ * a failing batch is re-checked one signature at a time to fill it in.
+ *
+ * The 128-bit weights come from a hash of 32 bytes of OS entropy
+ * (getentropy, drawn per call) and of every signature, key and challenge
+ * in the batch. The entropy keeps them unpredictable, so a forger cannot
+ * make invalid signatures cancel out. If getentropy fails the weights are
+ * still bound to the whole batch (Fiat-Shamir style); cancelling would then
+ * need a SHA-512 collision or preimage, which is believed infeasible but is
+ * a weaker argument than true randomness. */
+int kolibri_ed25519_verify_batch(const uint8_t* const* messages, const size_t* lens,
+                                 const uint8_t* const* public_keys,
+                                 const uint8_t* const* signatures,
+                                 size_t count, int* valid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KOLIBRI_ED25519_H */
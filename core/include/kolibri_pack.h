@@ -0,0 +1,109 @@
+/**
+ * KOLIBRI.AI Pack - Compressed streaming container
+ * Built-in LZ codec, CRC32C-checked frames and a seekable frame index
+ */
+
+#ifndef KOLIBRI_PACK_H
+#define KOLIBRI_PACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Pack layout. All integers are little-endian:
+ *
+ *   header   magic "KPK1" u32, kind u32, frame_size u32, reserved u32
+ *   frames   raw_size u32, stored_size u32, record_count u32, crc u32,
+ *            then stored_size bytes. A frame holds whole records and is
+ *            LZ-compressed unless KOLIBRI_PACK_STORED is set in
+ *            stored_size. crc is CRC32C of the raw bytes.
+ *   index    per frame: offset u64, raw_size u32, stored_size u32,
+ *            record_count u32, crc u32
+ *   trailer  index_offset u64, record_count u64, frame_count u32,
+ *            index_crc u32, magic "KPKI" u32
+ *
+ * Frames are self-delimiting, so a pack can also be read front to back.
+ */
+#define KOLIBRI_PACK_MAGIC 0x314B504B       /* "KPK1" */
+#define KOLIBRI_PACK_INDEX_MAGIC 0x494B504B /* "KPKI" */
+#define KOLIBRI_PACK_FRAME_SIZE (128u * 1024)
+#define KOLIBRI_PACK_MAX_FRAME (64u << 20)
+#define KOLIBRI_PACK_STORED 0x80000000u
+
+#define KOLIBRI_PACK_KIND_FORMULAS 1 /* Length u32 + formula record (kolibri_ring.h) */
+#define KOLIBRI_PACK_KIND_BLOCKS 2   /* Compact block encoding */
+
+#define KOLIBRI_PACK_OK 0
+#define KOLIBRI_PACK_ERROR -1         /* I/O, allocation or malformed pack */
+#define KOLIBRI_PACK_ERROR_CORRUPT -2 /* Frame failed to decode or its checksum */
+
+/* LZ block codec (LZ4-style sequences, 64 KB window). compress needs
+ * capacity >= kolibri_lz_bound(len) and returns the compressed size, or 0;
+ * decompress returns 0 only if src decodes to exactly raw_len bytes. */
+size_t kolibri_lz_bound(size_t len);
+size_t kolibri_lz_compress(const uint8_t* src, size_t len, uint8_t* dst, size_t capacity);
+int kolibri_lz_decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t raw_len);
+
+/* CRC32C, SSE4.2 when available */
+uint32_t kolibri_crc32c(uint32_t crc, const void* data, size_t len);
+
+typedef struct {
+    uint64_t raw_bytes;    /* Uncompressed record bytes */
+    uint64_t packed_bytes; /* File size */
+    uint64_t records;
+    uint32_t frames;
+} kolibri_pack_stats_t;
+
+/* Writer: records are appended whole and never span frames */
+typedef struct kolibri_pack_writer_t kolibri_pack_writer_t;
+
+kolibri_pack_writer_t* kolibri_pack_create(const char* path, uint32_t kind);
+int kolibri_pack_append(kolibri_pack_writer_t* writer, const void* record, size_t len);
+/* Writes the index and closes the file; frees the writer either way */
+int kolibri_pack_finish(kolibri_pack_writer_t* writer, kolibri_pack_stats_t* stats);
+
+/* Reader */
+typedef struct {
+    uint64_t offset;       /* Of the frame header */
+    uint64_t first_record;
+    uint32_t raw_size;
+    uint32_t stored_size;  /* Without the KOLIBRI_PACK_STORED flag */
+    uint32_t record_count;
+    uint32_t crc;
+    int compressed;
+} kolibri_pack_frame_t;
+
+typedef struct kolibri_pack_reader_t kolibri_pack_reader_t;
+
+kolibri_pack_reader_t* kolibri_pack_open(const char* path);
+void kolibri_pack_close(kolibri_pack_reader_t* reader);
+uint32_t kolibri_pack_kind(const kolibri_pack_reader_t* reader);
+int kolibri_pack_stats(const kolibri_pack_reader_t* reader, kolibri_pack_stats_t* stats);
+const kolibri_pack_frame_t* kolibri_pack_frame(const kolibri_pack_reader_t* reader, uint32_t index);
+
+/* Frame holding record number `record`, by binary search of the index */
+int kolibri_pack_find_record(const kolibri_pack_reader_t* reader, uint64_t record, uint32_t* index);
+
+/* Decompress and check one frame into raw (raw_size bytes) */
+int kolibri_pack_read_frame(kolibri_pack_reader_t* reader, uint32_t index, uint8_t* raw);
+
+/*
+ * Stream frames first..end through consume, in order, on the calling
+ * thread while worker threads decompress and check the frames after it.
+ * threads = 0 uses one per online CPU. A non-zero return from consume
+ * stops the stream and is returned.
+ */
+typedef int (*kolibri_pack_consume_t)(void* ctx, const uint8_t* data, size_t len, uint32_t record_count);
+
+int kolibri_pack_stream(kolibri_pack_reader_t* reader, uint32_t first, uint32_t threads,
+                        kolibri_pack_consume_t consume, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KOLIBRI_PACK_H */
@@ -0,0 +1,93 @@
+/**
+ * KOLIBRI.AI Perception - Tokenization, dictionaries and signal normalization (Role 1)
+ * Native implementations of the DSL built-ins tokenize, count_matches and normalize
+ */
+
+#ifndef KOLIBRI_PERCEPTION_H
+#define KOLIBRI_PERCEPTION_H
+
+#include "kolibri_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Tokens are maximal runs of word bytes in UTF-8 text: ASCII letters,
+ * digits and '_', and every non-ASCII character except Latin-1 punctuation
+ * and spaces (U+0080-U+00BF), general punctuation (U+2000-U+206F) and CJK
+ * punctuation (U+3000-U+303F). Classification runs 64 bytes at a time with
+ * SSE2; only blocks containing those separator lead bytes take a scalar path.
+ */
+typedef struct {
+    uint32_t offset; /* Byte offset into the text */
+    uint32_t length;
+} kolibri_token_t;
+
+#define KOLIBRI_TOKENIZE_FINAL 1 /* No more text follows; a token may end the buffer */
+#define KOLIBRI_TOKENIZE_LOWER 2 /* Fold ASCII letters to lower case in place */
+
+/*
+ * Tokenize text[0..len) into at most max_tokens spans and return how many
+ * were written. *consumed receives the bytes fully processed; tokenization
+ * resumes there, after the caller carries over the rest. Without
+ * KOLIBRI_TOKENIZE_FINAL a token reaching the end of the buffer is left
+ * unconsumed, so streams can be fed chunk by chunk. len must be < 4 GB.
+ */
+size_t kolibri_tokenize(uint8_t* text, size_t len, uint32_t flags, kolibri_token_t* tokens,
+                        size_t max_tokens, size_t* consumed);
+
+/*
+ * Static dictionary from token to code, built as a perfect hash (hash and
+ * displace, ~90% load): a lookup is one hash, one seed read and one key
+ * compare, whatever the dictionary size.
+ */
+typedef struct kolibri_dict_t kolibri_dict_t;
+
+/* NULL on allocation failure, duplicate words or empty words */
+kolibri_dict_t* kolibri_dict_build(const char* const* words, const uint32_t* codes, uint32_t count);
+void kolibri_dict_free(kolibri_dict_t* dict);
+uint32_t kolibri_dict_size(const kolibri_dict_t* dict);
+
+int kolibri_dict_lookup(const kolibri_dict_t* dict, const uint8_t* token, size_t len, uint32_t* code);
+
+/* Map tokens of text to codes, writing missing for unknown tokens; returns
+ * how many were found */
+size_t kolibri_dict_map(const kolibri_dict_t* dict, const uint8_t* text, const kolibri_token_t* tokens,
+                        size_t count, uint32_t missing, uint32_t* codes);
+
+/* count_matches(tokens, words) */
+size_t kolibri_dict_count_matches(const kolibri_dict_t* dict, const uint8_t* text,
+                                  const kolibri_token_t* tokens, size_t count);
+
+/*
+ * Streaming signal statistics: values can arrive in any number of updates
+ * and the result matches one pass over all of them (Welford/Chan merging
+ * with double accumulators).
+ */
+typedef struct {
+    uint64_t count;
+    double mean;
+    double m2; /* Sum of squared deviations from the mean */
+    float min;
+    float max;
+} kolibri_signal_stats_t;
+
+#define KOLIBRI_NORMALIZE_ZSCORE 0
+#define KOLIBRI_NORMALIZE_MINMAX 1
+
+void kolibri_signal_init(kolibri_signal_stats_t* stats);
+void kolibri_signal_update(kolibri_signal_stats_t* stats, const float* values, size_t count);
+void kolibri_signal_merge(kolibri_signal_stats_t* stats, const kolibri_signal_stats_t* other);
+double kolibri_signal_stddev(const kolibri_signal_stats_t* stats); /* Population */
+
+/* Normalize by the statistics seen so far: z-score (x - mean) / stddev, or
+ * min-max to [0, 1]. A constant signal maps to 0. in and out may alias. */
+int kolibri_signal_normalize(const kolibri_signal_stats_t* stats, int mode, const float* in,
+                             float* out, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KOLIBRI_PERCEPTION_H */
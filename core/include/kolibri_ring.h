@@ -0,0 +1,126 @@
+/**
+ * KOLIBRI.AI Ring - Submission/completion queues in flat memory
+ * Batched execute/get/create without per-call marshaling
+ */
+
+#ifndef KOLIBRI_RING_H
+#define KOLIBRI_RING_H
+
+#include "kolibri_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Ring layout. One contiguous region, little-endian, offsets from its start:
+ *
+ *   0     header (kolibri_ring_t, 192 bytes)
+ *   192   submission queue: sq_entries x 64-byte kolibri_ring_sqe_t
+ *   ...   completion queue: cq_entries x 16-byte kolibri_ring_cqe_t
+ *   ...   data area: data_size bytes holding request and result payloads
+ *
+ * Head and tail indices are free-running u32; entry i lives in slot
+ * i & (entries - 1). The submitter writes SQEs and then advances sq_tail;
+ * kolibri_ring_process consumes up to sq_tail, writes one CQE per SQE and
+ * advances sq_head and cq_tail after every 64 completions and at the end of
+ * the batch; the submitter reads CQEs up to cq_tail and advances cq_head.
+ * Each side only stores to its own indices, which sit on separate cache
+ * lines, so a JS SharedArrayBuffer or another thread can drive the ring
+ * without locks. Processing stops early when the completion queue is full.
+ *
+ * Payloads are addressed by (offset, length) from the start of the ring and
+ * must lie inside the data area; a request's input and output must not
+ * overlap. Strings are length-prefixed (u8 length, bytes, no NUL).
+ *
+ * Value list (execute input and output):
+ *   count u32, then per value: type u8, size u32, size bytes
+ *
+ * Formula record (get output, create input):
+ *   0    id[32]
+ *   32   version u32
+ *   36   cost u32
+ *   40   fitness f32
+ *   44   timestamp u64
+ *   52   code_size u32
+ *   56   input_count u8, output_count u8, provenance_count u8, tag_count u8
+ *   60   signature[64]
+ *   124  input names, output names (strings), provenances (32 bytes each),
+ *        tags (strings), then code_size bytes of code
+ */
+#define KOLIBRI_RING_MAGIC 0x3151524B /* "KRQ1" */
+#define KOLIBRI_RING_HEADER_SIZE 192
+#define KOLIBRI_RING_FORMULA_HEADER_SIZE 124
+
+/* Opcodes */
+#define KOLIBRI_RING_OP_EXECUTE 1 /* id; in: value list; out: value list */
+#define KOLIBRI_RING_OP_GET 2     /* id; out: formula record */
+#define KOLIBRI_RING_OP_CREATE 3  /* in: formula record; out (optional): 32-byte stored ID */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t sq_entries;  /* Power of two */
+    uint32_t cq_entries;  /* Power of two */
+    uint32_t data_size;
+    uint32_t sq_offset;
+    uint32_t cq_offset;
+    uint32_t data_offset;
+    uint32_t reserved[9];
+    uint32_t sq_tail;     /* 64: written by the submitter */
+    uint32_t cq_head;
+    uint32_t submitter_pad[14];
+    uint32_t sq_head;     /* 128: written by the core */
+    uint32_t cq_tail;
+    uint32_t core_pad[14];
+} kolibri_ring_t;
+
+typedef struct {
+    uint64_t user_data;   /* Copied to the completion */
+    uint8_t opcode;
+    uint8_t flags;        /* Must be 0 */
+    uint16_t reserved;
+    uint32_t in_offset;
+    uint32_t in_len;
+    uint32_t out_offset;
+    uint32_t out_len;
+    uint32_t reserved2;
+    uint8_t id[KOLIBRI_ID_SIZE];
+} kolibri_ring_sqe_t;
+
+/* result is a KOLIBRI_* code; len is the bytes written to the output, or
+ * the bytes needed when the output was too small (KOLIBRI_ERROR_INVALID_PARAM) */
+typedef struct {
+    uint64_t user_data;
+    int32_t result;
+    uint32_t len;
+} kolibri_ring_cqe_t;
+
+/* Bytes needed for a ring, or 0 if the sizes are invalid */
+size_t kolibri_ring_size(uint32_t sq_entries, uint32_t cq_entries, uint32_t data_size);
+
+/* Lay out a ring in caller-provided memory (8-byte aligned, size from
+ * kolibri_ring_size); returns memory, or NULL if it does not fit */
+kolibri_ring_t* kolibri_ring_init(void* memory, size_t size, uint32_t sq_entries,
+                                  uint32_t cq_entries, uint32_t data_size);
+
+/* Process up to max_batch submissions (0 = all pending); processed may be NULL */
+int kolibri_ring_process(kolibri_core_t* core, kolibri_ring_t* ring, uint32_t max_batch,
+                         uint32_t* processed);
+
+/* Submitter side for native callers. submit returns KOLIBRI_ERROR when the
+ * submission queue is full; reap returns KOLIBRI_ERROR_NOT_FOUND when there
+ * is no completion. */
+uint8_t* kolibri_ring_data(kolibri_ring_t* ring);
+int kolibri_ring_submit(kolibri_ring_t* ring, const kolibri_ring_sqe_t* sqe);
+int kolibri_ring_reap(kolibri_ring_t* ring, kolibri_ring_cqe_t* cqe);
+
+/* Formula record codec. encode returns the record size and writes it only
+ * if it fits in capacity; decode points formula->code into record. */
+size_t kolibri_ring_encode_formula(const kolibri_formula_t* formula, uint8_t* record, size_t capacity);
+int kolibri_ring_decode_formula(const uint8_t* record, size_t len, kolibri_formula_t* formula);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KOLIBRI_RING_H */
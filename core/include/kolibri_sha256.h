@@ -0,0 +1,46 @@
+/**
+ * KOLIBRI.AI SHA-256
+ * Built-in SHA-256 with runtime-dispatched SHA-NI and AVX2 multi-buffer paths
+ */
+
+#ifndef KOLIBRI_SHA256_H
+#define KOLIBRI_SHA256_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KOLIBRI_SHA256_SIZE 32
+#define KOLIBRI_SHA256_BLOCK_SIZE 64
+
+/* Streaming context */
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t buffer[KOLIBRI_SHA256_BLOCK_SIZE];
+    size_t buffered;
+} kolibri_sha256_ctx_t;
+
+void kolibri_sha256_init(kolibri_sha256_ctx_t* ctx);
+void kolibri_sha256_update(kolibri_sha256_ctx_t* ctx, const void* data, size_t len);
+void kolibri_sha256_final(kolibri_sha256_ctx_t* ctx, uint8_t* hash);
+
+/* One-shot hash */
+void kolibri_sha256(const void* data, size_t len, uint8_t* hash);
+
+/* Hash count independent messages; hashes[i] receives H(data[i]). On the
+ * AVX2 backend messages of similar length are hashed eight at a time. */
+void kolibri_sha256_batch(const uint8_t* const* data, const size_t* lens, size_t count,
+                          uint8_t (*hashes)[KOLIBRI_SHA256_SIZE]);
+
+/* Name of the selected backend: "sha-ni", "avx2" or "generic" */
+const char* kolibri_sha256_backend(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KOLIBRI_SHA256_H */
@@ -0,0 +1,114 @@
+/**
+ * KOLIBRI.AI Shared Store - Formula store in a shared memory segment
+ * One writer process publishes, any number of worker processes read
+ */
+
+#ifndef KOLIBRI_SHARED_H
+#define KOLIBRI_SHARED_H
+
+#include "kolibri_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Segment layout. One memfd or POSIX shm object, native byte order, every
+ * reference an offset from the segment start so each process may map it
+ * anywhere:
+ *
+ *   0     header (256 bytes)
+ *   256   half 0: slot table (slot_count x u64), then data_size bytes
+ *   ...   half 1: same layout
+ *
+ * A slot is 0 (empty), 1 (deleted), or a record offset with 16 hash bits
+ * on top; records are a u32 length, 4 reserved bytes and a formula record
+ * in the ring format (kolibri_ring.h), 8-byte aligned. Only one half is
+ * published at a time.
+ *
+ * The writer appends a record to the published half and then stores its
+ * slot with release semantics; replaced and deleted records stay in place.
+ * When the half runs out of data or slots, the writer rebuilds the live
+ * records into the other half and publishes it by switching the active
+ * index. Before it starts writing into a half, it bumps the generation;
+ * readers sample the generation before and after a lookup and retry when
+ * it moved, so they never lock, never write to the segment (they map it
+ * read-only) and never block the writer. Each half holds at most data_size
+ * bytes, so the segment needs about twice the live data.
+ */
+#define KOLIBRI_SHARED_MAGIC 0x314D534B /* "KSM1" */
+#define KOLIBRI_SHARED_HEADER_SIZE 256
+
+typedef struct kolibri_shared_t kolibri_shared_t;
+
+/* Bytes a segment for max_formulas formulas and data_size bytes of records
+ * per half occupies, or 0 if the sizes are invalid */
+size_t kolibri_shared_size(uint32_t max_formulas, uint32_t data_size);
+
+/*
+ * Create a segment and open it for writing. With a name (e.g.
+ * "/kolibri-cluster") it is a POSIX shm object that workers attach by name
+ * and that must be removed with kolibri_shared_unlink; with NULL it is an
+ * anonymous memfd (Linux) shared by handing kolibri_shared_fd to workers,
+ * through fork or SCM_RIGHTS, and gone when the last process closes it.
+ */
+int kolibri_shared_create(const char* name, uint32_t max_formulas, uint32_t data_size,
+                          kolibri_shared_t** shared);
+
+/* Map an existing segment read-only */
+int kolibri_shared_attach(const char* name, kolibri_shared_t** shared);
+int kolibri_shared_attach_fd(int fd, kolibri_shared_t** shared); /* fd is duplicated */
+
+void kolibri_shared_close(kolibri_shared_t* shared);
+int kolibri_shared_unlink(const char* name);
+int kolibri_shared_fd(const kolibri_shared_t* shared);
+int kolibri_shared_writable(const kolibri_shared_t* shared);
+
+/* Writer side. put replaces a stored formula with the same ID; both return
+ * KOLIBRI_ERROR_STORAGE when the segment cannot hold the live formulas. */
+int kolibri_shared_put(kolibri_shared_t* shared, const kolibri_formula_t* formula);
+int kolibri_shared_delete(kolibri_shared_t* shared, const uint8_t* id);
+
+/*
+ * Copy a formula out of the segment. Its code goes to code (code_size is
+ * at most KOLIBRI_MAX_FORMULA_SIZE); with code NULL only the metadata is
+ * read and formula->code is NULL.
+ */
+int kolibri_shared_get(const kolibri_shared_t* shared, const uint8_t* id, kolibri_formula_t* formula,
+                       uint8_t* code, uint32_t code_capacity);
+
+/* IDs of the published formulas, up to max_ids; *count receives how many
+ * were written */
+int kolibri_shared_ids(const kolibri_shared_t* shared, uint8_t (*ids)[KOLIBRI_ID_SIZE],
+                       uint32_t max_ids, uint32_t* count);
+
+uint32_t kolibri_shared_count(const kolibri_shared_t* shared);
+
+/* Increases with every published change, so workers can tell when to
+ * refresh anything derived from the store */
+uint64_t kolibri_shared_version(const kolibri_shared_t* shared);
+
+/* Bytes of code a core keeps private copies of for formulas it reads from
+ * a segment; at least twice KOLIBRI_MAX_FORMULA_SIZE */
+#define KOLIBRI_SHARED_CODE_CACHE (1u << 20)
+
+/*
+ * Core API: back a core with a segment. Formulas the core does not hold
+ * are read from the segment by get, list and execute. get copies their
+ * code into the core, which keeps the most recently read copies up to
+ * KOLIBRI_SHARED_CODE_CACHE bytes: returned code stays valid until the
+ * segment holds different code for that ID, the core detaches, or the
+ * core has read that many bytes of other formulas' code since, so the
+ * last two reads are always valid. list copies the code into the array it
+ * returns instead. If the segment is
+ * writable, the core's formulas are published to it now and every create,
+ * update, delete, import and sync afterwards. NULL detaches; the caller
+ * keeps ownership of shared.
+ */
+int kolibri_attach_shared(kolibri_core_t* core, kolibri_shared_t* shared);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KOLIBRI_SHARED_H */
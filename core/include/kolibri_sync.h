@@ -0,0 +1,106 @@
+/**
+ * KOLIBRI.AI Sync - Delta synchronization between cores (Role 8)
+ * Set reconciliation over (formula ID, version) with invertible Bloom lookup tables
+ */
+
+#ifndef KOLIBRI_SYNC_H
+#define KOLIBRI_SYNC_H
+
+#include "kolibri_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Invertible Bloom lookup table over 36-byte keys (ID || version, little-endian).
+ * Each key is added to one cell in each of KOLIBRI_IBLT_HASHES subtables of
+ * `size` cells, at hash & (size - 1). Because size is a power of two, a table
+ * folds to any smaller power of two by adding cell i + size/2 into cell i, so
+ * the core maintains one table at KOLIBRI_IBLT_MAX_SIZE and sends a fold sized
+ * to the expected difference.
+ */
+#define KOLIBRI_SYNC_KEY_SIZE (KOLIBRI_ID_SIZE + 4)
+#define KOLIBRI_IBLT_HASHES 3
+#define KOLIBRI_IBLT_MIN_SIZE 32
+#define KOLIBRI_IBLT_MAX_SIZE 2048
+
+typedef struct {
+    int32_t count;
+    uint8_t key[KOLIBRI_SYNC_KEY_SIZE];
+    uint64_t check;
+} kolibri_iblt_cell_t;
+
+typedef struct {
+    uint32_t size; /* Cells per subtable, power of two */
+    kolibri_iblt_cell_t* cells; /* KOLIBRI_IBLT_HASHES * size */
+} kolibri_iblt_t;
+
+int kolibri_iblt_init(kolibri_iblt_t* table, uint32_t size);
+void kolibri_iblt_free(kolibri_iblt_t* table);
+void kolibri_iblt_update(kolibri_iblt_t* table, const uint8_t* id, uint32_t version, int32_t delta);
+int kolibri_iblt_fold(const kolibri_iblt_t* table, uint32_t size, kolibri_iblt_t* out);
+
+/* The core's table, kept current by create/update/delete */
+const kolibri_iblt_t* kolibri_sync_table(kolibri_core_t* core);
+
+/* The key set with kolibri_set_trusted_key, or NULL if none is */
+const uint8_t* kolibri_sync_trusted_key(kolibri_core_t* core);
+
+/* Create a received formula. Unlike kolibri_formula_create it is never
+ * refused as a duplicate: a refused record would stay in the set
+ * difference, so every later session would send it again. */
+int kolibri_sync_store(kolibri_core_t* core, const kolibri_formula_t* formula);
+
+/* Every stored key, for reconciling differences too large for the table;
+ * the caller frees *keys */
+int kolibri_sync_keys(kolibri_core_t* core, uint8_t (**keys)[KOLIBRI_SYNC_KEY_SIZE], uint32_t* count);
+
+/*
+ * Byte-stream transport. send writes all len bytes, recv reads exactly len
+ * bytes; both return 0 or a negative error.
+ */
+typedef struct kolibri_transport_t {
+    int (*send)(struct kolibri_transport_t* transport, const void* data, size_t len);
+    int (*recv)(struct kolibri_transport_t* transport, void* data, size_t len);
+    void (*destroy)(struct kolibri_transport_t* transport);
+} kolibri_transport_t;
+
+void kolibri_transport_destroy(kolibri_transport_t* transport);
+
+/* Two connected in-process endpoints; each side must run on its own thread */
+int kolibri_transport_pair(kolibri_transport_t** a, kolibri_transport_t** b);
+
+/* Unix domain sockets: listen returns a listening fd for accept */
+int kolibri_transport_unix_listen(const char* path);
+kolibri_transport_t* kolibri_transport_unix_accept(int listen_fd);
+kolibri_transport_t* kolibri_transport_unix_connect(const char* path);
+
+/* Sync statistics for one session */
+typedef struct {
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint32_t formulas_sent;
+    uint32_t formulas_received;
+    uint32_t rounds;    /* IBLT exchanges */
+    uint32_t full_list; /* 1 if the difference outgrew the IBLT */
+} kolibri_sync_stats_t;
+
+/*
+ * Two-way sync: afterwards both cores hold the newest version of every
+ * formula either had. One side initiates, the other responds. Deletions
+ * are not propagated, and the duplicate threshold does not apply to
+ * received formulas. With a trusted key set, every received record is
+ * verified before any is stored, and a bad signature fails the sync with
+ * KOLIBRI_ERROR_SIGNATURE. stats may be NULL.
+ */
+int kolibri_sync_initiate(kolibri_core_t* core, kolibri_transport_t* transport,
+                          kolibri_sync_stats_t* stats);
+int kolibri_sync_respond(kolibri_core_t* core, kolibri_transport_t* transport,
+                         kolibri_sync_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KOLIBRI_SYNC_H */
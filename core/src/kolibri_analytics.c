@@ -0,0 +1,541 @@
+/**
+ * KOLIBRI.AI Analytics Implementation
+ *
+ * The index keeps one entry per formula in a flat array. Entries are linked
+ * by u32 index into chains hanging off three kinds of head tables: by ID,
+ * by structure hash, and one table per LSH band keyed by that band's hash.
+ * A query walks the chains its own band hashes select, deduplicating
+ * candidates with a per-query stamp, and scores each by its full MinHash.
+ */
+
+#include "kolibri_analytics.h"
+#include "kolibri_sha256.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KOLIBRI_ANALYTICS_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#define INDEX_NONE UINT32_MAX
+#define INDEX_INITIAL_CAPACITY 1024
+#define SHINGLE_SIZE 3
+#define SHINGLE_BATCH 64
+
+#define TOKEN_SYMBOL 1
+#define TOKEN_NUMBER 2
+#define TOKEN_NAME 3
+#define TOKEN_INPUT 4
+#define TOKEN_OUTPUT 5
+#define TOKEN_ARITY 6
+
+/* ---- Canonicalization ---- */
+
+static uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static int is_name_start(uint8_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static int is_name_char(uint8_t c) {
+    return is_name_start(c) || (c >= '0' && c <= '9');
+}
+
+/* Position of a parameter named exactly [name, name + len), or -1 */
+static int find_param(const char (*params)[64], int count, const uint8_t* name, size_t len) {
+    if (len >= 64) return -1;
+    for (int i = 0; i < count; i++) {
+        if (strncmp(params[i], (const char*)name, len) == 0 && params[i][len] == '\0') return i;
+    }
+    return -1;
+}
+
+/* ---- MinHash ---- */
+
+/*
+ * v_i(x) = ((a_i * x + b_i) mod 2^64) >> 32 over 32-bit shingle hashes x,
+ * with odd 64-bit a_i and 64-bit b_i: multiply-add-shift hashing. a_i must
+ * be wider than x, or the product never wraps and every v_i picks the same
+ * smallest x.
+ */
+static uint64_t minhash_a[KOLIBRI_MINHASH_SIZE];
+static uint64_t minhash_b[KOLIBRI_MINHASH_SIZE];
+static pthread_once_t minhash_once = PTHREAD_ONCE_INIT;
+
+#ifdef KOLIBRI_ANALYTICS_X86
+static int minhash_avx2;
+
+/*
+ * AVX2 form: v_i = hi32(lo32(a_i) * x + b_i) + lo32(hi32(a_i) * x), the
+ * first term from vpmuludq on even and odd lanes, the second from vpmulld.
+ */
+static uint32_t minhash_a_lo[KOLIBRI_MINHASH_SIZE];
+static uint32_t minhash_a_hi[KOLIBRI_MINHASH_SIZE];
+static uint64_t minhash_b_even[KOLIBRI_MINHASH_SIZE / 2];
+static uint64_t minhash_b_odd[KOLIBRI_MINHASH_SIZE / 2];
+
+static int cpu_has_avx2(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX)) return 0;
+    uint32_t xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6) return 0;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2);
+}
+
+__attribute__((target("avx2")))
+static void minhash_add_avx2(uint32_t* minhash, const uint32_t* shingles, size_t count) {
+    for (int g = 0; g < KOLIBRI_MINHASH_SIZE; g += 8) {
+        __m256i a_even = _mm256_loadu_si256((const __m256i*)&minhash_a_lo[g]);
+        __m256i a_odd = _mm256_srli_epi64(a_even, 32);
+        __m256i a_hi = _mm256_loadu_si256((const __m256i*)&minhash_a_hi[g]);
+        __m256i b_even = _mm256_loadu_si256((const __m256i*)&minhash_b_even[g / 2]);
+        __m256i b_odd = _mm256_loadu_si256((const __m256i*)&minhash_b_odd[g / 2]);
+        __m256i min = _mm256_loadu_si256((const __m256i*)&minhash[g]);
+        for (size_t i = 0; i < count; i++) {
+            __m256i x = _mm256_set1_epi32((int)shingles[i]);
+            __m256i even = _mm256_add_epi64(_mm256_mul_epu32(a_even, x), b_even);
+            __m256i odd = _mm256_add_epi64(_mm256_mul_epu32(a_odd, x), b_odd);
+            __m256i v = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+            v = _mm256_add_epi32(v, _mm256_mullo_epi32(a_hi, x));
+            min = _mm256_min_epu32(min, v);
+        }
+        _mm256_storeu_si256((__m256i*)&minhash[g], min);
+    }
+}
+#endif /* KOLIBRI_ANALYTICS_X86 */
+
+static void minhash_init(void) {
+    uint64_t state = 0x4B4F4C4942524921ull; /* Fixed so sketches compare across cores */
+    for (int i = 0; i < KOLIBRI_MINHASH_SIZE; i++) {
+        state += 0x9E3779B97F4A7C15ull;
+        minhash_a[i] = mix64(state) | 1;
+        state += 0x9E3779B97F4A7C15ull;
+        minhash_b[i] = mix64(state);
+    }
+#ifdef KOLIBRI_ANALYTICS_X86
+    for (int i = 0; i < KOLIBRI_MINHASH_SIZE; i++) {
+        minhash_a_lo[i] = (uint32_t)minhash_a[i];
+        minhash_a_hi[i] = (uint32_t)(minhash_a[i] >> 32);
+    }
+    for (int i = 0; i < KOLIBRI_MINHASH_SIZE; i += 2) {
+        minhash_b_even[i / 2] = minhash_b[i];
+        minhash_b_odd[i / 2] = minhash_b[i + 1];
+    }
+    minhash_avx2 = cpu_has_avx2();
+#endif
+}
+
+static void minhash_add(uint32_t* minhash, const uint32_t* shingles, size_t count) {
+#ifdef KOLIBRI_ANALYTICS_X86
+    if (minhash_avx2) {
+        minhash_add_avx2(minhash, shingles, count);
+        return;
+    }
+#endif
+    for (size_t s = 0; s < count; s++) {
+        for (int i = 0; i < KOLIBRI_MINHASH_SIZE; i++) {
+            uint32_t v = (uint32_t)((minhash_a[i] * shingles[s] + minhash_b[i]) >> 32);
+            if (v < minhash[i]) minhash[i] = v;
+        }
+    }
+}
+
+/* Sketch under construction: tokens stream through a shingle-sized window */
+typedef struct {
+    kolibri_sha256_ctx_t ctx;
+    uint64_t window[SHINGLE_SIZE];
+    size_t tokens;
+    uint32_t shingles[SHINGLE_BATCH];
+    size_t pending;
+    kolibri_sketch_t* sketch;
+} sketch_state_t;
+
+static uint64_t token_hash(uint8_t kind, const uint8_t* bytes, size_t len) {
+    uint64_t h = 0xCBF29CE484222325ull ^ kind;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return mix64(h ^ len);
+}
+
+static void push_shingle(sketch_state_t* st, uint64_t shingle) {
+    st->shingles[st->pending++] = (uint32_t)shingle;
+    if (st->pending == SHINGLE_BATCH) {
+        minhash_add(st->sketch->minhash, st->shingles, st->pending);
+        st->pending = 0;
+    }
+}
+
+static void push_token(sketch_state_t* st, uint8_t kind, const uint8_t* bytes, size_t len) {
+    uint8_t head[3] = { kind, (uint8_t)len, (uint8_t)(len >> 8) };
+    kolibri_sha256_update(&st->ctx, head, sizeof(head));
+    kolibri_sha256_update(&st->ctx, bytes, len);
+    
+    memmove(st->window, st->window + 1, (SHINGLE_SIZE - 1) * sizeof(uint64_t));
+    st->window[SHINGLE_SIZE - 1] = token_hash(kind, bytes, len);
+    if (++st->tokens >= SHINGLE_SIZE) {
+        uint64_t h = 0;
+        for (int i = 0; i < SHINGLE_SIZE; i++) h = mix64(h ^ st->window[i]);
+        push_shingle(st, h);
+    }
+}
+
+/* Split code into canonical tokens */
+static void canonicalize(const kolibri_formula_t* formula, sketch_state_t* st) {
+    const uint8_t* code = formula->code;
+    size_t size = code ? formula->code_size : 0;
+    int input_count = formula->input_count < KOLIBRI_MAX_INPUTS ? formula->input_count : KOLIBRI_MAX_INPUTS;
+    int output_count = formula->output_count < KOLIBRI_MAX_OUTPUTS ? formula->output_count : KOLIBRI_MAX_OUTPUTS;
+    
+    for (size_t i = 0; i < size; ) {
+        uint8_t c = code[i];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v') {
+            i++;
+            continue;
+        }
+        if (c == '/' && i + 1 < size && code[i + 1] == '/') {
+            while (i < size && code[i] != '\n') i++;
+            continue;
+        }
+        
+        size_t start = i;
+        if (is_name_start(c)) {
+            while (i < size && is_name_char(code[i])) i++;
+            int k = find_param(formula->inputs, input_count, code + start, i - start);
+            uint8_t pos = (uint8_t)k;
+            if (k >= 0) {
+                push_token(st, TOKEN_INPUT, &pos, 1);
+                continue;
+            }
+            k = find_param(formula->outputs, output_count, code + start, i - start);
+            pos = (uint8_t)k;
+            if (k >= 0) {
+                push_token(st, TOKEN_OUTPUT, &pos, 1);
+                continue;
+            }
+            push_token(st, TOKEN_NAME, code + start, i - start);
+        } else if (c >= '0' && c <= '9') {
+            while (i < size && (is_name_char(code[i]) || code[i] == '.')) i++;
+            push_token(st, TOKEN_NUMBER, code + start, i - start);
+        } else {
+            i++;
+            push_token(st, TOKEN_SYMBOL, code + start, 1);
+        }
+    }
+}
+
+void kolibri_formula_sketch(const kolibri_formula_t* formula, kolibri_sketch_t* sketch) {
+    pthread_once(&minhash_once, minhash_init);
+    
+    sketch_state_t st;
+    memset(&st, 0, sizeof(st));
+    st.sketch = sketch;
+    memset(sketch->minhash, 0xFF, sizeof(sketch->minhash));
+    kolibri_sha256_init(&st.ctx);
+    if (formula->code_size <= KOLIBRI_MAX_FORMULA_SIZE) canonicalize(formula, &st);
+    
+    /* Code shorter than a shingle is one shingle of its tokens */
+    if (st.tokens > 0 && st.tokens < SHINGLE_SIZE) {
+        uint64_t h = 0;
+        for (size_t i = SHINGLE_SIZE - st.tokens; i < SHINGLE_SIZE; i++) h = mix64(h ^ st.window[i]);
+        push_shingle(&st, h);
+    }
+    
+    /* The arity is part of the structure and one more shingle */
+    uint8_t arity[2] = { formula->input_count, formula->output_count };
+    kolibri_sha256_update(&st.ctx, arity, sizeof(arity));
+    kolibri_sha256_final(&st.ctx, sketch->structure);
+    push_shingle(&st, token_hash(TOKEN_ARITY, arity, sizeof(arity)));
+    minhash_add(sketch->minhash, st.shingles, st.pending);
+}
+
+float kolibri_sketch_similarity(const kolibri_sketch_t* a, const kolibri_sketch_t* b) {
+    if (memcmp(a->structure, b->structure, sizeof(a->structure)) == 0) return 1.0f;
+    
+    int same = 0;
+    for (int i = 0; i < KOLIBRI_MINHASH_SIZE; i++) same += a->minhash[i] == b->minhash[i];
+    
+    /* A full match with different structures is still not identical */
+    if (same == KOLIBRI_MINHASH_SIZE) same--;
+    return (float)same / KOLIBRI_MINHASH_SIZE;
+}
+
+static uint32_t band_hash(const kolibri_sketch_t* sketch, int band) {
+    uint64_t h = (uint64_t)band;
+    for (int r = 0; r < KOLIBRI_LSH_ROWS; r++) {
+        h = mix64(h ^ sketch->minhash[band * KOLIBRI_LSH_ROWS + r]);
+    }
+    return (uint32_t)h;
+}
+
+static uint32_t id_hash(const uint8_t* id) {
+    uint64_t h = 0;
+    for (int i = 0; i < KOLIBRI_ID_SIZE; i += 8) {
+        uint64_t word;
+        memcpy(&word, id + i, sizeof(word));
+        h = mix64(h ^ word);
+    }
+    return (uint32_t)h;
+}
+
+static uint32_t structure_hash(const uint8_t* structure) {
+    uint32_t h;
+    memcpy(&h, structure, sizeof(h));
+    return h;
+}
+
+/* ---- Index ---- */
+
+typedef struct {
+    uint8_t id[KOLIBRI_ID_SIZE];
+    kolibri_sketch_t sketch;
+    uint32_t bands[KOLIBRI_LSH_BANDS];
+    uint32_t id_next;    /* Also the free list link */
+    uint32_t structure_next;
+    uint32_t band_next[KOLIBRI_LSH_BANDS];
+    uint32_t stamp;
+} index_entry_t;
+
+struct kolibri_similarity_index_t {
+    index_entry_t* entries;
+    uint32_t capacity;
+    uint32_t used;       /* Entries ever handed out */
+    uint32_t free_head;
+    uint32_t count;
+    uint32_t table_size; /* Power of two >= capacity */
+    uint32_t* id_heads;
+    uint32_t* structure_heads;
+    uint32_t* band_heads; /* KOLIBRI_LSH_BANDS * table_size */
+    uint32_t stamp;
+};
+
+static uint32_t* band_head(kolibri_similarity_index_t* index, int band, uint32_t hash) {
+    return &index->band_heads[(size_t)band * index->table_size + (hash & (index->table_size - 1))];
+}
+
+static void link_entry(kolibri_similarity_index_t* index, uint32_t e) {
+    index_entry_t* entry = &index->entries[e];
+    uint32_t mask = index->table_size - 1;
+    
+    uint32_t* head = &index->id_heads[id_hash(entry->id) & mask];
+    entry->id_next = *head;
+    *head = e;
+    
+    head = &index->structure_heads[structure_hash(entry->sketch.structure) & mask];
+    entry->structure_next = *head;
+    *head = e;
+    
+    for (int b = 0; b < KOLIBRI_LSH_BANDS; b++) {
+        head = band_head(index, b, entry->bands[b]);
+        entry->band_next[b] = *head;
+        *head = e;
+    }
+}
+
+/* Replace the head tables with ones of table_size slots and relink everything */
+static int rehash(kolibri_similarity_index_t* index, uint32_t table_size) {
+    uint32_t* id_heads = (uint32_t*)malloc((size_t)table_size * sizeof(uint32_t));
+    uint32_t* structure_heads = (uint32_t*)malloc((size_t)table_size * sizeof(uint32_t));
+    uint32_t* band_heads = (uint32_t*)malloc((size_t)table_size * KOLIBRI_LSH_BANDS * sizeof(uint32_t));
+    if (!id_heads || !structure_heads || !band_heads) {
+        free(id_heads);
+        free(structure_heads);
+        free(band_heads);
+        return KOLIBRI_ERROR_STORAGE;
+    }
+    memset(id_heads, 0xFF, (size_t)table_size * sizeof(uint32_t));
+    memset(structure_heads, 0xFF, (size_t)table_size * sizeof(uint32_t));
+    memset(band_heads, 0xFF, (size_t)table_size * KOLIBRI_LSH_BANDS * sizeof(uint32_t));
+    
+    free(index->id_heads);
+    free(index->structure_heads);
+    free(index->band_heads);
+    index->id_heads = id_heads;
+    index->structure_heads = structure_heads;
+    index->band_heads = band_heads;
+    index->table_size = table_size;
+    
+    /* Free entries are marked by a zero stamp; live ones never have it */
+    for (uint32_t e = 0; e < index->used; e++) {
+        if (index->entries[e].stamp != 0) link_entry(index, e);
+    }
+    return KOLIBRI_OK;
+}
+
+kolibri_similarity_index_t* kolibri_similarity_create(void) {
+    kolibri_similarity_index_t* index =
+        (kolibri_similarity_index_t*)calloc(1, sizeof(kolibri_similarity_index_t));
+    if (!index) return NULL;
+    
+    index->free_head = INDEX_NONE;
+    index->stamp = 1;
+    index->entries = (index_entry_t*)malloc(INDEX_INITIAL_CAPACITY * sizeof(index_entry_t));
+    index->capacity = INDEX_INITIAL_CAPACITY;
+    if (!index->entries || rehash(index, INDEX_INITIAL_CAPACITY) != KOLIBRI_OK) {
+        kolibri_similarity_destroy(index);
+        return NULL;
+    }
+    return index;
+}
+
+void kolibri_similarity_destroy(kolibri_similarity_index_t* index) {
+    if (!index) return;
+    free(index->entries);
+    free(index->id_heads);
+    free(index->structure_heads);
+    free(index->band_heads);
+    free(index);
+}
+
+int kolibri_similarity_reserve(kolibri_similarity_index_t* index) {
+    if (!index) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (index->free_head != INDEX_NONE || index->used < index->capacity) return KOLIBRI_OK;
+    
+    uint32_t capacity = index->capacity * 2;
+    index_entry_t* entries = (index_entry_t*)realloc(index->entries, (size_t)capacity * sizeof(index_entry_t));
+    if (!entries) return KOLIBRI_ERROR_STORAGE;
+    index->entries = entries;
+    
+    int result = rehash(index, capacity);
+    if (result == KOLIBRI_OK) index->capacity = capacity;
+    return result;
+}
+
+static uint32_t find_entry(const kolibri_similarity_index_t* index, const uint8_t* id) {
+    uint32_t e = index->id_heads[id_hash(id) & (index->table_size - 1)];
+    while (e != INDEX_NONE && memcmp(index->entries[e].id, id, KOLIBRI_ID_SIZE) != 0) {
+        e = index->entries[e].id_next;
+    }
+    return e;
+}
+
+/* Unlink entry e from the chain starting at *head whose links are at
+ * byte offset `link` in each entry */
+static void unlink_chain(kolibri_similarity_index_t* index, uint32_t* head, uint32_t e, size_t link) {
+    while (*head != e) {
+        head = (uint32_t*)((uint8_t*)&index->entries[*head] + link);
+    }
+    *head = *(uint32_t*)((uint8_t*)&index->entries[e] + link);
+}
+
+void kolibri_similarity_remove(kolibri_similarity_index_t* index, const uint8_t* id) {
+    if (!index || !id) return;
+    uint32_t e = find_entry(index, id);
+    if (e == INDEX_NONE) return;
+    
+    index_entry_t* entry = &index->entries[e];
+    uint32_t mask = index->table_size - 1;
+    unlink_chain(index, &index->id_heads[id_hash(id) & mask], e, offsetof(index_entry_t, id_next));
+    unlink_chain(index, &index->structure_heads[structure_hash(entry->sketch.structure) & mask], e,
+                 offsetof(index_entry_t, structure_next));
+    for (int b = 0; b < KOLIBRI_LSH_BANDS; b++) {
+        unlink_chain(index, band_head(index, b, entry->bands[b]), e,
+                     offsetof(index_entry_t, band_next) + (size_t)b * sizeof(uint32_t));
+    }
+    
+    entry->stamp = 0;
+    entry->id_next = index->free_head;
+    index->free_head = e;
+    index->count--;
+}
+
+void kolibri_similarity_insert(kolibri_similarity_index_t* index, const uint8_t* id,
+                               const kolibri_sketch_t* sketch) {
+    if (!index || !id || !sketch) return;
+    kolibri_similarity_remove(index, id);
+    if (kolibri_similarity_reserve(index) != KOLIBRI_OK) return;
+    
+    uint32_t e;
+    if (index->free_head != INDEX_NONE) {
+        e = index->free_head;
+        index->free_head = index->entries[e].id_next;
+    } else {
+        e = index->used++;
+    }
+    
+    index_entry_t* entry = &index->entries[e];
+    memcpy(entry->id, id, KOLIBRI_ID_SIZE);
+    entry->sketch = *sketch;
+    for (int b = 0; b < KOLIBRI_LSH_BANDS; b++) entry->bands[b] = band_hash(sketch, b);
+    entry->stamp = index->stamp;
+    link_entry(index, e);
+    index->count++;
+}
+
+/* Keep results sorted by similarity, dropping the least similar when full */
+static void add_result(kolibri_similar_t* results, uint32_t max_results, uint32_t* count,
+                       const uint8_t* id, float similarity) {
+    uint32_t n = *count;
+    if (n == max_results) {
+        if (n == 0 || results[n - 1].similarity >= similarity) return;
+        n--;
+    }
+    while (n > 0 && results[n - 1].similarity < similarity) {
+        results[n] = results[n - 1];
+        n--;
+    }
+    memcpy(results[n].id, id, KOLIBRI_ID_SIZE);
+    results[n].similarity = similarity;
+    if (*count < max_results) (*count)++;
+}
+
+/* Consider entry e once per query */
+static void visit(kolibri_similarity_index_t* index, uint32_t e, const kolibri_sketch_t* sketch,
+                  const uint8_t* exclude_id, float threshold,
+                  kolibri_similar_t* results, uint32_t max_results, uint32_t* count) {
+    index_entry_t* entry = &index->entries[e];
+    if (entry->stamp == index->stamp) return;
+    entry->stamp = index->stamp;
+    if (exclude_id && memcmp(entry->id, exclude_id, KOLIBRI_ID_SIZE) == 0) return;
+    
+    float similarity = kolibri_sketch_similarity(sketch, &entry->sketch);
+    if (similarity >= threshold) add_result(results, max_results, count, entry->id, similarity);
+}
+
+int kolibri_similarity_query(kolibri_similarity_index_t* index, const kolibri_sketch_t* sketch,
+                             const uint8_t* exclude_id, float threshold,
+                             kolibri_similar_t* results, uint32_t max_results, uint32_t* count) {
+    if (!index || !sketch || !count || (!results && max_results > 0)) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (!(threshold >= 0.0f)) return KOLIBRI_ERROR_INVALID_PARAM;
+    *count = 0;
+    
+    /* Stamps mark visited entries; 0 is reserved for free ones */
+    if (++index->stamp == 0) {
+        for (uint32_t e = 0; e < index->used; e++) {
+            if (index->entries[e].stamp != 0) index->entries[e].stamp = 1;
+        }
+        index->stamp = 2;
+    }
+    
+    uint32_t mask = index->table_size - 1;
+    if (threshold >= 1.0f) {
+        uint32_t e = index->structure_heads[structure_hash(sketch->structure) & mask];
+        for (; e != INDEX_NONE; e = index->entries[e].structure_next) {
+            visit(index, e, sketch, exclude_id, 1.0f, results, max_results, count);
+        }
+        return KOLIBRI_OK;
+    }
+    
+    for (int b = 0; b < KOLIBRI_LSH_BANDS; b++) {
+        uint32_t hash = band_hash(sketch, b);
+        uint32_t e = *band_head(index, b, hash);
+        for (; e != INDEX_NONE; e = index->entries[e].band_next[b]) {
+            if (index->entries[e].bands[b] != hash) continue;
+            visit(index, e, sketch, exclude_id, threshold, results, max_results, count);
+        }
+    }
+    return KOLIBRI_OK;
+}
@@ -3,25 +3,68 @@
  */
 
 #include "kolibri_core.h"
+#include "kolibri_analytics.h"
+#include "kolibri_ed25519.h"
+#include "kolibri_ring.h"
+#include "kolibri_sha256.h"
+#include "kolibri_shared.h"
+#include "kolibri_sync.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <pthread.h>
+#include <unistd.h>
 
-/* Simple key-value storage structure */
+#define KOLIBRI_EXPORT_MAGIC 0x4B465232        /* "KFR2": formulas followed by their code */
+#define KOLIBRI_EXPORT_MAGIC_LEGACY 0x4B464F52 /* "KFOR": raw structs, code not saved */
+#define KOLIBRI_IMPORT_CHUNK 1024
+#define KOLIBRI_VERIFY_CHUNK 256
+#define KOLIBRI_VERIFY_MAX_THREADS 16
+#define KV_INITIAL_BUCKETS 1024
+
+/* Key-value storage: a list for iteration plus a hash index for lookups */
 typedef struct kv_entry_t {
     uint8_t key[KOLIBRI_ID_SIZE];
     void* value;
     size_t value_size;
     struct kv_entry_t* next;
+    struct kv_entry_t* prev;
+    struct kv_entry_t* bucket_next;
 } kv_entry_t;
 
+/* Private copy of the code of a formula read from the shared segment */
+typedef struct shared_code_t {
+    uint8_t id[KOLIBRI_ID_SIZE];
+    uint32_t size;
+    struct shared_code_t* next;
+    struct shared_code_t* newer; /* Read order, for eviction */
+    struct shared_code_t* older;
+    uint8_t data[];
+} shared_code_t;
+
 /* Core context structure */
 struct kolibri_core_t {
     char storage_path[256];
     kv_entry_t* storage_head;
+    kv_entry_t** buckets;
+    uint32_t bucket_count; /* Power of two */
+    uint32_t entry_count;
+    kolibri_iblt_t sync_table;
+    kolibri_similarity_index_t* similarity;
+    float duplicate_threshold; /* 0 = duplicates allowed */
     kolibri_metrics_t metrics;
     uint32_t formula_capacity;
+    uint8_t trusted_key[KOLIBRI_ED25519_PUBLIC_KEY_SIZE];
+    int has_trusted_key;
+    kolibri_shared_t* shared;
+    uint8_t shared_code[KOLIBRI_MAX_FORMULA_SIZE]; /* Scratch for reads from shared */
+    shared_code_t** code_buckets; /* Code copies of formulas read from shared */
+    uint32_t code_bucket_count;   /* Power of two, 0 before the first read */
+    uint32_t code_count;
+    size_t code_bytes;            /* At most KOLIBRI_SHARED_CODE_CACHE */
+    shared_code_t* code_newest;
+    shared_code_t* code_oldest;
 };
 
 /* Helper: Generate ID from timestamp and random */
@@ -33,6 +76,10 @@ static void generate_id(uint8_t* id) {
     }
 }
 
+void kolibri_generate_id(uint8_t* id) {
+    if (id) generate_id(id);
+}
+
 /* Helper: Compare IDs */
 static int id_equals(const uint8_t* id1, const uint8_t* id2) {
     return memcmp(id1, id2, KOLIBRI_ID_SIZE) == 0;
@@ -51,11 +98,38 @@ kolibri_core_t* kolibri_init(const char* storage_path) {
     core->formula_capacity = 10000;
     memset(&core->metrics, 0, sizeof(core->metrics));
     
+    core->buckets = (kv_entry_t**)calloc(KV_INITIAL_BUCKETS, sizeof(kv_entry_t*));
+    core->bucket_count = KV_INITIAL_BUCKETS;
+    core->similarity = kolibri_similarity_create();
+    if (!core->buckets || !core->similarity ||
+        kolibri_iblt_init(&core->sync_table, KOLIBRI_IBLT_MAX_SIZE) != KOLIBRI_OK) {
+        kolibri_destroy(core);
+        return NULL;
+    }
+    
     srand((unsigned int)time(NULL));
     
     return core;
 }
 
+static void free_shared_code(kolibri_core_t* core) {
+    for (uint32_t b = 0; b < core->code_bucket_count; b++) {
+        shared_code_t* code = core->code_buckets[b];
+        while (code) {
+            shared_code_t* next = code->next;
+            free(code);
+            code = next;
+        }
+    }
+    free(core->code_buckets);
+    core->code_buckets = NULL;
+    core->code_bucket_count = 0;
+    core->code_count = 0;
+    core->code_bytes = 0;
+    core->code_newest = NULL;
+    core->code_oldest = NULL;
+}
+
 /* Destroy core */
 void kolibri_destroy(kolibri_core_t* core) {
     if (!core) return;
@@ -68,81 +142,196 @@ void kolibri_destroy(kolibri_core_t* core) {
         entry = next;
     }
     
+    free(core->buckets);
+    free_shared_code(core);
+    kolibri_iblt_free(&core->sync_table);
+    kolibri_similarity_destroy(core->similarity);
     free(core);
 }
 
-/* Store formula in key-value storage */
-static int kv_put(kolibri_core_t* core, const uint8_t* key, const void* value, size_t value_size) {
-    /* Check if key exists */
-    kv_entry_t* entry = core->storage_head;
-    while (entry) {
-        if (id_equals(entry->key, key)) {
-            /* Update existing */
-            free(entry->value);
-            entry->value = malloc(value_size);
-            if (!entry->value) return KOLIBRI_ERROR_STORAGE;
-            memcpy(entry->value, value, value_size);
-            entry->value_size = value_size;
-            return KOLIBRI_OK;
-        }
-        entry = entry->next;
+/* Mix an ID down to a bucket; generated IDs start with a timestamp */
+static uint32_t kv_hash(const uint8_t* key) {
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < KOLIBRI_ID_SIZE; i += 8) {
+        uint64_t word;
+        memcpy(&word, key + i, sizeof(word));
+        h ^= word;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    return (uint32_t)h;
+}
+
+static kv_entry_t* kv_find(kolibri_core_t* core, const uint8_t* key) {
+    kv_entry_t* entry = core->buckets[kv_hash(key) & (core->bucket_count - 1)];
+    while (entry && !id_equals(entry->key, key)) {
+        entry = entry->bucket_next;
+    }
+    return entry;
+}
+
+/* Double the bucket array once entries outnumber buckets */
+static int kv_grow(kolibri_core_t* core) {
+    uint32_t count = core->bucket_count * 2;
+    kv_entry_t** buckets = (kv_entry_t**)calloc(count, sizeof(kv_entry_t*));
+    if (!buckets) return KOLIBRI_ERROR_STORAGE;
+    
+    for (kv_entry_t* entry = core->storage_head; entry; entry = entry->next) {
+        uint32_t b = kv_hash(entry->key) & (count - 1);
+        entry->bucket_next = buckets[b];
+        buckets[b] = entry;
+    }
+    
+    free(core->buckets);
+    core->buckets = buckets;
+    core->bucket_count = count;
+    return KOLIBRI_OK;
+}
+
+/* Store value in key-value storage; *stored receives the stored copy */
+static int kv_put(kolibri_core_t* core, const uint8_t* key, const void* value, size_t value_size,
+                  void** stored) {
+    void* copy = malloc(value_size);
+    if (!copy) return KOLIBRI_ERROR_STORAGE;
+    memcpy(copy, value, value_size);
+    
+    /* Update existing */
+    kv_entry_t* entry = kv_find(core, key);
+    if (entry) {
+        free(entry->value);
+        entry->value = copy;
+        entry->value_size = value_size;
+        if (stored) *stored = copy;
+        return KOLIBRI_OK;
+    }
+    
+    if (core->entry_count >= core->bucket_count && kv_grow(core) != KOLIBRI_OK) {
+        free(copy);
+        return KOLIBRI_ERROR_STORAGE;
     }
     
     /* Create new entry */
     kv_entry_t* new_entry = (kv_entry_t*)malloc(sizeof(kv_entry_t));
-    if (!new_entry) return KOLIBRI_ERROR_STORAGE;
-    
-    memcpy(new_entry->key, key, KOLIBRI_ID_SIZE);
-    new_entry->value = malloc(value_size);
-    if (!new_entry->value) {
-        free(new_entry);
+    if (!new_entry) {
+        free(copy);
         return KOLIBRI_ERROR_STORAGE;
     }
-    memcpy(new_entry->value, value, value_size);
+    
+    memcpy(new_entry->key, key, KOLIBRI_ID_SIZE);
+    new_entry->value = copy;
     new_entry->value_size = value_size;
+    new_entry->prev = NULL;
     new_entry->next = core->storage_head;
+    if (core->storage_head) core->storage_head->prev = new_entry;
     core->storage_head = new_entry;
     
+    uint32_t b = kv_hash(key) & (core->bucket_count - 1);
+    new_entry->bucket_next = core->buckets[b];
+    core->buckets[b] = new_entry;
+    core->entry_count++;
+    if (stored) *stored = copy;
+    
     return KOLIBRI_OK;
 }
 
 /* Get formula from key-value storage */
 static int kv_get(kolibri_core_t* core, const uint8_t* key, void* value, size_t* value_size) {
-    kv_entry_t* entry = core->storage_head;
-    while (entry) {
-        if (id_equals(entry->key, key)) {
-            if (value && value_size) {
-                size_t copy_size = *value_size < entry->value_size ? *value_size : entry->value_size;
-                memcpy(value, entry->value, copy_size);
-                *value_size = entry->value_size;
-            }
-            return KOLIBRI_OK;
-        }
-        entry = entry->next;
+    kv_entry_t* entry = kv_find(core, key);
+    if (!entry) return KOLIBRI_ERROR_NOT_FOUND;
+    
+    if (value && value_size) {
+        size_t copy_size = *value_size < entry->value_size ? *value_size : entry->value_size;
+        memcpy(value, entry->value, copy_size);
+        *value_size = entry->value_size;
     }
-    return KOLIBRI_ERROR_NOT_FOUND;
+    return KOLIBRI_OK;
 }
 
 /* Delete formula from key-value storage */
 static int kv_delete(kolibri_core_t* core, const uint8_t* key) {
-    kv_entry_t** entry_ptr = &core->storage_head;
-    while (*entry_ptr) {
-        if (id_equals((*entry_ptr)->key, key)) {
-            kv_entry_t* to_delete = *entry_ptr;
-            *entry_ptr = to_delete->next;
-            free(to_delete->value);
-            free(to_delete);
-            return KOLIBRI_OK;
-        }
-        entry_ptr = &(*entry_ptr)->next;
+    kv_entry_t** bucket_ptr = &core->buckets[kv_hash(key) & (core->bucket_count - 1)];
+    while (*bucket_ptr && !id_equals((*bucket_ptr)->key, key)) {
+        bucket_ptr = &(*bucket_ptr)->bucket_next;
+    }
+    
+    kv_entry_t* to_delete = *bucket_ptr;
+    if (!to_delete) return KOLIBRI_ERROR_NOT_FOUND;
+    
+    *bucket_ptr = to_delete->bucket_next;
+    if (to_delete->prev) {
+        to_delete->prev->next = to_delete->next;
+    } else {
+        core->storage_head = to_delete->next;
     }
-    return KOLIBRI_ERROR_NOT_FOUND;
+    if (to_delete->next) to_delete->next->prev = to_delete->prev;
+    core->entry_count--;
+    
+    free(to_delete->value);
+    free(to_delete);
+    return KOLIBRI_OK;
 }
 
-/* Create formula */
-int kolibri_formula_create(kolibri_core_t* core, const kolibri_formula_t* formula) {
-    if (!core || !formula) return KOLIBRI_ERROR_INVALID_PARAM;
+/* Store a formula together with a private copy of its code; *created is set
+ * when the ID was not stored before. With check_duplicate, a new ID is
+ * refused while a duplicate is stored and the threshold is set. */
+static int store_formula(kolibri_core_t* core, const kolibri_formula_t* formula, int* created,
+                         int check_duplicate) {
+    if (formula->code_size > KOLIBRI_MAX_FORMULA_SIZE) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (formula->code_size > 0 && !formula->code) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    kv_entry_t* existing = kv_find(core, formula->id);
+    uint32_t old_version = existing ? ((const kolibri_formula_t*)existing->value)->version : 0;
+    
+    kolibri_sketch_t sketch;
+    kolibri_formula_sketch(formula, &sketch);
+    if (check_duplicate && !existing && core->duplicate_threshold > 0.0f) {
+        kolibri_similar_t match;
+        uint32_t found = 0;
+        kolibri_similarity_query(core->similarity, &sketch, NULL, core->duplicate_threshold, &match, 1, &found);
+        if (found > 0) return KOLIBRI_ERROR_DUPLICATE;
+    }
+    if (kolibri_similarity_reserve(core->similarity) != KOLIBRI_OK) return KOLIBRI_ERROR_STORAGE;
+    
+    /* Publish first, so a full shared segment leaves the core unchanged */
+    kolibri_shared_t* shared = kolibri_shared_writable(core->shared) ? core->shared : NULL;
+    if (shared) {
+        int result = kolibri_shared_put(shared, formula);
+        if (result != KOLIBRI_OK) return result;
+    }
+    
+    size_t size = sizeof(kolibri_formula_t) + formula->code_size;
+    uint8_t* blob = (uint8_t*)malloc(size);
+    int result = KOLIBRI_ERROR_STORAGE;
+    void* stored = NULL;
+    if (blob) {
+        memcpy(blob, formula, sizeof(kolibri_formula_t));
+        if (formula->code_size > 0) {
+            memcpy(blob + sizeof(kolibri_formula_t), formula->code, formula->code_size);
+        }
+        result = kv_put(core, formula->id, blob, size, &stored);
+        free(blob);
+    }
+    if (result != KOLIBRI_OK) {
+        /* kv_put fails before touching the entry: restore what was published */
+        if (shared && existing) kolibri_shared_put(shared, (const kolibri_formula_t*)existing->value);
+        else if (shared) kolibri_shared_delete(shared, formula->id);
+        return result;
+    }
     
+    /* Point the stored formula at its own code bytes */
+    kolibri_formula_t* copy = (kolibri_formula_t*)stored;
+    copy->code = copy->code_size > 0 ? (uint8_t*)stored + sizeof(kolibri_formula_t) : NULL;
+    
+    /* Keep the sync table in step with the stored (ID, version) set */
+    if (existing) kolibri_iblt_update(&core->sync_table, formula->id, old_version, -1);
+    kolibri_iblt_update(&core->sync_table, formula->id, formula->version, 1);
+    kolibri_similarity_insert(core->similarity, formula->id, &sketch);
+    if (created) *created = !existing;
+    return KOLIBRI_OK;
+}
+
+/* Create formula; import and sync store without the duplicate check */
+static int create_formula(kolibri_core_t* core, const kolibri_formula_t* formula, int check_duplicate) {
     /* Check if ID is zero (generate new) */
     kolibri_formula_t new_formula = *formula;
     int is_zero = 1;
@@ -158,20 +347,112 @@ int kolibri_formula_create(kolibri_core_t* core, const kolibri_formula_t* formul
     
     new_formula.timestamp = (uint64_t)time(NULL);
     
-    int result = kv_put(core, new_formula.id, &new_formula, sizeof(kolibri_formula_t));
-    if (result == KOLIBRI_OK) {
+    int created = 0;
+    int result = store_formula(core, &new_formula, &created, check_duplicate);
+    if (result == KOLIBRI_OK && created) {
         core->metrics.formula_count++;
     }
     
     return result;
 }
 
+int kolibri_formula_create(kolibri_core_t* core, const kolibri_formula_t* formula) {
+    if (!core || !formula) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    return create_formula(core, formula, 1);
+}
+
+static void unlink_shared_code(kolibri_core_t* core, shared_code_t* code) {
+    if (code->newer) code->newer->older = code->older;
+    else core->code_newest = code->older;
+    if (code->older) code->older->newer = code->newer;
+    else core->code_oldest = code->newer;
+}
+
+static void push_shared_code(kolibri_core_t* core, shared_code_t* code) {
+    code->newer = NULL;
+    code->older = core->code_newest;
+    if (core->code_newest) core->code_newest->newer = code;
+    else core->code_oldest = code;
+    core->code_newest = code;
+}
+
+static void drop_shared_code(kolibri_core_t* core, shared_code_t* code) {
+    shared_code_t** slot = &core->code_buckets[kv_hash(code->id) & (core->code_bucket_count - 1)];
+    while (*slot != code) slot = &(*slot)->next;
+    *slot = code->next;
+    unlink_shared_code(core, code);
+    core->code_count--;
+    core->code_bytes -= code->size;
+    free(code);
+}
+
+/* Keep a private copy of code read from the shared segment, so every
+ * caller gets code that later reads do not overwrite. The copy is reused
+ * while the segment holds the same code and replaced when it changes;
+ * the least recently read copies are freed to stay within
+ * KOLIBRI_SHARED_CODE_CACHE bytes. */
+static const uint8_t* keep_shared_code(kolibri_core_t* core, const uint8_t* id,
+                                       const uint8_t* data, uint32_t size) {
+    if (core->code_count >= core->code_bucket_count) {
+        uint32_t count = core->code_bucket_count ? core->code_bucket_count * 2 : KV_INITIAL_BUCKETS;
+        shared_code_t** buckets = (shared_code_t**)calloc(count, sizeof(shared_code_t*));
+        if (!buckets) return NULL;
+        for (uint32_t b = 0; b < core->code_bucket_count; b++) {
+            shared_code_t* code = core->code_buckets[b];
+            while (code) {
+                shared_code_t* next = code->next;
+                uint32_t nb = kv_hash(code->id) & (count - 1);
+                code->next = buckets[nb];
+                buckets[nb] = code;
+                code = next;
+            }
+        }
+        free(core->code_buckets);
+        core->code_buckets = buckets;
+        core->code_bucket_count = count;
+    }
+    
+    uint32_t bucket = kv_hash(id) & (core->code_bucket_count - 1);
+    shared_code_t* code = core->code_buckets[bucket];
+    while (code && !id_equals(code->id, id)) code = code->next;
+    if (code && code->size == size && memcmp(code->data, data, size) == 0) {
+        unlink_shared_code(core, code);
+        push_shared_code(core, code);
+        return code->data;
+    }
+    if (code) drop_shared_code(core, code);
+    while (core->code_oldest && core->code_bytes + size > KOLIBRI_SHARED_CODE_CACHE) {
+        drop_shared_code(core, core->code_oldest);
+    }
+    
+    code = (shared_code_t*)malloc(sizeof(shared_code_t) + size);
+    if (!code) return NULL;
+    memcpy(code->id, id, KOLIBRI_ID_SIZE);
+    code->size = size;
+    memcpy(code->data, data, size);
+    code->next = core->code_buckets[bucket];
+    core->code_buckets[bucket] = code;
+    push_shared_code(core, code);
+    core->code_count++;
+    core->code_bytes += size;
+    return code->data;
+}
+
 /* Get formula */
 int kolibri_formula_get(kolibri_core_t* core, const uint8_t* id, kolibri_formula_t* formula) {
     if (!core || !id || !formula) return KOLIBRI_ERROR_INVALID_PARAM;
     
     size_t size = sizeof(kolibri_formula_t);
-    return kv_get(core, id, formula, &size);
+    int result = kv_get(core, id, formula, &size);
+    if (result == KOLIBRI_ERROR_NOT_FOUND && core->shared) {
+        result = kolibri_shared_get(core->shared, id, formula, core->shared_code, sizeof(core->shared_code));
+        if (result == KOLIBRI_OK && formula->code_size > 0) {
+            formula->code = (uint8_t*)keep_shared_code(core, id, formula->code, formula->code_size);
+            if (!formula->code) result = KOLIBRI_ERROR_STORAGE;
+        }
+    }
+    return result;
 }
 
 /* Update formula */
@@ -181,15 +462,21 @@ int kolibri_formula_update(kolibri_core_t* core, const kolibri_formula_t* formul
     kolibri_formula_t updated = *formula;
     updated.timestamp = (uint64_t)time(NULL);
     
-    return kv_put(core, updated.id, &updated, sizeof(kolibri_formula_t));
+    return store_formula(core, &updated, NULL, 0);
 }
 
 /* Delete formula */
 int kolibri_formula_delete(kolibri_core_t* core, const uint8_t* id) {
     if (!core || !id) return KOLIBRI_ERROR_INVALID_PARAM;
     
+    kv_entry_t* entry = kv_find(core, id);
+    uint32_t version = entry ? ((const kolibri_formula_t*)entry->value)->version : 0;
+    
     int result = kv_delete(core, id);
     if (result == KOLIBRI_OK) {
+        if (kolibri_shared_writable(core->shared)) kolibri_shared_delete(core->shared, id);
+        kolibri_iblt_update(&core->sync_table, id, version, -1);
+        kolibri_similarity_remove(core->similarity, id);
         if (core->metrics.formula_count > 0) {
             core->metrics.formula_count--;
         }
@@ -198,39 +485,98 @@ int kolibri_formula_delete(kolibri_core_t* core, const uint8_t* id) {
     return result;
 }
 
-/* List formulas */
+/* List formulas, followed by those only the shared segment holds */
 int kolibri_formula_list(kolibri_core_t* core, kolibri_formula_t** formulas, uint32_t* count) {
-    if (!core || !count) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (!core || !formulas || !count) return KOLIBRI_ERROR_INVALID_PARAM;
     
-    /* Count entries */
-    uint32_t entry_count = 0;
-    kv_entry_t* entry = core->storage_head;
-    while (entry) {
-        entry_count++;
-        entry = entry->next;
-    }
+    *count = 0;
+    *formulas = NULL;
     
-    if (entry_count == 0) {
-        *count = 0;
-        *formulas = NULL;
-        return KOLIBRI_OK;
+    uint32_t shared_count = core->shared ? kolibri_shared_count(core->shared) : 0;
+    uint8_t (*ids)[KOLIBRI_ID_SIZE] = NULL;
+    if (shared_count > 0) {
+        ids = (uint8_t (*)[KOLIBRI_ID_SIZE])malloc((size_t)shared_count * KOLIBRI_ID_SIZE);
+        if (!ids) return KOLIBRI_ERROR_STORAGE;
+        int result = kolibri_shared_ids(core->shared, ids, shared_count, &shared_count);
+        if (result != KOLIBRI_OK) {
+            free(ids);
+            return result;
+        }
     }
     
+    uint32_t capacity = core->entry_count + shared_count;
+    if (capacity == 0) return KOLIBRI_OK;
+    
     /* Allocate array */
-    kolibri_formula_t* result = (kolibri_formula_t*)malloc(sizeof(kolibri_formula_t) * entry_count);
-    if (!result) return KOLIBRI_ERROR_STORAGE;
+    kolibri_formula_t* result = (kolibri_formula_t*)malloc(sizeof(kolibri_formula_t) * capacity);
+    if (!result) {
+        free(ids);
+        return KOLIBRI_ERROR_STORAGE;
+    }
     
     /* Copy formulas */
-    entry = core->storage_head;
-    uint32_t i = 0;
-    while (entry && i < entry_count) {
-        memcpy(&result[i], entry->value, sizeof(kolibri_formula_t));
-        i++;
-        entry = entry->next;
+    uint32_t n = 0;
+    for (kv_entry_t* entry = core->storage_head; entry; entry = entry->next) {
+        memcpy(&result[n++], entry->value, sizeof(kolibri_formula_t));
     }
     
-    *formulas = result;
-    *count = entry_count;
+    /* Code of formulas only the segment holds goes behind the formulas in
+     * the same block, bypassing the read cache, which could evict it before
+     * the caller is done. A formula deleted from the segment since the ID
+     * snapshot is skipped. */
+    uint32_t local_count = n;
+    size_t* offsets = shared_count > 0 ? (size_t*)malloc(shared_count * sizeof(size_t)) : NULL;
+    uint8_t* code = NULL;
+    size_t code_len = 0, code_capacity = 0;
+    int status = shared_count > 0 && !offsets ? KOLIBRI_ERROR_STORAGE : KOLIBRI_OK;
+    for (uint32_t i = 0; i < shared_count && status == KOLIBRI_OK; i++) {
+        if (kv_find(core, ids[i])) continue;
+        status = kolibri_shared_get(core->shared, ids[i], &result[n], core->shared_code, sizeof(core->shared_code));
+        if (status == KOLIBRI_ERROR_NOT_FOUND) {
+            status = KOLIBRI_OK;
+            continue;
+        }
+        if (status != KOLIBRI_OK) break;
+        
+        uint32_t size = result[n].code_size;
+        if (code_len + size > code_capacity) {
+            size_t capacity = code_capacity ? code_capacity * 2 : 4 * KOLIBRI_MAX_FORMULA_SIZE;
+            if (capacity < code_len + size) capacity = code_len + size;
+            uint8_t* grown = (uint8_t*)realloc(code, capacity);
+            if (!grown) {
+                status = KOLIBRI_ERROR_STORAGE;
+                break;
+            }
+            code = grown;
+            code_capacity = capacity;
+        }
+        if (size > 0) memcpy(code + code_len, core->shared_code, size);
+        offsets[n - local_count] = code_len;
+        code_len += size;
+        n++;
+    }
+    free(ids);
+    
+    kolibri_formula_t* block = NULL;
+    if (status == KOLIBRI_OK && n > 0) {
+        block = (kolibri_formula_t*)realloc(result, sizeof(kolibri_formula_t) * n + code_len);
+        if (!block) status = KOLIBRI_ERROR_STORAGE;
+    }
+    if (block) {
+        uint8_t* block_code = (uint8_t*)(block + n);
+        if (code_len > 0) memcpy(block_code, code, code_len);
+        for (uint32_t i = local_count; i < n; i++) {
+            block[i].code = block[i].code_size > 0 ? block_code + offsets[i - local_count] : NULL;
+        }
+    } else {
+        free(result);
+    }
+    free(offsets);
+    free(code);
+    if (status != KOLIBRI_OK || n == 0) return status;
+    
+    *formulas = block;
+    *count = n;
     
     return KOLIBRI_OK;
 }
@@ -333,22 +679,103 @@ int kolibri_storage_export(kolibri_core_t* core, const char* path) {
     FILE* f = fopen(path, "wb");
     if (!f) return KOLIBRI_ERROR_STORAGE;
     
+    uint32_t count = core->entry_count;
+    
     /* Write header */
-    uint32_t magic = 0x4B464F52; /* "KFOR" */
-    fwrite(&magic, sizeof(magic), 1, f);
-    fwrite(&core->metrics.formula_count, sizeof(uint32_t), 1, f);
+    uint32_t magic = KOLIBRI_EXPORT_MAGIC;
+    int ok = fwrite(&magic, sizeof(magic), 1, f) == 1 &&
+             fwrite(&count, sizeof(count), 1, f) == 1;
     
-    /* Write formulas */
+    /* Write formulas, each followed by code_size bytes of code */
     kv_entry_t* entry = core->storage_head;
-    while (entry) {
-        fwrite(entry->value, entry->value_size, 1, f);
+    while (entry && ok) {
+        ok = fwrite(entry->value, entry->value_size, 1, f) == 1;
         entry = entry->next;
     }
     
-    fclose(f);
+    if (fclose(f) != 0) ok = 0;
+    return ok ? KOLIBRI_OK : KOLIBRI_ERROR_STORAGE;
+}
+
+/* Read one exported formula; code is pointed at code_buf */
+static int read_formula(FILE* f, int with_code, kolibri_formula_t* formula, uint8_t* code_buf) {
+    if (fread(formula, sizeof(kolibri_formula_t), 1, f) != 1) return KOLIBRI_ERROR_STORAGE;
+    
+    if (!with_code) {
+        /* Legacy exports only carried the code pointer, not the bytes */
+        formula->code = NULL;
+        formula->code_size = 0;
+        return KOLIBRI_OK;
+    }
+    
+    if (formula->code_size > KOLIBRI_MAX_FORMULA_SIZE) return KOLIBRI_ERROR_STORAGE;
+    if (formula->code_size > 0 && fread(code_buf, formula->code_size, 1, f) != 1) {
+        return KOLIBRI_ERROR_STORAGE;
+    }
+    formula->code = formula->code_size > 0 ? code_buf : NULL;
+    return KOLIBRI_OK;
+}
+
+/* Parse one exported formula at data + *offset; code points into data */
+static int parse_formula(const uint8_t* data, size_t len, size_t* offset, int with_code,
+                         kolibri_formula_t* formula) {
+    if (len - *offset < sizeof(kolibri_formula_t)) return KOLIBRI_ERROR_STORAGE;
+    memcpy(formula, data + *offset, sizeof(kolibri_formula_t));
+    *offset += sizeof(kolibri_formula_t);
+    
+    if (!with_code) {
+        formula->code = NULL;
+        formula->code_size = 0;
+        return KOLIBRI_OK;
+    }
+    
+    if (formula->code_size > KOLIBRI_MAX_FORMULA_SIZE || len - *offset < formula->code_size) {
+        return KOLIBRI_ERROR_STORAGE;
+    }
+    formula->code = formula->code_size > 0 ? (uint8_t*)(data + *offset) : NULL;
+    *offset += formula->code_size;
     return KOLIBRI_OK;
 }
 
+/* Import with a trusted key: the records are read into memory once, all of
+ * them verified, and then stored from that same memory, so nothing is
+ * stored unless every signature checks out and the file cannot change in
+ * between */
+static int import_verified(kolibri_core_t* core, FILE* f, uint32_t count, int with_code) {
+    long start = ftell(f);
+    if (start < 0 || fseek(f, 0, SEEK_END) != 0) return KOLIBRI_ERROR_STORAGE;
+    long end = ftell(f);
+    if (end < start || fseek(f, start, SEEK_SET) != 0) return KOLIBRI_ERROR_STORAGE;
+    
+    size_t len = (size_t)(end - start);
+    uint8_t* data = (uint8_t*)malloc(len > 0 ? len : 1);
+    kolibri_formula_t* formulas = (kolibri_formula_t*)malloc(sizeof(kolibri_formula_t) * KOLIBRI_IMPORT_CHUNK);
+    int result = data && formulas && fread(data, 1, len, f) == len ? KOLIBRI_OK : KOLIBRI_ERROR_STORAGE;
+    
+    /* Pass 0 verifies, pass 1 stores */
+    for (int pass = 0; pass < 2 && result == KOLIBRI_OK; pass++) {
+        size_t offset = 0;
+        for (uint32_t done = 0; done < count && result == KOLIBRI_OK; ) {
+            uint32_t n = count - done < KOLIBRI_IMPORT_CHUNK ? count - done : KOLIBRI_IMPORT_CHUNK;
+            for (uint32_t i = 0; i < n && result == KOLIBRI_OK; i++) {
+                result = parse_formula(data, len, &offset, with_code, &formulas[i]);
+            }
+            if (result == KOLIBRI_OK && pass == 0 &&
+                kolibri_verify_formula_batch(formulas, n, core->trusted_key, NULL) != KOLIBRI_OK) {
+                result = KOLIBRI_ERROR_SIGNATURE;
+            }
+            for (uint32_t i = 0; i < n && result == KOLIBRI_OK && pass == 1; i++) {
+                result = create_formula(core, &formulas[i], 0);
+            }
+            done += n;
+        }
+    }
+    
+    free(data);
+    free(formulas);
+    return result;
+}
+
 /* Import storage */
 int kolibri_storage_import(kolibri_core_t* core, const char* path) {
     if (!core || !path) return KOLIBRI_ERROR_INVALID_PARAM;
@@ -359,25 +786,198 @@ int kolibri_storage_import(kolibri_core_t* core, const char* path) {
     /* Read header */
     uint32_t magic;
     uint32_t count;
-    fread(&magic, sizeof(magic), 1, f);
-    if (magic != 0x4B464F52) {
+    if (fread(&magic, sizeof(magic), 1, f) == 1 && magic == KOLIBRI_PACK_MAGIC) {
+        fclose(f);
+        return kolibri_storage_import_pack(core, path, 0, NULL);
+    }
+    if ((magic != KOLIBRI_EXPORT_MAGIC && magic != KOLIBRI_EXPORT_MAGIC_LEGACY) ||
+        fread(&count, sizeof(count), 1, f) != 1) {
         fclose(f);
         return KOLIBRI_ERROR_STORAGE;
     }
-    fread(&count, sizeof(uint32_t), 1, f);
+    int with_code = magic == KOLIBRI_EXPORT_MAGIC;
+    
+    if (core->has_trusted_key) {
+        int result = import_verified(core, f, count, with_code);
+        fclose(f);
+        return result;
+    }
+    
+    kolibri_formula_t* formula = (kolibri_formula_t*)malloc(sizeof(kolibri_formula_t));
+    uint8_t* code = (uint8_t*)malloc(KOLIBRI_MAX_FORMULA_SIZE);
+    int result = formula && code ? KOLIBRI_OK : KOLIBRI_ERROR_STORAGE;
     
     /* Read formulas */
-    for (uint32_t i = 0; i < count; i++) {
-        kolibri_formula_t formula;
-        if (fread(&formula, sizeof(kolibri_formula_t), 1, f) != 1) {
-            fclose(f);
-            return KOLIBRI_ERROR_STORAGE;
+    for (uint32_t i = 0; i < count && result == KOLIBRI_OK; i++) {
+        result = read_formula(f, with_code, formula, code);
+        if (result == KOLIBRI_OK) {
+            result = create_formula(core, formula, 0);
         }
-        kolibri_formula_create(core, &formula);
     }
     
+    free(formula);
+    free(code);
     fclose(f);
-    return KOLIBRI_OK;
+    return result;
+}
+
+/* Export storage as a compressed pack */
+int kolibri_storage_export_pack(kolibri_core_t* core, const char* path, kolibri_pack_stats_t* stats) {
+    if (!core || !path) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    size_t capacity = 4 + sizeof(kolibri_formula_t) + KOLIBRI_MAX_FORMULA_SIZE;
+    uint8_t* record = (uint8_t*)malloc(capacity);
+    kolibri_pack_writer_t* w = record ? kolibri_pack_create(path, KOLIBRI_PACK_KIND_FORMULAS) : NULL;
+    if (!w) {
+        free(record);
+        return KOLIBRI_ERROR_STORAGE;
+    }
+    
+    /* Each record is its length u32 followed by the ring formula record */
+    int result = KOLIBRI_OK;
+    for (kv_entry_t* entry = core->storage_head; entry && result == KOLIBRI_OK; entry = entry->next) {
+        kolibri_formula_t formula;
+        memcpy(&formula, entry->value, sizeof(formula));
+        formula.code = formula.code_size > 0 ? (uint8_t*)entry->value + sizeof(formula) : NULL;
+        
+        size_t size = kolibri_ring_encode_formula(&formula, NULL, 0);
+        if (4 + size > capacity) {
+            uint8_t* grown = (uint8_t*)realloc(record, 4 + size);
+            if (!grown) {
+                result = KOLIBRI_ERROR_STORAGE;
+                break;
+            }
+            record = grown;
+            capacity = 4 + size;
+        }
+        for (int i = 0; i < 4; i++) record[i] = (uint8_t)(size >> (8 * i));
+        kolibri_ring_encode_formula(&formula, record + 4, size);
+        if (kolibri_pack_append(w, record, 4 + size) != KOLIBRI_PACK_OK) result = KOLIBRI_ERROR_STORAGE;
+    }
+    
+    if (kolibri_pack_finish(w, stats) != KOLIBRI_PACK_OK) result = KOLIBRI_ERROR_STORAGE;
+    free(record);
+    return result;
+}
+
+/* A verified frame held until the whole pack has verified */
+typedef struct staged_frame_t {
+    struct staged_frame_t* next;
+    size_t len;
+    uint32_t record_count;
+    uint8_t data[];
+} staged_frame_t;
+
+/* Pack import state; frames arrive in order on the calling thread */
+typedef struct {
+    kolibri_core_t* core;
+    kolibri_formula_t* formulas;
+    uint32_t capacity;
+    staged_frame_t* staged;
+    staged_frame_t** staged_tail;
+    int result;
+} pack_import_t;
+
+/* Parse a frame's records into im->formulas; code stays in the frame */
+static int parse_pack_frame(pack_import_t* im, const uint8_t* data, size_t len, uint32_t record_count) {
+    if (record_count > im->capacity) {
+        kolibri_formula_t* formulas =
+            (kolibri_formula_t*)realloc(im->formulas, record_count * sizeof(kolibri_formula_t));
+        if (!formulas) {
+            im->result = KOLIBRI_ERROR_STORAGE;
+            return im->result;
+        }
+        im->formulas = formulas;
+        im->capacity = record_count;
+    }
+    
+    /* Records are a length u32 followed by a ring formula record */
+    size_t offset = 0;
+    for (uint32_t i = 0; i < record_count && im->result == KOLIBRI_OK; i++) {
+        size_t size = 0;
+        if (len - offset >= 4) {
+            for (int b = 0; b < 4; b++) size |= (size_t)data[offset + b] << (8 * b);
+            offset += 4;
+        }
+        if (size == 0 || len - offset < size ||
+            kolibri_ring_decode_formula(data + offset, size, &im->formulas[i]) != KOLIBRI_OK) {
+            im->result = KOLIBRI_ERROR_STORAGE;
+        }
+        offset += size;
+    }
+    if (im->result == KOLIBRI_OK && offset != len) im->result = KOLIBRI_ERROR_STORAGE;
+    return im->result;
+}
+
+static int store_pack_records(pack_import_t* im, uint32_t record_count) {
+    for (uint32_t i = 0; i < record_count && im->result == KOLIBRI_OK; i++) {
+        im->result = create_formula(im->core, &im->formulas[i], 0);
+    }
+    return im->result;
+}
+
+static int import_pack_frame(void* ctx, const uint8_t* data, size_t len, uint32_t record_count) {
+    pack_import_t* im = (pack_import_t*)ctx;
+    if (parse_pack_frame(im, data, len, record_count) != KOLIBRI_OK) return 1;
+    if (!im->core->has_trusted_key) return store_pack_records(im, record_count) != KOLIBRI_OK;
+    
+    /* With a trusted key, keep the verified bytes; they are stored once the
+     * whole pack has verified */
+    if (kolibri_verify_formula_batch(im->formulas, record_count, im->core->trusted_key, NULL) != KOLIBRI_OK) {
+        im->result = KOLIBRI_ERROR_SIGNATURE;
+        return 1;
+    }
+    staged_frame_t* frame = (staged_frame_t*)malloc(sizeof(staged_frame_t) + len);
+    if (!frame) {
+        im->result = KOLIBRI_ERROR_STORAGE;
+        return 1;
+    }
+    frame->next = NULL;
+    frame->len = len;
+    frame->record_count = record_count;
+    memcpy(frame->data, data, len);
+    *im->staged_tail = frame;
+    im->staged_tail = &frame->next;
+    return 0;
+}
+
+/* Import a compressed pack */
+int kolibri_storage_import_pack(kolibri_core_t* core, const char* path, uint32_t threads,
+                                kolibri_pack_stats_t* stats) {
+    if (!core || !path) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    kolibri_pack_reader_t* r = kolibri_pack_open(path);
+    if (!r) return KOLIBRI_ERROR_STORAGE;
+    if (kolibri_pack_kind(r) != KOLIBRI_PACK_KIND_FORMULAS) {
+        kolibri_pack_close(r);
+        return KOLIBRI_ERROR_STORAGE;
+    }
+    if (stats) kolibri_pack_stats(r, stats);
+    
+    pack_import_t im;
+    memset(&im, 0, sizeof(im));
+    im.core = core;
+    im.staged_tail = &im.staged;
+    
+    int result = kolibri_pack_stream(r, 0, threads, import_pack_frame, &im);
+    if (im.result != KOLIBRI_OK) result = im.result;
+    else if (result != KOLIBRI_PACK_OK) result = KOLIBRI_ERROR_STORAGE;
+    
+    /* Store the staged frames of a pack that verified completely */
+    while (im.staged) {
+        staged_frame_t* frame = im.staged;
+        if (result == KOLIBRI_OK &&
+            parse_pack_frame(&im, frame->data, frame->len, frame->record_count) == KOLIBRI_OK) {
+            result = store_pack_records(&im, frame->record_count);
+        }
+        if (im.result != KOLIBRI_OK) result = im.result;
+        im.staged = frame->next;
+        free(frame);
+    }
+    
+    free(im.formulas);
+    kolibri_pack_close(r);
+    return result;
 }
 
 /* Get metrics */
@@ -406,14 +1006,74 @@ int kolibri_get_metrics(kolibri_core_t* core, kolibri_metrics_t* metrics) {
     return KOLIBRI_OK;
 }
 
-/* Signature operations (simplified - would use ed25519 in production) */
+/* Digest of everything a signature covers: identity, interface, code,
+ * cost, provenance and tags. Fitness and timestamp change locally and are
+ * deliberately excluded, as is the signature itself. */
+static void formula_digest(const kolibri_formula_t* formula, uint8_t* digest) {
+    kolibri_sha256_ctx_t ctx;
+    uint8_t le[4];
+    
+    kolibri_sha256_init(&ctx);
+    kolibri_sha256_update(&ctx, formula->id, KOLIBRI_ID_SIZE);
+    for (int i = 0; i < 4; i++) le[i] = (uint8_t)(formula->version >> (8 * i));
+    kolibri_sha256_update(&ctx, le, 4);
+    
+    uint8_t input_count = formula->input_count < KOLIBRI_MAX_INPUTS ? formula->input_count : KOLIBRI_MAX_INPUTS;
+    kolibri_sha256_update(&ctx, &input_count, 1);
+    for (uint8_t i = 0; i < input_count; i++) {
+        uint8_t len = (uint8_t)strnlen(formula->inputs[i], sizeof(formula->inputs[i]));
+        kolibri_sha256_update(&ctx, &len, 1);
+        kolibri_sha256_update(&ctx, formula->inputs[i], len);
+    }
+    
+    uint8_t output_count = formula->output_count < KOLIBRI_MAX_OUTPUTS ? formula->output_count : KOLIBRI_MAX_OUTPUTS;
+    kolibri_sha256_update(&ctx, &output_count, 1);
+    for (uint8_t i = 0; i < output_count; i++) {
+        uint8_t len = (uint8_t)strnlen(formula->outputs[i], sizeof(formula->outputs[i]));
+        kolibri_sha256_update(&ctx, &len, 1);
+        kolibri_sha256_update(&ctx, formula->outputs[i], len);
+    }
+    
+    uint32_t code_size = formula->code ? formula->code_size : 0;
+    for (int i = 0; i < 4; i++) le[i] = (uint8_t)(code_size >> (8 * i));
+    kolibri_sha256_update(&ctx, le, 4);
+    if (code_size > 0) kolibri_sha256_update(&ctx, formula->code, code_size);
+    
+    for (int i = 0; i < 4; i++) le[i] = (uint8_t)(formula->cost >> (8 * i));
+    kolibri_sha256_update(&ctx, le, 4);
+    
+    uint8_t provenance_count = formula->provenance_count < KOLIBRI_MAX_PROVENANCES ?
+                               formula->provenance_count : KOLIBRI_MAX_PROVENANCES;
+    kolibri_sha256_update(&ctx, &provenance_count, 1);
+    kolibri_sha256_update(&ctx, formula->provenances, (size_t)provenance_count * KOLIBRI_ID_SIZE);
+    
+    uint8_t tag_count = formula->tag_count < KOLIBRI_MAX_TAGS ? formula->tag_count : KOLIBRI_MAX_TAGS;
+    kolibri_sha256_update(&ctx, &tag_count, 1);
+    for (uint8_t i = 0; i < tag_count; i++) {
+        uint8_t len = (uint8_t)strnlen(formula->tags[i], sizeof(formula->tags[i]));
+        kolibri_sha256_update(&ctx, &len, 1);
+        kolibri_sha256_update(&ctx, formula->tags[i], len);
+    }
+    
+    kolibri_sha256_final(&ctx, digest);
+}
+
+/* Signature operations (Ed25519 over the formula digest) */
+int kolibri_derive_public_key(const uint8_t* private_key, uint8_t* public_key) {
+    if (!private_key || !public_key) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    kolibri_ed25519_public_key(private_key, public_key);
+    return KOLIBRI_OK;
+}
+
 int kolibri_sign_formula(kolibri_formula_t* formula, const uint8_t* private_key) {
     if (!formula || !private_key) return KOLIBRI_ERROR_INVALID_PARAM;
     
-    /* Simplified signature: hash of formula data */
-    for (int i = 0; i < KOLIBRI_SIGNATURE_SIZE; i++) {
-        formula->signature[i] = (uint8_t)((formula->id[i % KOLIBRI_ID_SIZE] ^ private_key[i % 32]) & 0xFF);
-    }
+    uint8_t public_key[KOLIBRI_ED25519_PUBLIC_KEY_SIZE];
+    uint8_t digest[KOLIBRI_SHA256_SIZE];
+    kolibri_ed25519_public_key(private_key, public_key);
+    formula_digest(formula, digest);
+    kolibri_ed25519_sign(private_key, public_key, digest, sizeof(digest), formula->signature);
     
     return KOLIBRI_OK;
 }
@@ -421,13 +1081,179 @@ int kolibri_sign_formula(kolibri_formula_t* formula, const uint8_t* private_key)
 int kolibri_verify_formula(const kolibri_formula_t* formula, const uint8_t* public_key) {
     if (!formula || !public_key) return KOLIBRI_ERROR_INVALID_PARAM;
     
-    /* Simplified verification */
-    for (int i = 0; i < KOLIBRI_SIGNATURE_SIZE; i++) {
-        uint8_t expected = (uint8_t)((formula->id[i % KOLIBRI_ID_SIZE] ^ public_key[i % 32]) & 0xFF);
-        if (formula->signature[i] != expected) {
-            return KOLIBRI_ERROR_SIGNATURE;
+    uint8_t digest[KOLIBRI_SHA256_SIZE];
+    formula_digest(formula, digest);
+    if (kolibri_ed25519_verify(public_key, digest, sizeof(digest), formula->signature) != 0) {
+        return KOLIBRI_ERROR_SIGNATURE;
+    }
+    
+    return KOLIBRI_OK;
+}
+
+/* One thread's share of a batch verification */
+typedef struct {
+    const kolibri_formula_t* formulas;
+    uint32_t count;
+    const uint8_t* public_key;
+    int* valid;
+    int result;
+} verify_job_t;
+
+static void* verify_worker(void* arg) {
+    verify_job_t* job = (verify_job_t*)arg;
+    uint8_t digests[KOLIBRI_VERIFY_CHUNK][KOLIBRI_SHA256_SIZE];
+    const uint8_t* messages[KOLIBRI_VERIFY_CHUNK];
+    const uint8_t* keys[KOLIBRI_VERIFY_CHUNK];
+    const uint8_t* signatures[KOLIBRI_VERIFY_CHUNK];
+    size_t lens[KOLIBRI_VERIFY_CHUNK];
+    
+    job->result = KOLIBRI_OK;
+    for (uint32_t start = 0; start < job->count; start += KOLIBRI_VERIFY_CHUNK) {
+        uint32_t n = job->count - start < KOLIBRI_VERIFY_CHUNK ? job->count - start : KOLIBRI_VERIFY_CHUNK;
+        for (uint32_t i = 0; i < n; i++) {
+            formula_digest(&job->formulas[start + i], digests[i]);
+            messages[i] = digests[i];
+            lens[i] = KOLIBRI_SHA256_SIZE;
+            keys[i] = job->public_key;
+            signatures[i] = job->formulas[start + i].signature;
+        }
+        if (kolibri_ed25519_verify_batch(messages, lens, keys, signatures, n,
+                                         job->valid ? job->valid + start : NULL) != 0) {
+            job->result = KOLIBRI_ERROR_SIGNATURE;
+            if (!job->valid) break;
+        }
+    }
+    return NULL;
+}
+
+int kolibri_verify_formula_batch(const kolibri_formula_t* formulas, uint32_t count,
+                                 const uint8_t* public_key, int* valid) {
+    if ((!formulas && count > 0) || !public_key) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (count == 0) return KOLIBRI_OK;
+    
+    /* Give each thread at least one full chunk */
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threads = cpus > 0 ? (uint32_t)cpus : 1;
+    if (threads > KOLIBRI_VERIFY_MAX_THREADS) threads = KOLIBRI_VERIFY_MAX_THREADS;
+    uint32_t max_useful = (count + KOLIBRI_VERIFY_CHUNK - 1) / KOLIBRI_VERIFY_CHUNK;
+    if (threads > max_useful) threads = max_useful;
+    
+    verify_job_t jobs[KOLIBRI_VERIFY_MAX_THREADS];
+    pthread_t tids[KOLIBRI_VERIFY_MAX_THREADS];
+    int started[KOLIBRI_VERIFY_MAX_THREADS];
+    uint32_t per_thread = (count + threads - 1) / threads;
+    
+    for (uint32_t t = 0; t < threads; t++) {
+        uint32_t start = t * per_thread;
+        uint32_t end = start + per_thread < count ? start + per_thread : count;
+        jobs[t].formulas = formulas + start;
+        jobs[t].count = end > start ? end - start : 0;
+        jobs[t].public_key = public_key;
+        jobs[t].valid = valid ? valid + start : NULL;
+        
+        /* The last share runs on the calling thread, as does any share
+         * whose thread cannot be started (e.g. WASM without threads) */
+        started[t] = t + 1 < threads && pthread_create(&tids[t], NULL, verify_worker, &jobs[t]) == 0;
+        if (!started[t]) verify_worker(&jobs[t]);
+    }
+    
+    int result = KOLIBRI_OK;
+    for (uint32_t t = 0; t < threads; t++) {
+        if (started[t]) pthread_join(tids[t], NULL);
+        if (jobs[t].result != KOLIBRI_OK) result = jobs[t].result;
+    }
+    
+    return result;
+}
+
+/* Trust anchor for imports */
+int kolibri_set_trusted_key(kolibri_core_t* core, const uint8_t* public_key) {
+    if (!core) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    if (public_key) {
+        memcpy(core->trusted_key, public_key, KOLIBRI_ED25519_PUBLIC_KEY_SIZE);
+        core->has_trusted_key = 1;
+    } else {
+        memset(core->trusted_key, 0, sizeof(core->trusted_key));
+        core->has_trusted_key = 0;
+    }
+    
+    return KOLIBRI_OK;
+}
+
+/* Sync support: the maintained table, the trusted key, stores exempt from
+ * duplicate rejection and a snapshot of the stored keys */
+const kolibri_iblt_t* kolibri_sync_table(kolibri_core_t* core) {
+    return core ? &core->sync_table : NULL;
+}
+
+const uint8_t* kolibri_sync_trusted_key(kolibri_core_t* core) {
+    return core && core->has_trusted_key ? core->trusted_key : NULL;
+}
+
+int kolibri_sync_store(kolibri_core_t* core, const kolibri_formula_t* formula) {
+    if (!core || !formula) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    return create_formula(core, formula, 0);
+}
+
+int kolibri_sync_keys(kolibri_core_t* core, uint8_t (**keys)[KOLIBRI_SYNC_KEY_SIZE], uint32_t* count) {
+    if (!core || !keys || !count) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    *count = 0;
+    *keys = NULL;
+    if (core->entry_count == 0) return KOLIBRI_OK;
+    
+    uint8_t (*out)[KOLIBRI_SYNC_KEY_SIZE] =
+        (uint8_t (*)[KOLIBRI_SYNC_KEY_SIZE])malloc((size_t)core->entry_count * KOLIBRI_SYNC_KEY_SIZE);
+    if (!out) return KOLIBRI_ERROR_STORAGE;
+    
+    uint32_t n = 0;
+    for (kv_entry_t* entry = core->storage_head; entry; entry = entry->next) {
+        uint32_t version = ((const kolibri_formula_t*)entry->value)->version;
+        memcpy(out[n], entry->key, KOLIBRI_ID_SIZE);
+        for (int i = 0; i < 4; i++) out[n][KOLIBRI_ID_SIZE + i] = (uint8_t)(version >> (8 * i));
+        n++;
+    }
+    
+    *keys = out;
+    *count = n;
+    return KOLIBRI_OK;
+}
+
+/* Similarity search over the stored formulas */
+int kolibri_formula_find_similar(kolibri_core_t* core, const kolibri_formula_t* formula,
+                                 float threshold, kolibri_similar_t* results,
+                                 uint32_t max_results, uint32_t* count) {
+    if (!core || !formula || !count) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (formula->code_size > KOLIBRI_MAX_FORMULA_SIZE) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (formula->code_size > 0 && !formula->code) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    kolibri_sketch_t sketch;
+    kolibri_formula_sketch(formula, &sketch);
+    return kolibri_similarity_query(core->similarity, &sketch, formula->id, threshold,
+                                    results, max_results, count);
+}
+
+int kolibri_set_duplicate_threshold(kolibri_core_t* core, float threshold) {
+    if (!core || !(threshold >= 0.0f)) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    core->duplicate_threshold = threshold;
+    return KOLIBRI_OK;
+}
+
+/* Shared segment: publish the stored formulas if we are its writer */
+int kolibri_attach_shared(kolibri_core_t* core, kolibri_shared_t* shared) {
+    if (!core) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    if (kolibri_shared_writable(shared)) {
+        for (kv_entry_t* entry = core->storage_head; entry; entry = entry->next) {
+            int result = kolibri_shared_put(shared, (const kolibri_formula_t*)entry->value);
+            if (result != KOLIBRI_OK) return result;
         }
     }
     
+    if (shared != core->shared) free_shared_code(core);
+    core->shared = shared;
     return KOLIBRI_OK;
 }
@@ -0,0 +1,950 @@
+/**
+ * KOLIBRI.AI Ed25519 Implementation
+ *
+ * Field elements use five 51-bit limbs, points use extended twisted Edwards
+ * coordinates. Signing runs a constant-time fixed-window base multiplication;
+ * verification (public data only) uses a variable-time Straus multi-scalar
+ * multiplication shared by the single and batch paths.
+ */
+
+#include "kolibri_ed25519.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ---- SHA-512 ---- */
+
+typedef struct {
+    uint64_t state[8];
+    uint64_t length;
+    uint8_t buffer[128];
+    size_t buffered;
+} sha512_ctx_t;
+
+static const uint64_t K512[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+#define ROR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static uint64_t load_be64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+static void store_be64(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+static void sha512_block(uint64_t state[8], const uint8_t* data) {
+    uint64_t w[80];
+    for (int t = 0; t < 16; t++) w[t] = load_be64(data + 8 * t);
+    for (int t = 16; t < 80; t++) {
+        uint64_t s0 = ROR64(w[t - 15], 1) ^ ROR64(w[t - 15], 8) ^ (w[t - 15] >> 7);
+        uint64_t s1 = ROR64(w[t - 2], 19) ^ ROR64(w[t - 2], 61) ^ (w[t - 2] >> 6);
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+
+    uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int t = 0; t < 80; t++) {
+        uint64_t t1 = h + (ROR64(e, 14) ^ ROR64(e, 18) ^ ROR64(e, 41)) + ((e & f) ^ (~e & g)) +
+                      K512[t] + w[t];
+        uint64_t t2 = (ROR64(a, 28) ^ ROR64(a, 34) ^ ROR64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+static void sha512_init(sha512_ctx_t* ctx) {
+    static const uint64_t iv[8] = {
+        0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+        0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+    };
+    memcpy(ctx->state, iv, sizeof(iv));
+    ctx->length = 0;
+    ctx->buffered = 0;
+}
+
+static void sha512_update(sha512_ctx_t* ctx, const void* data, size_t len) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    ctx->length += len;
+    while (len > 0) {
+        size_t take = 128 - ctx->buffered;
+        if (take > len) take = len;
+        if (ctx->buffered == 0 && len >= 128) {
+            sha512_block(ctx->state, bytes);
+            take = 128;
+        } else {
+            memcpy(ctx->buffer + ctx->buffered, bytes, take);
+            ctx->buffered += take;
+            if (ctx->buffered == 128) {
+                sha512_block(ctx->state, ctx->buffer);
+                ctx->buffered = 0;
+            }
+        }
+        bytes += take;
+        len -= take;
+    }
+}
+
+static void sha512_final(sha512_ctx_t* ctx, uint8_t* hash) {
+    uint64_t bits = ctx->length * 8;
+    ctx->buffer[ctx->buffered++] = 0x80;
+    if (ctx->buffered > 112) {
+        memset(ctx->buffer + ctx->buffered, 0, 128 - ctx->buffered);
+        sha512_block(ctx->state, ctx->buffer);
+        ctx->buffered = 0;
+    }
+    memset(ctx->buffer + ctx->buffered, 0, 120 - ctx->buffered);
+    store_be64(ctx->buffer + 120, bits);
+    sha512_block(ctx->state, ctx->buffer);
+    for (int i = 0; i < 8; i++) store_be64(hash + 8 * i, ctx->state[i]);
+}
+
+/* ---- Field arithmetic mod 2^255 - 19 ---- */
+
+typedef uint64_t fe[5];
+typedef unsigned __int128 u128;
+
+#define MASK51 0x7FFFFFFFFFFFFULL
+
+static const fe FE_D = {
+    0x34dca135978a3, 0x1a8283b156ebd, 0x5e7a26001c029, 0x739c663a03cbb, 0x52036cee2b6ff
+};
+static const fe FE_D2 = {
+    0x69b9426b2f159, 0x35050762add7a, 0x3cf44c0038052, 0x6738cc7407977, 0x2406d9dc56dff
+};
+static const fe FE_SQRTM1 = {
+    0x61b274a0ea0b0, 0x0d5a5fc8f189d, 0x7ef5e9cbd0c60, 0x78595a6804c9e, 0x2b8324804fc1d
+};
+
+static uint64_t load_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static void store_le64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+static void fe_0(fe h) { memset(h, 0, sizeof(fe)); }
+static void fe_1(fe h) { fe_0(h); h[0] = 1; }
+static void fe_copy(fe h, const fe f) { memcpy(h, f, sizeof(fe)); }
+
+/* Propagate carries so every limb is close to 51 bits */
+static void fe_carry(fe h) {
+    uint64_t c;
+    c = h[0] >> 51; h[0] &= MASK51; h[1] += c;
+    c = h[1] >> 51; h[1] &= MASK51; h[2] += c;
+    c = h[2] >> 51; h[2] &= MASK51; h[3] += c;
+    c = h[3] >> 51; h[3] &= MASK51; h[4] += c;
+    c = h[4] >> 51; h[4] &= MASK51; h[0] += c * 19;
+}
+
+static void fe_add(fe h, const fe f, const fe g) {
+    for (int i = 0; i < 5; i++) h[i] = f[i] + g[i];
+    fe_carry(h);
+}
+
+/* h = f - g, computed as f + 4p - g to stay non-negative */
+static void fe_sub(fe h, const fe f, const fe g) {
+    h[0] = f[0] + 0x1FFFFFFFFFFFB4ULL - g[0];
+    for (int i = 1; i < 5; i++) h[i] = f[i] + 0x1FFFFFFFFFFFFCULL - g[i];
+    fe_carry(h);
+}
+
+static void fe_neg(fe h, const fe f) {
+    fe zero;
+    fe_0(zero);
+    fe_sub(h, zero, f);
+}
+
+static void fe_reduce_wide(fe h, u128 r0, u128 r1, u128 r2, u128 r3, u128 r4) {
+    uint64_t c;
+    c = (uint64_t)(r0 >> 51); h[0] = (uint64_t)r0 & MASK51; r1 += c;
+    c = (uint64_t)(r1 >> 51); h[1] = (uint64_t)r1 & MASK51; r2 += c;
+    c = (uint64_t)(r2 >> 51); h[2] = (uint64_t)r2 & MASK51; r3 += c;
+    c = (uint64_t)(r3 >> 51); h[3] = (uint64_t)r3 & MASK51; r4 += c;
+    c = (uint64_t)(r4 >> 51); h[4] = (uint64_t)r4 & MASK51;
+    h[0] += c * 19;
+    c = h[0] >> 51; h[0] &= MASK51; h[1] += c;
+}
+
+static void fe_mul(fe h, const fe f, const fe g) {
+    uint64_t g1_19 = 19 * g[1], g2_19 = 19 * g[2], g3_19 = 19 * g[3], g4_19 = 19 * g[4];
+    u128 r0 = (u128)f[0] * g[0] + (u128)f[1] * g4_19 + (u128)f[2] * g3_19 + (u128)f[3] * g2_19 + (u128)f[4] * g1_19;
+    u128 r1 = (u128)f[0] * g[1] + (u128)f[1] * g[0] + (u128)f[2] * g4_19 + (u128)f[3] * g3_19 + (u128)f[4] * g2_19;
+    u128 r2 = (u128)f[0] * g[2] + (u128)f[1] * g[1] + (u128)f[2] * g[0] + (u128)f[3] * g4_19 + (u128)f[4] * g3_19;
+    u128 r3 = (u128)f[0] * g[3] + (u128)f[1] * g[2] + (u128)f[2] * g[1] + (u128)f[3] * g[0] + (u128)f[4] * g4_19;
+    u128 r4 = (u128)f[0] * g[4] + (u128)f[1] * g[3] + (u128)f[2] * g[2] + (u128)f[3] * g[1] + (u128)f[4] * g[0];
+    fe_reduce_wide(h, r0, r1, r2, r3, r4);
+}
+
+static void fe_sq(fe h, const fe f) {
+    uint64_t f0_2 = 2 * f[0], f1_2 = 2 * f[1];
+    uint64_t f3_19 = 19 * f[3], f4_19 = 19 * f[4];
+    u128 r0 = (u128)f[0] * f[0] + (u128)f1_2 * f4_19 + (u128)(2 * f[2]) * f3_19;
+    u128 r1 = (u128)f0_2 * f[1] + (u128)(2 * f[2]) * f4_19 + (u128)f[3] * f3_19;
+    u128 r2 = (u128)f0_2 * f[2] + (u128)f[1] * f[1] + (u128)(2 * f[3]) * f4_19;
+    u128 r3 = (u128)f0_2 * f[3] + (u128)f1_2 * f[2] + (u128)f[4] * f4_19;
+    u128 r4 = (u128)f0_2 * f[4] + (u128)f1_2 * f[3] + (u128)f[2] * f[2];
+    fe_reduce_wide(h, r0, r1, r2, r3, r4);
+}
+
+static void fe_sqn(fe h, const fe f, int n) {
+    fe_sq(h, f);
+    while (--n > 0) fe_sq(h, h);
+}
+
+static void fe_frombytes(fe h, const uint8_t* s) {
+    h[0] = load_le64(s) & MASK51;
+    h[1] = (load_le64(s + 6) >> 3) & MASK51;
+    h[2] = (load_le64(s + 12) >> 6) & MASK51;
+    h[3] = (load_le64(s + 19) >> 1) & MASK51;
+    h[4] = (load_le64(s + 24) >> 12) & MASK51;
+}
+
+/* Fully reduce and serialize */
+static void fe_tobytes(uint8_t* s, const fe f) {
+    fe t;
+    fe_copy(t, f);
+    fe_carry(t);
+    fe_carry(t);
+
+    /* t < 2^255 + small: add 19 so values >= p carry out of bit 255 */
+    t[0] += 19;
+    fe_carry(t);
+
+    /* Add 2^255 - 19 and drop bit 255, which subtracts 19 back when t < p */
+    t[0] += 0x8000000000000ULL - 19;
+    for (int i = 1; i < 5; i++) t[i] += 0x8000000000000ULL - 1;
+    uint64_t c;
+    c = t[0] >> 51; t[0] &= MASK51; t[1] += c;
+    c = t[1] >> 51; t[1] &= MASK51; t[2] += c;
+    c = t[2] >> 51; t[2] &= MASK51; t[3] += c;
+    c = t[3] >> 51; t[3] &= MASK51; t[4] += c;
+    t[4] &= MASK51;
+
+    store_le64(s, t[0] | (t[1] << 51));
+    store_le64(s + 8, (t[1] >> 13) | (t[2] << 38));
+    store_le64(s + 16, (t[2] >> 26) | (t[3] << 25));
+    store_le64(s + 24, (t[3] >> 39) | (t[4] << 12));
+}
+
+static int fe_iszero(const fe f) {
+    uint8_t s[32];
+    uint8_t acc = 0;
+    fe_tobytes(s, f);
+    for (int i = 0; i < 32; i++) acc |= s[i];
+    return acc == 0;
+}
+
+static int fe_isnegative(const fe f) {
+    uint8_t s[32];
+    fe_tobytes(s, f);
+    return s[0] & 1;
+}
+
+static int fe_equal(const fe f, const fe g) {
+    fe d;
+    fe_sub(d, f, g);
+    return fe_iszero(d);
+}
+
+/* Constant-time h = b ? g : h */
+static void fe_cmov(fe h, const fe g, uint64_t b) {
+    uint64_t mask = (uint64_t)0 - b;
+    for (int i = 0; i < 5; i++) h[i] ^= mask & (h[i] ^ g[i]);
+}
+
+/* z^(p-2) */
+static void fe_invert(fe out, const fe z) {
+    fe t0, t1, t2, t3;
+    fe_sq(t0, z);
+    fe_sqn(t1, t0, 2);
+    fe_mul(t1, z, t1);
+    fe_mul(t0, t0, t1);
+    fe_sq(t2, t0);
+    fe_mul(t1, t1, t2);
+    fe_sqn(t2, t1, 5);
+    fe_mul(t1, t2, t1);
+    fe_sqn(t2, t1, 10);
+    fe_mul(t2, t2, t1);
+    fe_sqn(t3, t2, 20);
+    fe_mul(t2, t3, t2);
+    fe_sqn(t2, t2, 10);
+    fe_mul(t1, t2, t1);
+    fe_sqn(t2, t1, 50);
+    fe_mul(t2, t2, t1);
+    fe_sqn(t3, t2, 100);
+    fe_mul(t2, t3, t2);
+    fe_sqn(t2, t2, 50);
+    fe_mul(t1, t2, t1);
+    fe_sqn(t1, t1, 5);
+    fe_mul(out, t1, t0);
+}
+
+/* z^((p-5)/8) */
+static void fe_pow22523(fe out, const fe z) {
+    fe t0, t1, t2;
+    fe_sq(t0, z);
+    fe_sqn(t1, t0, 2);
+    fe_mul(t1, z, t1);
+    fe_mul(t0, t0, t1);
+    fe_sq(t0, t0);
+    fe_mul(t0, t1, t0);
+    fe_sqn(t1, t0, 5);
+    fe_mul(t0, t1, t0);
+    fe_sqn(t1, t0, 10);
+    fe_mul(t1, t1, t0);
+    fe_sqn(t2, t1, 20);
+    fe_mul(t1, t2, t1);
+    fe_sqn(t1, t1, 10);
+    fe_mul(t0, t1, t0);
+    fe_sqn(t1, t0, 50);
+    fe_mul(t1, t1, t0);
+    fe_sqn(t2, t1, 100);
+    fe_mul(t1, t2, t1);
+    fe_sqn(t1, t1, 50);
+    fe_mul(t0, t1, t0);
+    fe_sqn(t0, t0, 2);
+    fe_mul(out, t0, z);
+}
+
+/* ---- Group arithmetic ---- */
+
+typedef struct {
+    fe X, Y, Z, T;
+} ge_p3;
+
+/* Addend form: (Y+X, Y-X, 2Z, 2dT) */
+typedef struct {
+    fe YplusX, YminusX, Z2, T2d;
+} ge_cached;
+
+static const ge_p3 GE_BASE = {
+    {0x62d608f25d51a, 0x412a4b4f6592a, 0x75b7171a4b31d, 0x1ff60527118fe, 0x216936d3cd6e5},
+    {0x6666666666658, 0x4cccccccccccc, 0x1999999999999, 0x3333333333333, 0x6666666666666},
+    {1, 0, 0, 0, 0},
+    {0x68ab3a5b7dda3, 0x00eea2a5eadbb, 0x2af8df483c27e, 0x332b375274732, 0x67875f0fd78b7}
+};
+
+static void ge_identity(ge_p3* p) {
+    fe_0(p->X);
+    fe_1(p->Y);
+    fe_1(p->Z);
+    fe_0(p->T);
+}
+
+static void ge_to_cached(ge_cached* c, const ge_p3* p) {
+    fe_add(c->YplusX, p->Y, p->X);
+    fe_sub(c->YminusX, p->Y, p->X);
+    fe_add(c->Z2, p->Z, p->Z);
+    fe_mul(c->T2d, p->T, FE_D2);
+}
+
+static void ge_cached_identity(ge_cached* c) {
+    fe_1(c->YplusX);
+    fe_1(c->YminusX);
+    fe_1(c->Z2);
+    fe_add(c->Z2, c->Z2, c->Z2);
+    fe_0(c->T2d);
+}
+
+/* r = p + q (complete formula for a = -1) */
+static void ge_add(ge_p3* r, const ge_p3* p, const ge_cached* q) {
+    fe a, b, c, d, e, f, g, h;
+    fe_sub(a, p->Y, p->X);
+    fe_mul(a, a, q->YminusX);
+    fe_add(b, p->Y, p->X);
+    fe_mul(b, b, q->YplusX);
+    fe_mul(c, p->T, q->T2d);
+    fe_mul(d, p->Z, q->Z2);
+    fe_sub(e, b, a);
+    fe_sub(f, d, c);
+    fe_add(g, d, c);
+    fe_add(h, b, a);
+    fe_mul(r->X, e, f);
+    fe_mul(r->Y, g, h);
+    fe_mul(r->T, e, h);
+    fe_mul(r->Z, f, g);
+}
+
+/* r = p - q */
+static void ge_sub(ge_p3* r, const ge_p3* p, const ge_cached* q) {
+    fe a, b, c, d, e, f, g, h;
+    fe_sub(a, p->Y, p->X);
+    fe_mul(a, a, q->YplusX);
+    fe_add(b, p->Y, p->X);
+    fe_mul(b, b, q->YminusX);
+    fe_mul(c, p->T, q->T2d);
+    fe_mul(d, p->Z, q->Z2);
+    fe_sub(e, b, a);
+    fe_add(f, d, c);
+    fe_sub(g, d, c);
+    fe_add(h, b, a);
+    fe_mul(r->X, e, f);
+    fe_mul(r->Y, g, h);
+    fe_mul(r->T, e, h);
+    fe_mul(r->Z, f, g);
+}
+
+static void ge_dbl(ge_p3* r, const ge_p3* p) {
+    fe a, b, c, e, f, g, h;
+    fe_sq(a, p->X);
+    fe_sq(b, p->Y);
+    fe_sq(c, p->Z);
+    fe_add(c, c, c);
+    fe_add(h, a, b);
+    fe_add(e, p->X, p->Y);
+    fe_sq(e, e);
+    fe_sub(e, h, e);
+    fe_sub(g, a, b);
+    fe_add(f, c, g);
+    fe_mul(r->X, e, f);
+    fe_mul(r->Y, g, h);
+    fe_mul(r->T, e, h);
+    fe_mul(r->Z, f, g);
+}
+
+static void ge_neg(ge_p3* r, const ge_p3* p) {
+    fe_neg(r->X, p->X);
+    fe_copy(r->Y, p->Y);
+    fe_copy(r->Z, p->Z);
+    fe_neg(r->T, p->T);
+}
+
+static void ge_tobytes(uint8_t* s, const ge_p3* p) {
+    fe recip, x, y;
+    fe_invert(recip, p->Z);
+    fe_mul(x, p->X, recip);
+    fe_mul(y, p->Y, recip);
+    fe_tobytes(s, y);
+    s[31] ^= (uint8_t)(fe_isnegative(x) << 7);
+}
+
+/* Decode a point; rejects non-canonical y and points off the curve */
+static int ge_frombytes(ge_p3* p, const uint8_t* s) {
+    fe u, v, v3, vxx, check;
+    uint8_t canonical[32];
+
+    fe_frombytes(p->Y, s);
+    fe_tobytes(canonical, p->Y);
+    canonical[31] |= s[31] & 0x80;
+    if (memcmp(canonical, s, 32) != 0) return -1;
+
+    fe_1(p->Z);
+    fe_sq(u, p->Y);
+    fe_mul(v, u, FE_D);
+    fe_sub(u, u, p->Z); /* u = y^2 - 1 */
+    fe_add(v, v, p->Z); /* v = d y^2 + 1 */
+
+    fe_sq(v3, v);
+    fe_mul(v3, v3, v); /* v^3 */
+    fe_sq(p->X, v3);
+    fe_mul(p->X, p->X, v);
+    fe_mul(p->X, p->X, u); /* u v^7 */
+    fe_pow22523(p->X, p->X);
+    fe_mul(p->X, p->X, v3);
+    fe_mul(p->X, p->X, u); /* u v^3 (u v^7)^((p-5)/8) */
+
+    fe_sq(vxx, p->X);
+    fe_mul(vxx, vxx, v);
+    if (!fe_equal(vxx, u)) {
+        fe_add(check, vxx, u);
+        if (!fe_iszero(check)) return -1;
+        fe_mul(p->X, p->X, FE_SQRTM1);
+    }
+
+    int sign = s[31] >> 7;
+    if (fe_iszero(p->X) && sign) return -1;
+    if (fe_isnegative(p->X) != sign) fe_neg(p->X, p->X);
+
+    fe_mul(p->T, p->X, p->Y);
+    return 0;
+}
+
+static int ge_is_identity(const ge_p3* p) {
+    return fe_iszero(p->X) && fe_equal(p->Y, p->Z);
+}
+
+/* Constant-time [a]B with 4-bit windows; a is 32 little-endian bytes */
+static void ge_scalarmult_base(ge_p3* r, const uint8_t* a) {
+    ge_cached table[16];
+    ge_p3 acc;
+
+    ge_cached_identity(&table[0]);
+    ge_to_cached(&table[1], &GE_BASE);
+    acc = GE_BASE;
+    for (int i = 2; i < 16; i++) {
+        ge_add(&acc, &acc, &table[1]);
+        ge_to_cached(&table[i], &acc);
+    }
+
+    ge_identity(&acc);
+    for (int i = 63; i >= 0; i--) {
+        if (i != 63) {
+            for (int k = 0; k < 4; k++) ge_dbl(&acc, &acc);
+        }
+        uint64_t digit = (a[i / 2] >> (4 * (i & 1))) & 15;
+        ge_cached sel;
+        ge_cached_identity(&sel);
+        for (uint64_t k = 1; k < 16; k++) {
+            uint64_t eq = ((k ^ digit) - 1) >> 63;
+            fe_cmov(sel.YplusX, table[k].YplusX, eq);
+            fe_cmov(sel.YminusX, table[k].YminusX, eq);
+            fe_cmov(sel.Z2, table[k].Z2, eq);
+            fe_cmov(sel.T2d, table[k].T2d, eq);
+        }
+        ge_add(&acc, &acc, &sel);
+    }
+    *r = acc;
+}
+
+/* Signed sliding window digits in [-15, 15], odd or zero */
+static void slide(int8_t* r, const uint8_t* a) {
+    for (int i = 0; i < 256; i++) r[i] = 1 & (a[i >> 3] >> (i & 7));
+
+    for (int i = 0; i < 256; i++) {
+        if (!r[i]) continue;
+        for (int b = 1; b <= 6 && i + b < 256; b++) {
+            if (!r[i + b]) continue;
+            if (r[i] + (r[i + b] << b) <= 15) {
+                r[i] += r[i + b] << b;
+                r[i + b] = 0;
+            } else if (r[i] - (r[i + b] << b) >= -15) {
+                r[i] -= r[i + b] << b;
+                for (int k = i + b; k < 256; k++) {
+                    if (!r[k]) {
+                        r[k] = 1;
+                        break;
+                    }
+                    r[k] = 0;
+                }
+            } else {
+                break;
+            }
+        }
+    }
+}
+
+/* Variable-time sum of [scalars[j]] points[j] (Straus, shared doublings).
+ * slides and tables are caller-provided workspace for n points. */
+static void ge_msm(ge_p3* r, const ge_p3* points, const uint8_t (*scalars)[32], size_t n,
+                   int8_t (*slides)[256], ge_cached (*tables)[8]) {
+    int top = -1;
+    for (size_t j = 0; j < n; j++) {
+        slide(slides[j], scalars[j]);
+        for (int i = 255; i > top; i--) {
+            if (slides[j][i]) {
+                top = i;
+                break;
+            }
+        }
+
+        /* Odd multiples P, 3P, ..., 15P */
+        ge_p3 p2, t;
+        ge_cached c2;
+        ge_to_cached(&tables[j][0], &points[j]);
+        ge_dbl(&p2, &points[j]);
+        ge_to_cached(&c2, &p2);
+        t = points[j];
+        for (int k = 1; k < 8; k++) {
+            ge_add(&t, &t, &c2);
+            ge_to_cached(&tables[j][k], &t);
+        }
+    }
+
+    ge_identity(r);
+    for (int i = top; i >= 0; i--) {
+        ge_dbl(r, r);
+        for (size_t j = 0; j < n; j++) {
+            int8_t s = slides[j][i];
+            if (s > 0) {
+                ge_add(r, r, &tables[j][s / 2]);
+            } else if (s < 0) {
+                ge_sub(r, r, &tables[j][-s / 2]);
+            }
+        }
+    }
+}
+
+/* ---- Scalars mod L = 2^252 + 27742317777372353535851937790883648493 ---- */
+
+static const uint32_t L32[8] = {
+    0x5cf5d3ed, 0x5812631a, 0xa2f79cd6, 0x14def9de, 0x00000000, 0x00000000, 0x00000000, 0x10000000
+};
+
+/* floor(2^512 / L) for Barrett reduction */
+static const uint32_t MU32[9] = {
+    0x0a2c131b, 0xed9ce5a3, 0x086329a7, 0x2106215d, 0xffffffeb, 0xffffffff, 0xffffffff, 0xffffffff,
+    0x0000000f
+};
+
+/* r -= L if r >= L, without branching on r */
+static void sc_sub_l(uint32_t r[9]) {
+    uint32_t t[9];
+    uint64_t borrow = 0;
+    for (int i = 0; i < 9; i++) {
+        uint64_t diff = (uint64_t)r[i] - (i < 8 ? L32[i] : 0) - borrow;
+        t[i] = (uint32_t)diff;
+        borrow = (diff >> 63) & 1;
+    }
+    uint32_t keep = (uint32_t)0 - (uint32_t)borrow; /* all ones if r < L */
+    for (int i = 0; i < 9; i++) r[i] = (r[i] & keep) | (t[i] & ~keep);
+}
+
+/* Constant-time Barrett reduction of a 512-bit little-endian limb array mod L */
+static void sc_reduce_limbs(uint8_t* out, const uint32_t x[16]) {
+    /* q = floor(floor(x / 2^224) * mu / 2^288) */
+    uint32_t prod[18] = {0};
+    for (int i = 0; i < 9; i++) {
+        uint64_t carry = 0;
+        for (int j = 0; j < 9; j++) {
+            uint64_t t = (uint64_t)x[7 + i] * MU32[j] + prod[i + j] + carry;
+            prod[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        prod[i + 9] = (uint32_t)carry;
+    }
+    const uint32_t* q = prod + 9;
+
+    /* r = (x - q L) mod 2^288, which is below 3L */
+    uint32_t ql[9] = {0};
+    for (int i = 0; i < 9; i++) {
+        uint64_t carry = 0;
+        for (int j = 0; i + j < 9; j++) {
+            uint64_t t = (uint64_t)q[i] * (j < 8 ? L32[j] : 0) + ql[i + j] + carry;
+            ql[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+    }
+    uint32_t r[9];
+    uint64_t borrow = 0;
+    for (int i = 0; i < 9; i++) {
+        uint64_t diff = (uint64_t)x[i] - ql[i] - borrow;
+        r[i] = (uint32_t)diff;
+        borrow = (diff >> 63) & 1;
+    }
+    sc_sub_l(r);
+    sc_sub_l(r);
+
+    for (int i = 0; i < 8; i++) {
+        out[4 * i] = (uint8_t)r[i];
+        out[4 * i + 1] = (uint8_t)(r[i] >> 8);
+        out[4 * i + 2] = (uint8_t)(r[i] >> 16);
+        out[4 * i + 3] = (uint8_t)(r[i] >> 24);
+    }
+}
+
+static void sc_load(uint32_t* x, const uint8_t* s, int words) {
+    for (int i = 0; i < words; i++) {
+        x[i] = (uint32_t)s[4 * i] | ((uint32_t)s[4 * i + 1] << 8) |
+               ((uint32_t)s[4 * i + 2] << 16) | ((uint32_t)s[4 * i + 3] << 24);
+    }
+}
+
+/* out = s mod L for a 64-byte s */
+static void sc_reduce64(uint8_t* out, const uint8_t* s) {
+    uint32_t x[16];
+    sc_load(x, s, 16);
+    sc_reduce_limbs(out, x);
+}
+
+/* out = (a * b + c) mod L */
+static void sc_muladd(uint8_t* out, const uint8_t* a, const uint8_t* b, const uint8_t* c) {
+    uint32_t x[8], y[8], z[16] = {0};
+    sc_load(x, a, 8);
+    sc_load(y, b, 8);
+
+    for (int i = 0; i < 8; i++) {
+        uint64_t carry = 0;
+        for (int j = 0; j < 8; j++) {
+            uint64_t t = (uint64_t)x[i] * y[j] + z[i + j] + carry;
+            z[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        z[i + 8] = (uint32_t)carry;
+    }
+
+    uint32_t w[8];
+    sc_load(w, c, 8);
+    uint64_t carry = 0;
+    for (int i = 0; i < 16; i++) {
+        uint64_t t = (uint64_t)z[i] + (i < 8 ? w[i] : 0) + carry;
+        z[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+
+    sc_reduce_limbs(out, z);
+}
+
+/* Whether s < L */
+static int sc_is_canonical(const uint8_t* s) {
+    uint32_t x[8];
+    sc_load(x, s, 8);
+    for (int i = 7; i >= 0; i--) {
+        if (x[i] < L32[i]) return 1;
+        if (x[i] > L32[i]) return 0;
+    }
+    return 0;
+}
+
+/* ---- Signatures ---- */
+
+static void expand_seed(const uint8_t* seed, uint8_t az[64]) {
+    sha512_ctx_t ctx;
+    sha512_init(&ctx);
+    sha512_update(&ctx, seed, KOLIBRI_ED25519_SEED_SIZE);
+    sha512_final(&ctx, az);
+    az[0] &= 248;
+    az[31] &= 127;
+    az[31] |= 64;
+}
+
+/* h = SHA-512(R || A || M) mod L */
+static void challenge(uint8_t* h, const uint8_t* r, const uint8_t* public_key,
+                      const void* message, size_t len) {
+    uint8_t digest[64];
+    sha512_ctx_t ctx;
+    sha512_init(&ctx);
+    sha512_update(&ctx, r, 32);
+    sha512_update(&ctx, public_key, 32);
+    sha512_update(&ctx, message, len);
+    sha512_final(&ctx, digest);
+    sc_reduce64(h, digest);
+}
+
+void kolibri_ed25519_public_key(const uint8_t* seed, uint8_t* public_key) {
+    uint8_t az[64];
+    ge_p3 a;
+    expand_seed(seed, az);
+    ge_scalarmult_base(&a, az);
+    ge_tobytes(public_key, &a);
+}
+
+void kolibri_ed25519_sign(const uint8_t* seed, const uint8_t* public_key,
+                          const void* message, size_t len, uint8_t* signature) {
+    uint8_t az[64], nonce[64], r[32], h[32];
+    sha512_ctx_t ctx;
+    ge_p3 rp;
+
+    expand_seed(seed, az);
+
+    sha512_init(&ctx);
+    sha512_update(&ctx, az + 32, 32);
+    sha512_update(&ctx, message, len);
+    sha512_final(&ctx, nonce);
+    sc_reduce64(r, nonce);
+
+    ge_scalarmult_base(&rp, r);
+    ge_tobytes(signature, &rp);
+
+    challenge(h, signature, public_key, message, len);
+    sc_muladd(signature + 32, h, az, r);
+}
+
+/* A decoded signature ready for the verification equation */
+typedef struct {
+    ge_p3 neg_a;
+    ge_p3 neg_r;
+    uint8_t h[32];
+} prepared_sig_t;
+
+static int prepare(prepared_sig_t* p, const uint8_t* public_key, const void* message, size_t len,
+                   const uint8_t* signature) {
+    ge_p3 a, r;
+    if (!sc_is_canonical(signature + 32)) return -1;
+    if (ge_frombytes(&a, public_key) != 0) return -1;
+    if (ge_frombytes(&r, signature) != 0) return -1;
+
+    ge_neg(&p->neg_a, &a);
+    ge_neg(&p->neg_r, &r);
+    challenge(p->h, signature, public_key, message, len);
+    return 0;
+}
+
+/* [8] P == identity */
+static int cofactor_clears(ge_p3* p) {
+    ge_dbl(p, p);
+    ge_dbl(p, p);
+    ge_dbl(p, p);
+    return ge_is_identity(p);
+}
+
+int kolibri_ed25519_verify(const uint8_t* public_key, const void* message, size_t len,
+                           const uint8_t* signature) {
+    prepared_sig_t p;
+    if (!public_key || !signature || (!message && len > 0)) return -1;
+    if (prepare(&p, public_key, message, len, signature) != 0) return -1;
+
+    /* [S]B + [h](-A) + (-R) */
+    ge_p3 points[3] = {GE_BASE, p.neg_a, p.neg_r};
+    uint8_t scalars[3][32] = {{0}};
+    memcpy(scalars[0], signature + 32, 32);
+    memcpy(scalars[1], p.h, 32);
+    scalars[2][0] = 1;
+
+    int8_t slides[3][256];
+    ge_cached tables[3][8];
+    ge_p3 sum;
+    ge_msm(&sum, points, (const uint8_t (*)[32])scalars, 3, slides, tables);
+
+    return cofactor_clears(&sum) ? 0 : -1;
+}
+
+/* Verify one chunk of at most KOLIBRI_ED25519_BATCH_SIZE signatures.
+ * Point layout: B, then -R_i per signature, then -A per distinct key, so a
+ * chunk from a single signer needs only one full-length scalar besides B. */
+static int verify_chunk(const uint8_t* const* messages, const size_t* lens,
+                        const uint8_t* const* public_keys, const uint8_t* const* signatures,
+                        size_t count, const uint8_t* entropy, ge_p3* points, uint8_t (*scalars)[32],
+                        int8_t (*slides)[256], ge_cached (*tables)[8]) {
+    uint8_t h[KOLIBRI_ED25519_BATCH_SIZE][32];
+    size_t key_index[KOLIBRI_ED25519_BATCH_SIZE];
+    const uint8_t* keys[KOLIBRI_ED25519_BATCH_SIZE];
+    size_t key_count = 0;
+    ge_p3* key_points = points + 1 + count;
+    uint8_t (*key_scalars)[32] = scalars + 1 + count;
+    sha512_ctx_t seed_ctx;
+
+    points[0] = GE_BASE;
+    sha512_init(&seed_ctx);
+    sha512_update(&seed_ctx, "kolibri-ed25519-batch", 21);
+    sha512_update(&seed_ctx, entropy, 32);
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* sig = signatures[i];
+        if (!public_keys[i] || !sig || (!messages[i] && lens[i] > 0)) return -1;
+        if (!sc_is_canonical(sig + 32)) return -1;
+
+        size_t k = 0;
+        while (k < key_count && memcmp(keys[k], public_keys[i], 32) != 0) k++;
+        if (k == key_count) {
+            ge_p3 a;
+            if (ge_frombytes(&a, public_keys[i]) != 0) return -1;
+            ge_neg(&key_points[k], &a);
+            memset(key_scalars[k], 0, 32);
+            keys[key_count++] = public_keys[i];
+        }
+        key_index[i] = k;
+
+        ge_p3 r;
+        if (ge_frombytes(&r, sig) != 0) return -1;
+        ge_neg(&points[1 + i], &r);
+        challenge(h[i], sig, public_keys[i], messages[i], lens[i]);
+
+        sha512_update(&seed_ctx, sig, 64);
+        sha512_update(&seed_ctx, public_keys[i], 32);
+        sha512_update(&seed_ctx, h[i], 32);
+    }
+
+    /* The 128-bit weights z_i hash the caller's OS entropy together with
+     * every signature, key and challenge in the chunk: unpredictable to a
+     * forger, and still bound to the inputs should no entropy be available. */
+    uint8_t seed[64];
+    uint8_t b_scalar[32] = {0};
+    sha512_final(&seed_ctx, seed);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t index[8];
+        uint8_t digest[64];
+        uint8_t z[32] = {0};
+        sha512_ctx_t ctx;
+        store_le64(index, (uint64_t)i);
+        sha512_init(&ctx);
+        sha512_update(&ctx, seed, sizeof(seed));
+        sha512_update(&ctx, index, sizeof(index));
+        sha512_final(&ctx, digest);
+        memcpy(z, digest, 16);
+
+        /* R_i weight z_i, A weight sum z_i h_i, B weight sum z_i S_i */
+        memcpy(scalars[1 + i], z, 32);
+        sc_muladd(key_scalars[key_index[i]], z, h[i], key_scalars[key_index[i]]);
+        sc_muladd(b_scalar, z, signatures[i] + 32, b_scalar);
+    }
+    memcpy(scalars[0], b_scalar, 32);
+
+    ge_p3 sum;
+    ge_msm(&sum, points, (const uint8_t (*)[32])scalars, 1 + count + key_count, slides, tables);
+    return cofactor_clears(&sum) ? 0 : -1;
+}
+
+int kolibri_ed25519_verify_batch(const uint8_t* const* messages, const size_t* lens,
+                                 const uint8_t* const* public_keys,
+                                 const uint8_t* const* signatures,
+                                 size_t count, int* valid) {
+    if (!messages || !lens || !public_keys || !signatures) return -1;
+    if (count == 0) return 0;
+
+    size_t max_points = 1 + 2 * KOLIBRI_ED25519_BATCH_SIZE;
+    ge_p3* points = (ge_p3*)malloc(sizeof(ge_p3) * max_points);
+    uint8_t (*scalars)[32] = (uint8_t (*)[32])malloc(32 * max_points);
+    int8_t (*slides)[256] = (int8_t (*)[256])malloc(256 * max_points);
+    ge_cached (*tables)[8] = (ge_cached (*)[8])malloc(sizeof(ge_cached) * 8 * max_points);
+
+    /* Fresh per call; zeros if the OS has none to give (see the header) */
+    uint8_t entropy[32] = {0};
+    if (count > 1 && getentropy(entropy, sizeof(entropy)) != 0) memset(entropy, 0, sizeof(entropy));
+
+    int result = 0;
+    for (size_t start = 0; start < count; start += KOLIBRI_ED25519_BATCH_SIZE) {
+        size_t n = count - start;
+        if (n > KOLIBRI_ED25519_BATCH_SIZE) n = KOLIBRI_ED25519_BATCH_SIZE;
+
+        int ok = -1;
+        if (points && scalars && slides && tables && n > 1) {
+            ok = verify_chunk(messages + start, lens + start, public_keys + start,
+                              signatures + start, n, entropy, points, scalars, slides, tables);
+        }
+
+        if (ok == 0) {
+            if (valid) {
+                for (size_t i = 0; i < n; i++) valid[start + i] = 1;
+            }
+            continue;
+        }
+
+        /* Single signature, allocation failure or a bad chunk: check one by one */
+        for (size_t i = start; i < start + n; i++) {
+            int v = kolibri_ed25519_verify(public_keys[i], messages[i], lens[i], signatures[i]) == 0;
+            if (valid) valid[i] = v;
+            if (!v) result = -1;
+        }
+    }
+
+    free(points);
+    free(scalars);
+    free(slides);
+    free(tables);
+    return result;
+}
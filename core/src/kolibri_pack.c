@@ -0,0 +1,802 @@
+/**
+ * KOLIBRI.AI Pack Implementation
+ */
+
+#include "kolibri_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KOLIBRI_PACK_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#define PACK_HEADER_SIZE 16
+#define PACK_FRAME_HEADER_SIZE 16
+#define PACK_INDEX_ENTRY_SIZE 24
+#define PACK_TRAILER_SIZE 28
+#define PACK_MAX_THREADS 16
+
+/* LZ parameters; the end limits match LZ4 so sequences stay decodable by
+ * fast decoders that over-copy */
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_LAST_LITERALS 5
+#define LZ_MATCH_LIMIT 12 /* No match starts in the last 12 bytes */
+#define LZ_MAX_OFFSET 65535
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+/* ---- CRC32C ---- */
+
+static uint32_t crc_table[8][256];
+static pthread_once_t crc_table_once = PTHREAD_ONCE_INIT;
+
+static void crc_table_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1)));
+        crc_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t c = crc_table[t - 1][i];
+            crc_table[t][i] = (c >> 8) ^ crc_table[0][c & 0xFF];
+        }
+    }
+}
+
+/* Slicing-by-8 */
+static uint32_t crc32c_generic(uint32_t crc, const uint8_t* p, size_t len) {
+    pthread_once(&crc_table_once, crc_table_init);
+    
+    while (len >= 8) {
+        uint32_t lo = crc ^ get_u32(p);
+        uint32_t hi = get_u32(p + 4);
+        crc = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^
+              crc_table[5][(lo >> 16) & 0xFF] ^ crc_table[4][lo >> 24] ^
+              crc_table[3][hi & 0xFF] ^ crc_table[2][(hi >> 8) & 0xFF] ^
+              crc_table[1][(hi >> 16) & 0xFF] ^ crc_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) crc = (crc >> 8) ^ crc_table[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#ifdef KOLIBRI_PACK_X86
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t* p, size_t len) {
+#ifdef __x86_64__
+    uint64_t c = crc;
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+        p += 8;
+        len -= 8;
+    }
+    crc = (uint32_t)c;
+#endif
+    while (len >= 4) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        len -= 4;
+    }
+    while (len-- > 0) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+static atomic_int crc_selected = -1;
+
+static int crc_has_sse42(void) {
+    int selected = atomic_load_explicit(&crc_selected, memory_order_relaxed);
+    if (selected < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        selected = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2) ? 1 : 0;
+        atomic_store_explicit(&crc_selected, selected, memory_order_relaxed);
+    }
+    return selected;
+}
+#endif /* KOLIBRI_PACK_X86 */
+
+uint32_t kolibri_crc32c(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+#ifdef KOLIBRI_PACK_X86
+    if (crc_has_sse42()) return ~crc32c_sse42(crc, p, len);
+#endif
+    return ~crc32c_generic(crc, p, len);
+}
+
+/* ---- LZ codec ----
+ *
+ * A block is a run of sequences: token (literal length << 4 | match length
+ * - 4), literal length extension bytes, literals, offset u16 LE, match
+ * length extension bytes. A nibble of 15 continues in bytes of 255 until
+ * a smaller one. The last sequence has literals only. */
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static uint32_t lz_hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static uint8_t* put_length(uint8_t* op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t* put_sequence(uint8_t* op, const uint8_t* literals, size_t literal_len,
+                             size_t offset, size_t match_len) {
+    uint8_t* token = op++;
+    *token = (uint8_t)((literal_len >= 15 ? 15 : literal_len) << 4);
+    if (literal_len >= 15) op = put_length(op, literal_len - 15);
+    memcpy(op, literals, literal_len);
+    op += literal_len;
+    if (offset == 0) return op;
+    
+    op[0] = (uint8_t)offset;
+    op[1] = (uint8_t)(offset >> 8);
+    op += 2;
+    match_len -= LZ_MIN_MATCH;
+    *token |= (uint8_t)(match_len >= 15 ? 15 : match_len);
+    if (match_len >= 15) op = put_length(op, match_len - 15);
+    return op;
+}
+
+/* Length of the common prefix of a and b, up to limit */
+static const uint8_t* match_end(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+    while (a + 8 <= limit) {
+        uint64_t x, y;
+        memcpy(&x, a, 8);
+        memcpy(&y, b, 8);
+        if (x != y) break;
+        a += 8;
+        b += 8;
+    }
+    while (a < limit && *a == *b) {
+        a++;
+        b++;
+    }
+    return a;
+}
+
+size_t kolibri_lz_bound(size_t len) {
+    return len + len / 255 + 16;
+}
+
+size_t kolibri_lz_compress(const uint8_t* src, size_t len, uint8_t* dst, size_t capacity) {
+    if (!src || !dst || capacity < kolibri_lz_bound(len)) return 0;
+    
+    uint32_t table[1u << LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+    
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* end = src + len;
+    uint8_t* op = dst;
+    
+    if (len > LZ_MATCH_LIMIT) {
+        const uint8_t* limit = end - LZ_MATCH_LIMIT;
+        const uint8_t* last = end - LZ_LAST_LITERALS;
+        ip++;
+        
+        while (ip < limit) {
+            uint32_t seq = read32(ip);
+            uint32_t h = lz_hash(seq);
+            const uint8_t* ref = src + table[h];
+            table[h] = (uint32_t)(ip - src);
+            
+            if ((size_t)(ip - ref) > LZ_MAX_OFFSET || read32(ref) != seq) {
+                /* Step faster through data that does not compress */
+                ip += 1 + ((size_t)(ip - anchor) >> 6);
+                continue;
+            }
+            
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            const uint8_t* mend = match_end(ip + LZ_MIN_MATCH, ref + LZ_MIN_MATCH, last);
+            
+            op = put_sequence(op, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), (size_t)(mend - ip));
+            ip = anchor = mend;
+            if (ip < limit) table[lz_hash(read32(ip - 2))] = (uint32_t)(ip - 2 - src);
+        }
+    }
+    
+    op = put_sequence(op, anchor, (size_t)(end - anchor), 0, 0);
+    return (size_t)(op - dst);
+}
+
+static int get_length(const uint8_t** ip, const uint8_t* end, size_t* len, size_t limit) {
+    uint8_t b;
+    do {
+        if (*ip >= end) return -1;
+        b = *(*ip)++;
+        *len += b;
+        if (*len > limit) return -1;
+    } while (b == 255);
+    return 0;
+}
+
+int kolibri_lz_decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t raw_len) {
+    if (!src || (!dst && raw_len > 0)) return -1;
+    
+    const uint8_t* ip = src;
+    const uint8_t* end = src + len;
+    uint8_t* op = dst;
+    uint8_t* out_end = dst + raw_len;
+    
+    for (;;) {
+        if (ip >= end) return -1;
+        unsigned token = *ip++;
+        
+        size_t literal_len = token >> 4;
+        if (literal_len == 15 && get_length(&ip, end, &literal_len, raw_len) != 0) return -1;
+        if ((size_t)(end - ip) < literal_len || (size_t)(out_end - op) < literal_len) return -1;
+        memcpy(op, ip, literal_len);
+        op += literal_len;
+        ip += literal_len;
+        if (ip == end) break;
+        
+        if (end - ip < 2) return -1;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return -1;
+        
+        size_t match_len = token & 15;
+        if (match_len == 15 && get_length(&ip, end, &match_len, raw_len) != 0) return -1;
+        match_len += LZ_MIN_MATCH;
+        if ((size_t)(out_end - op) < match_len) return -1;
+        
+        /* Overlapping matches repeat the pattern; copy it in doubling steps */
+        const uint8_t* match = op - offset;
+        while (match_len > 0) {
+            size_t step = (size_t)(op - match);
+            if (step > match_len) step = match_len;
+            memcpy(op, match, step);
+            op += step;
+            match_len -= step;
+        }
+    }
+    
+    return op == out_end ? 0 : -1;
+}
+
+/* ---- Writer ---- */
+
+struct kolibri_pack_writer_t {
+    FILE* file;
+    uint8_t* raw;
+    size_t raw_size;
+    size_t raw_capacity;
+    uint8_t* stored;
+    size_t stored_capacity;
+    uint32_t frame_records;
+    kolibri_pack_frame_t* frames;
+    uint32_t frame_count;
+    uint32_t frame_capacity;
+    uint64_t offset;
+    uint64_t records;
+    uint64_t raw_bytes;
+    int failed;
+};
+
+static int writer_flush(kolibri_pack_writer_t* w) {
+    if (w->raw_size == 0) return KOLIBRI_PACK_OK;
+    
+    if (w->frame_count == w->frame_capacity) {
+        uint32_t capacity = w->frame_capacity ? w->frame_capacity * 2 : 64;
+        kolibri_pack_frame_t* frames =
+            (kolibri_pack_frame_t*)realloc(w->frames, capacity * sizeof(kolibri_pack_frame_t));
+        if (!frames) return KOLIBRI_PACK_ERROR;
+        w->frames = frames;
+        w->frame_capacity = capacity;
+    }
+    
+    size_t bound = kolibri_lz_bound(w->raw_size);
+    if (w->stored_capacity < bound) {
+        uint8_t* stored = (uint8_t*)realloc(w->stored, bound);
+        if (!stored) return KOLIBRI_PACK_ERROR;
+        w->stored = stored;
+        w->stored_capacity = bound;
+    }
+    
+    /* Keep the raw bytes when compression does not pay */
+    size_t size = kolibri_lz_compress(w->raw, w->raw_size, w->stored, w->stored_capacity);
+    int compressed = size > 0 && size < w->raw_size;
+    const uint8_t* data = compressed ? w->stored : w->raw;
+    if (!compressed) size = w->raw_size;
+    
+    kolibri_pack_frame_t* frame = &w->frames[w->frame_count];
+    frame->offset = w->offset;
+    frame->first_record = w->records - w->frame_records;
+    frame->raw_size = (uint32_t)w->raw_size;
+    frame->stored_size = (uint32_t)size;
+    frame->record_count = w->frame_records;
+    frame->crc = kolibri_crc32c(0, w->raw, w->raw_size);
+    frame->compressed = compressed;
+    
+    uint8_t header[PACK_FRAME_HEADER_SIZE];
+    put_u32(header, frame->raw_size);
+    put_u32(header + 4, frame->stored_size | (compressed ? 0 : KOLIBRI_PACK_STORED));
+    put_u32(header + 8, frame->record_count);
+    put_u32(header + 12, frame->crc);
+    if (fwrite(header, sizeof(header), 1, w->file) != 1 || fwrite(data, size, 1, w->file) != 1) {
+        return KOLIBRI_PACK_ERROR;
+    }
+    
+    w->frame_count++;
+    w->offset += sizeof(header) + size;
+    w->raw_bytes += w->raw_size;
+    w->raw_size = 0;
+    w->frame_records = 0;
+    return KOLIBRI_PACK_OK;
+}
+
+kolibri_pack_writer_t* kolibri_pack_create(const char* path, uint32_t kind) {
+    if (!path) return NULL;
+    
+    kolibri_pack_writer_t* w = (kolibri_pack_writer_t*)calloc(1, sizeof(kolibri_pack_writer_t));
+    if (!w) return NULL;
+    w->raw = (uint8_t*)malloc(KOLIBRI_PACK_FRAME_SIZE);
+    w->raw_capacity = KOLIBRI_PACK_FRAME_SIZE;
+    w->file = w->raw ? fopen(path, "wb") : NULL;
+    
+    uint8_t header[PACK_HEADER_SIZE] = {0};
+    put_u32(header, KOLIBRI_PACK_MAGIC);
+    put_u32(header + 4, kind);
+    put_u32(header + 8, KOLIBRI_PACK_FRAME_SIZE);
+    if (!w->file || fwrite(header, sizeof(header), 1, w->file) != 1) {
+        if (w->file) fclose(w->file);
+        free(w->raw);
+        free(w);
+        return NULL;
+    }
+    w->offset = sizeof(header);
+    return w;
+}
+
+int kolibri_pack_append(kolibri_pack_writer_t* writer, const void* record, size_t len) {
+    if (!writer || (!record && len > 0) || len > KOLIBRI_PACK_MAX_FRAME) return KOLIBRI_PACK_ERROR;
+    if (writer->failed) return KOLIBRI_PACK_ERROR;
+    
+    if (writer->raw_size > 0 && writer->raw_size + len > KOLIBRI_PACK_FRAME_SIZE &&
+        writer_flush(writer) != KOLIBRI_PACK_OK) {
+        writer->failed = 1;
+        return KOLIBRI_PACK_ERROR;
+    }
+    
+    /* A record larger than a frame gets a frame of its own */
+    if (writer->raw_capacity < writer->raw_size + len) {
+        uint8_t* raw = (uint8_t*)realloc(writer->raw, writer->raw_size + len);
+        if (!raw) {
+            writer->failed = 1;
+            return KOLIBRI_PACK_ERROR;
+        }
+        writer->raw = raw;
+        writer->raw_capacity = writer->raw_size + len;
+    }
+    
+    if (len > 0) memcpy(writer->raw + writer->raw_size, record, len);
+    writer->raw_size += len;
+    writer->frame_records++;
+    writer->records++;
+    return KOLIBRI_PACK_OK;
+}
+
+int kolibri_pack_finish(kolibri_pack_writer_t* writer, kolibri_pack_stats_t* stats) {
+    if (!writer) return KOLIBRI_PACK_ERROR;
+    
+    int ok = !writer->failed && writer_flush(writer) == KOLIBRI_PACK_OK;
+    
+    /* Index and trailer */
+    uint64_t index_offset = writer->offset;
+    uint32_t index_crc = 0;
+    for (uint32_t i = 0; i < writer->frame_count && ok; i++) {
+        const kolibri_pack_frame_t* frame = &writer->frames[i];
+        uint8_t entry[PACK_INDEX_ENTRY_SIZE];
+        put_u64(entry, frame->offset);
+        put_u32(entry + 8, frame->raw_size);
+        put_u32(entry + 12, frame->stored_size | (frame->compressed ? 0 : KOLIBRI_PACK_STORED));
+        put_u32(entry + 16, frame->record_count);
+        put_u32(entry + 20, frame->crc);
+        index_crc = kolibri_crc32c(index_crc, entry, sizeof(entry));
+        ok = fwrite(entry, sizeof(entry), 1, writer->file) == 1;
+    }
+    
+    uint8_t trailer[PACK_TRAILER_SIZE];
+    put_u64(trailer, index_offset);
+    put_u64(trailer + 8, writer->records);
+    put_u32(trailer + 16, writer->frame_count);
+    put_u32(trailer + 20, index_crc);
+    put_u32(trailer + 24, KOLIBRI_PACK_INDEX_MAGIC);
+    if (ok) ok = fwrite(trailer, sizeof(trailer), 1, writer->file) == 1;
+    if (fclose(writer->file) != 0) ok = 0;
+    
+    if (ok && stats) {
+        stats->raw_bytes = writer->raw_bytes;
+        stats->packed_bytes = index_offset + (uint64_t)writer->frame_count * PACK_INDEX_ENTRY_SIZE +
+                              PACK_TRAILER_SIZE;
+        stats->records = writer->records;
+        stats->frames = writer->frame_count;
+    }
+    
+    free(writer->raw);
+    free(writer->stored);
+    free(writer->frames);
+    free(writer);
+    return ok ? KOLIBRI_PACK_OK : KOLIBRI_PACK_ERROR;
+}
+
+/* ---- Reader ---- */
+
+struct kolibri_pack_reader_t {
+    FILE* file;
+    uint32_t kind;
+    kolibri_pack_frame_t* frames;
+    uint32_t frame_count;
+    uint64_t record_count;
+    uint64_t raw_bytes;
+    uint64_t file_size;
+    uint8_t* stored; /* Scratch for kolibri_pack_read_frame */
+    size_t stored_capacity;
+};
+
+static int read_at(FILE* f, uint64_t offset, void* buf, size_t len) {
+    if (fseek(f, (long)offset, SEEK_SET) != 0) return KOLIBRI_PACK_ERROR;
+    return fread(buf, len, 1, f) == 1 ? KOLIBRI_PACK_OK : KOLIBRI_PACK_ERROR;
+}
+
+static int load_index(kolibri_pack_reader_t* r) {
+    uint8_t header[PACK_HEADER_SIZE];
+    uint8_t trailer[PACK_TRAILER_SIZE];
+    if (read_at(r->file, 0, header, sizeof(header)) != KOLIBRI_PACK_OK ||
+        get_u32(header) != KOLIBRI_PACK_MAGIC) {
+        return KOLIBRI_PACK_ERROR;
+    }
+    r->kind = get_u32(header + 4);
+    
+    if (fseek(r->file, 0, SEEK_END) != 0) return KOLIBRI_PACK_ERROR;
+    long size = ftell(r->file);
+    if (size < PACK_HEADER_SIZE + PACK_TRAILER_SIZE) return KOLIBRI_PACK_ERROR;
+    r->file_size = (uint64_t)size;
+    if (read_at(r->file, r->file_size - PACK_TRAILER_SIZE, trailer, sizeof(trailer)) != KOLIBRI_PACK_OK ||
+        get_u32(trailer + 24) != KOLIBRI_PACK_INDEX_MAGIC) {
+        return KOLIBRI_PACK_ERROR;
+    }
+    
+    uint64_t index_offset = get_u64(trailer);
+    r->record_count = get_u64(trailer + 8);
+    r->frame_count = get_u32(trailer + 16);
+    if (index_offset < PACK_HEADER_SIZE || index_offset > r->file_size ||
+        (r->file_size - PACK_TRAILER_SIZE - index_offset) != (uint64_t)r->frame_count * PACK_INDEX_ENTRY_SIZE) {
+        return KOLIBRI_PACK_ERROR;
+    }
+    
+    size_t index_size = (size_t)r->frame_count * PACK_INDEX_ENTRY_SIZE;
+    uint8_t* index = (uint8_t*)malloc(index_size ? index_size : 1);
+    r->frames = (kolibri_pack_frame_t*)calloc(r->frame_count ? r->frame_count : 1, sizeof(kolibri_pack_frame_t));
+    int result = index && r->frames ? KOLIBRI_PACK_OK : KOLIBRI_PACK_ERROR;
+    if (result == KOLIBRI_PACK_OK && index_size > 0) result = read_at(r->file, index_offset, index, index_size);
+    if (result == KOLIBRI_PACK_OK && kolibri_crc32c(0, index, index_size) != get_u32(trailer + 20)) {
+        result = KOLIBRI_PACK_ERROR_CORRUPT;
+    }
+    
+    /* Frames must lie in order between the header and the index */
+    uint64_t next = PACK_HEADER_SIZE;
+    uint64_t records = 0;
+    for (uint32_t i = 0; i < r->frame_count && result == KOLIBRI_PACK_OK; i++) {
+        const uint8_t* entry = index + (size_t)i * PACK_INDEX_ENTRY_SIZE;
+        kolibri_pack_frame_t* frame = &r->frames[i];
+        uint32_t stored = get_u32(entry + 12);
+        frame->offset = get_u64(entry);
+        frame->first_record = records;
+        frame->raw_size = get_u32(entry + 8);
+        frame->stored_size = stored & ~KOLIBRI_PACK_STORED;
+        frame->record_count = get_u32(entry + 16);
+        frame->crc = get_u32(entry + 20);
+        frame->compressed = (stored & KOLIBRI_PACK_STORED) == 0;
+        
+        if (frame->offset != next || frame->raw_size > KOLIBRI_PACK_MAX_FRAME ||
+            frame->stored_size > KOLIBRI_PACK_MAX_FRAME ||
+            (!frame->compressed && frame->stored_size != frame->raw_size)) {
+            result = KOLIBRI_PACK_ERROR;
+            break;
+        }
+        next = frame->offset + PACK_FRAME_HEADER_SIZE + frame->stored_size;
+        records += frame->record_count;
+        r->raw_bytes += frame->raw_size;
+    }
+    if (result == KOLIBRI_PACK_OK && (next != index_offset || records != r->record_count)) {
+        result = KOLIBRI_PACK_ERROR;
+    }
+    
+    free(index);
+    return result;
+}
+
+kolibri_pack_reader_t* kolibri_pack_open(const char* path) {
+    if (!path) return NULL;
+    
+    kolibri_pack_reader_t* r = (kolibri_pack_reader_t*)calloc(1, sizeof(kolibri_pack_reader_t));
+    if (!r) return NULL;
+    r->file = fopen(path, "rb");
+    if (!r->file || load_index(r) != KOLIBRI_PACK_OK) {
+        kolibri_pack_close(r);
+        return NULL;
+    }
+    return r;
+}
+
+void kolibri_pack_close(kolibri_pack_reader_t* reader) {
+    if (!reader) return;
+    if (reader->file) fclose(reader->file);
+    free(reader->frames);
+    free(reader->stored);
+    free(reader);
+}
+
+uint32_t kolibri_pack_kind(const kolibri_pack_reader_t* reader) {
+    return reader ? reader->kind : 0;
+}
+
+int kolibri_pack_stats(const kolibri_pack_reader_t* reader, kolibri_pack_stats_t* stats) {
+    if (!reader || !stats) return KOLIBRI_PACK_ERROR;
+    
+    stats->raw_bytes = reader->raw_bytes;
+    stats->packed_bytes = reader->file_size;
+    stats->records = reader->record_count;
+    stats->frames = reader->frame_count;
+    return KOLIBRI_PACK_OK;
+}
+
+const kolibri_pack_frame_t* kolibri_pack_frame(const kolibri_pack_reader_t* reader, uint32_t index) {
+    if (!reader || index >= reader->frame_count) return NULL;
+    return &reader->frames[index];
+}
+
+int kolibri_pack_find_record(const kolibri_pack_reader_t* reader, uint64_t record, uint32_t* index) {
+    if (!reader || !index || record >= reader->record_count) return KOLIBRI_PACK_ERROR;
+    
+    /* Last frame whose first record is <= record; empty frames hold none */
+    uint32_t lo = 0, hi = reader->frame_count;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (reader->frames[mid].first_record <= record) lo = mid;
+        else hi = mid;
+    }
+    while (reader->frames[lo].record_count == 0) lo++;
+    *index = lo;
+    return KOLIBRI_PACK_OK;
+}
+
+/* Read a frame's stored bytes, checking its header against the index */
+static int load_frame(FILE* f, const kolibri_pack_frame_t* frame, uint8_t** stored, size_t* capacity) {
+    uint8_t header[PACK_FRAME_HEADER_SIZE];
+    if (read_at(f, frame->offset, header, sizeof(header)) != KOLIBRI_PACK_OK) return KOLIBRI_PACK_ERROR;
+    if (get_u32(header) != frame->raw_size ||
+        get_u32(header + 4) != (frame->stored_size | (frame->compressed ? 0 : KOLIBRI_PACK_STORED)) ||
+        get_u32(header + 8) != frame->record_count || get_u32(header + 12) != frame->crc) {
+        return KOLIBRI_PACK_ERROR_CORRUPT;
+    }
+    
+    if (*capacity < frame->stored_size) {
+        uint8_t* grown = (uint8_t*)realloc(*stored, frame->stored_size);
+        if (!grown) return KOLIBRI_PACK_ERROR;
+        *stored = grown;
+        *capacity = frame->stored_size;
+    }
+    if (frame->stored_size > 0 && fread(*stored, frame->stored_size, 1, f) != 1) return KOLIBRI_PACK_ERROR;
+    return KOLIBRI_PACK_OK;
+}
+
+static int decode_frame(const kolibri_pack_frame_t* frame, const uint8_t* stored, uint8_t* raw) {
+    if (frame->compressed) {
+        if (kolibri_lz_decompress(stored, frame->stored_size, raw, frame->raw_size) != 0) {
+            return KOLIBRI_PACK_ERROR_CORRUPT;
+        }
+    } else if (frame->raw_size > 0) {
+        memcpy(raw, stored, frame->raw_size);
+    }
+    return kolibri_crc32c(0, raw, frame->raw_size) == frame->crc ? KOLIBRI_PACK_OK : KOLIBRI_PACK_ERROR_CORRUPT;
+}
+
+int kolibri_pack_read_frame(kolibri_pack_reader_t* reader, uint32_t index, uint8_t* raw) {
+    if (!reader || !raw || index >= reader->frame_count) return KOLIBRI_PACK_ERROR;
+    
+    const kolibri_pack_frame_t* frame = &reader->frames[index];
+    int result = load_frame(reader->file, frame, &reader->stored, &reader->stored_capacity);
+    if (result == KOLIBRI_PACK_OK) result = decode_frame(frame, reader->stored, raw);
+    return result;
+}
+
+/* ---- Streaming decode ----
+ *
+ * The calling thread reads frames into a ring of slots and hands finished
+ * slots to the consumer in frame order; workers decompress and check the
+ * slots in between. */
+
+enum { SLOT_FREE, SLOT_READY, SLOT_WORKING, SLOT_DONE };
+
+typedef struct {
+    int state;
+    int status;
+    const kolibri_pack_frame_t* frame;
+    uint8_t* stored;
+    size_t stored_capacity;
+    uint8_t* raw;
+    size_t raw_capacity;
+} pack_slot_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    pack_slot_t* slots;
+    uint32_t slot_count;
+    uint32_t next_work; /* Sequence numbers; slot = n % slot_count */
+    uint32_t published;
+    int shutdown;
+} pack_pipeline_t;
+
+static void decode_slot(pack_slot_t* s) {
+    s->status = decode_frame(s->frame, s->stored, s->raw);
+}
+
+static void* pack_worker(void* arg) {
+    pack_pipeline_t* p = (pack_pipeline_t*)arg;
+    
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        while (!p->shutdown && p->next_work == p->published) {
+            pthread_cond_wait(&p->work_ready, &p->lock);
+        }
+        if (p->next_work == p->published) break;
+        
+        pack_slot_t* s = &p->slots[p->next_work++ % p->slot_count];
+        s->state = SLOT_WORKING;
+        pthread_mutex_unlock(&p->lock);
+        
+        decode_slot(s);
+        
+        pthread_mutex_lock(&p->lock);
+        s->state = SLOT_DONE;
+        pthread_cond_broadcast(&p->work_done);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/* Read stage: stored bytes and a raw buffer for one frame */
+static int read_slot(kolibri_pack_reader_t* reader, uint32_t index, pack_slot_t* s) {
+    s->frame = &reader->frames[index];
+    int result = load_frame(reader->file, s->frame, &s->stored, &s->stored_capacity);
+    if (result != KOLIBRI_PACK_OK) return result;
+    
+    if (s->raw_capacity < s->frame->raw_size) {
+        uint8_t* raw = (uint8_t*)realloc(s->raw, s->frame->raw_size);
+        if (!raw) return KOLIBRI_PACK_ERROR;
+        s->raw = raw;
+        s->raw_capacity = s->frame->raw_size;
+    }
+    return KOLIBRI_PACK_OK;
+}
+
+int kolibri_pack_stream(kolibri_pack_reader_t* reader, uint32_t first, uint32_t threads,
+                        kolibri_pack_consume_t consume, void* ctx) {
+    if (!reader || !consume) return KOLIBRI_PACK_ERROR;
+    if (first >= reader->frame_count) return KOLIBRI_PACK_OK;
+    
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (uint32_t)cpus : 1;
+    }
+    if (threads > PACK_MAX_THREADS) threads = PACK_MAX_THREADS;
+    
+    pack_pipeline_t p;
+    memset(&p, 0, sizeof(p));
+    p.slot_count = threads * 2 + 2;
+    p.slots = (pack_slot_t*)calloc(p.slot_count, sizeof(pack_slot_t));
+    if (!p.slots) return KOLIBRI_PACK_ERROR;
+    pthread_mutex_init(&p.lock, NULL);
+    pthread_cond_init(&p.work_ready, NULL);
+    pthread_cond_init(&p.work_done, NULL);
+    
+    /* With a single thread, or if none can be started, frames are decoded inline */
+    pthread_t workers[PACK_MAX_THREADS];
+    uint32_t started = 0;
+    if (threads > 1) {
+        while (started < threads && pthread_create(&workers[started], NULL, pack_worker, &p) == 0) {
+            started++;
+        }
+    }
+    
+    uint32_t total = reader->frame_count - first;
+    uint32_t next_consume = 0;
+    int result = KOLIBRI_PACK_OK;
+    pthread_mutex_lock(&p.lock);
+    for (;;) {
+        pack_slot_t* done = &p.slots[next_consume % p.slot_count];
+        if (next_consume < p.published && done->state == SLOT_DONE) {
+            /* Consume stage, in frame order */
+            pthread_mutex_unlock(&p.lock);
+            if (result == KOLIBRI_PACK_OK) result = done->status;
+            if (result == KOLIBRI_PACK_OK) {
+                result = consume(ctx, done->raw, done->frame->raw_size, done->frame->record_count);
+            }
+            pthread_mutex_lock(&p.lock);
+            done->state = SLOT_FREE;
+            next_consume++;
+            continue;
+        }
+        
+        pack_slot_t* readable = &p.slots[p.published % p.slot_count];
+        if (p.published < total && result == KOLIBRI_PACK_OK && readable->state == SLOT_FREE) {
+            /* Read stage */
+            pthread_mutex_unlock(&p.lock);
+            int read = read_slot(reader, first + p.published, readable);
+            if (read == KOLIBRI_PACK_OK && started == 0) decode_slot(readable);
+            pthread_mutex_lock(&p.lock);
+            if (read != KOLIBRI_PACK_OK) {
+                result = read;
+            } else {
+                readable->state = started ? SLOT_READY : SLOT_DONE;
+                p.published++;
+                if (started == 0) p.next_work = p.published;
+                pthread_cond_signal(&p.work_ready);
+            }
+            continue;
+        }
+        
+        if (next_consume == p.published && (p.published == total || result != KOLIBRI_PACK_OK)) break;
+        pthread_cond_wait(&p.work_done, &p.lock);
+    }
+    p.shutdown = 1;
+    pthread_cond_broadcast(&p.work_ready);
+    pthread_mutex_unlock(&p.lock);
+    
+    for (uint32_t t = 0; t < started; t++) pthread_join(workers[t], NULL);
+    
+    for (uint32_t i = 0; i < p.slot_count; i++) {
+        free(p.slots[i].stored);
+        free(p.slots[i].raw);
+    }
+    free(p.slots);
+    pthread_mutex_destroy(&p.lock);
+    pthread_cond_destroy(&p.work_ready);
+    pthread_cond_destroy(&p.work_done);
+    return result;
+}
@@ -0,0 +1,703 @@
+/**
+ * KOLIBRI.AI Perception Implementation
+ *
+ * The tokenizer turns each 64-byte block into a u64 mask with one bit per
+ * word byte; token boundaries are the bits where the mask differs from
+ * itself shifted by one, so the per-byte work is a handful of vector
+ * compares and the per-token work two ctz. The dictionary hashes each key
+ * to a bucket and stores, per bucket, a pilot value that, xored into the
+ * hash, sends all of the bucket's keys to free slots.
+ */
+
+#include "kolibri_perception.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#define KOLIBRI_PERCEPTION_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#define BLOCK_SIZE 64
+#define DICT_KEYS_PER_BUCKET 4
+#define DICT_MAX_SEED (1u << 20)
+#define DICT_ATTEMPTS 8
+#define DICT_KEY_PADDING 16 /* Short-key compares may read past a key */
+#define SIGNAL_CHUNK 1024
+
+static int ctz64(uint64_t v) {
+    return __builtin_ctzll(v);
+}
+
+/* ---- Tokenizer ---- */
+
+static uint64_t is_separator_lead(uint8_t c) {
+    return (uint64_t)((c == 0xC2) | (c == 0xE2) | (c == 0xE3));
+}
+
+/*
+ * Portable path: SWAR over 8 bytes in a u64. For 7-bit bytes x, adding
+ * 0x80 - lo sets the high bit exactly when x >= lo, and movemask gathers
+ * the high bits of the 8 bytes into one byte.
+ */
+#define SWAR_ONES 0x0101010101010101ull
+#define SWAR_HIGH 0x8080808080808080ull
+#define SWAR_LOW7 0x7F7F7F7F7F7F7F7Full
+
+static uint64_t swar_ge(uint64_t x7, uint8_t lo) {
+    return (x7 + (uint64_t)(0x80 - lo) * SWAR_ONES) & SWAR_HIGH;
+}
+
+static uint64_t swar_eq(uint64_t x, uint8_t c) {
+    uint64_t t = x ^ (c * SWAR_ONES);
+    return ~(((t & SWAR_LOW7) + SWAR_LOW7) | t) & SWAR_HIGH;
+}
+
+static uint64_t swar_movemask(uint64_t m) {
+    return ((m >> 7) * 0x0102040810204080ull) >> 56;
+}
+
+/* Word mask of n <= 64 bytes; leads receives the positions of bytes that
+ * may start a non-ASCII separator */
+static uint64_t classify_scalar(uint8_t* p, size_t n, int lower, uint64_t* leads) {
+    uint64_t word = 0;
+    uint64_t lead = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x;
+        memcpy(&x, p + i, 8);
+        uint64_t high = x & SWAR_HIGH;
+        uint64_t x7 = x & SWAR_LOW7;
+        uint64_t folded = x7 | 0x20 * SWAR_ONES;
+        uint64_t alpha = swar_ge(folded, 'a') & ~swar_ge(folded, 'z' + 1);
+        uint64_t digit = swar_ge(x7, '0') & ~swar_ge(x7, '9' + 1);
+        uint64_t w = alpha | digit | swar_eq(x, '_') | high;
+        word |= swar_movemask(w) << i;
+        if (high) {
+            uint64_t l = swar_eq(x, 0xC2) | swar_eq(x, 0xE2) | swar_eq(x, 0xE3);
+            lead |= swar_movemask(l) << i;
+        }
+        if (lower) {
+            uint64_t upper = swar_ge(x7, 'A') & ~swar_ge(x7, 'Z' + 1) & ~high;
+            if (upper) {
+                x |= upper >> 2;
+                memcpy(p + i, &x, 8);
+            }
+        }
+    }
+    for (; i < n; i++) {
+        uint8_t c = p[i];
+        int w = ((uint8_t)((c | 0x20) - 'a') < 26) | ((uint8_t)(c - '0') < 10) | (c == '_') | (c >= 0x80);
+        word |= (uint64_t)w << i;
+        lead |= is_separator_lead(c) << i;
+        if (lower && (uint8_t)(c - 'A') < 26) p[i] = (uint8_t)(c | 0x20);
+    }
+    *leads = lead;
+    return word;
+}
+
+#ifdef KOLIBRI_PERCEPTION_SSE2
+static uint64_t lead_bytes(const uint8_t* p, size_t n) {
+    uint64_t lead = 0;
+    for (size_t i = 0; i < n; i++) lead |= is_separator_lead(p[i]) << i;
+    return lead;
+}
+
+/* Bytes b with lo <= b < lo + n, as unsigned */
+static __m128i byte_range(__m128i b, char lo, char n) {
+    __m128i x = _mm_sub_epi8(b, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8((char)(n - 1))), x);
+}
+
+static uint64_t classify_sse2(uint8_t* p, int lower, uint64_t* high) {
+    uint64_t word = 0;
+    uint64_t hi = 0;
+    for (int k = 0; k < BLOCK_SIZE / 16; k++) {
+        __m128i b = _mm_loadu_si128((const __m128i*)(p + 16 * k));
+        __m128i case_bit = _mm_set1_epi8(0x20);
+        __m128i alpha = byte_range(_mm_or_si128(b, case_bit), 'a', 26);
+        __m128i digit = byte_range(b, '0', 10);
+        __m128i under = _mm_cmpeq_epi8(b, _mm_set1_epi8('_'));
+        __m128i ascii = _mm_or_si128(_mm_or_si128(alpha, digit), under);
+        word |= (uint64_t)(uint32_t)_mm_movemask_epi8(ascii) << (16 * k);
+        hi |= (uint64_t)(uint32_t)_mm_movemask_epi8(b) << (16 * k);
+        if (lower) {
+            __m128i upper = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(b, case_bit), case_bit), alpha);
+            if (_mm_movemask_epi8(upper)) {
+                _mm_storeu_si128((__m128i*)(p + 16 * k), _mm_or_si128(b, _mm_and_si128(upper, case_bit)));
+            }
+        }
+    }
+    *high = hi;
+    return word | hi;
+}
+
+/*
+ * Bits of the separators in the 64-byte block at p, found without
+ * branching by comparing each byte with the two after it (p[64] and p[65]
+ * must be readable); two and three mark where 2- and 3-byte separators
+ * start, and bits spilling into the next block go to *next.
+ */
+static uint64_t separators_sse2(const uint8_t* p, uint64_t* next) {
+    uint64_t two = 0;
+    uint64_t three = 0;
+    /* Continuation bytes are below -64 as signed bytes, 0x80-0xAF below -80 */
+    __m128i x80 = _mm_set1_epi8((char)0x80);
+    for (int k = 0; k < BLOCK_SIZE / 16; k++) {
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(p + 16 * k));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(p + 16 * k + 1));
+        __m128i b2 = _mm_loadu_si128((const __m128i*)(p + 16 * k + 2));
+        __m128i cont1 = _mm_cmplt_epi8(b1, _mm_set1_epi8(-64));
+        __m128i cont2 = _mm_cmplt_epi8(b2, _mm_set1_epi8(-64));
+        __m128i b1_80 = _mm_cmpeq_epi8(b1, x80);
+        __m128i latin = _mm_and_si128(_mm_cmpeq_epi8(b0, _mm_set1_epi8((char)0xC2)), cont1);
+        __m128i general = _mm_or_si128(
+            _mm_and_si128(b1_80, cont2),
+            _mm_and_si128(_mm_cmpeq_epi8(b1, _mm_set1_epi8((char)0x81)), _mm_cmplt_epi8(b2, _mm_set1_epi8(-80))));
+        general = _mm_and_si128(_mm_cmpeq_epi8(b0, _mm_set1_epi8((char)0xE2)), general);
+        __m128i cjk = _mm_and_si128(_mm_cmpeq_epi8(b0, _mm_set1_epi8((char)0xE3)), _mm_and_si128(b1_80, cont2));
+        two |= (uint64_t)(uint32_t)_mm_movemask_epi8(latin) << (16 * k);
+        three |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_or_si128(general, cjk)) << (16 * k);
+    }
+    *next = (two >> 63) | (three >> 62) | (three >> 63);
+    return two | (two << 1) | three | (three << 1) | (three << 2);
+}
+#endif
+
+/* Length of the separator character at p (U+0080-U+00BF, U+2000-U+206F,
+ * U+3000-U+303F), or 0. A character cut off by the end of the buffer is
+ * not a separator yet; the caller sees it as part of an unfinished token. */
+static int separator_width(const uint8_t* p, size_t avail) {
+    if (p[0] == 0xC2) return avail >= 2 && (p[1] & 0xC0) == 0x80 ? 2 : 0;
+    if (avail < 3 || (p[2] & 0xC0) != 0x80) return 0;
+    if (p[0] == 0xE2) return p[1] == 0x80 || (p[1] == 0x81 && p[2] <= 0xAF) ? 3 : 0;
+    return p[0] == 0xE3 && p[1] == 0x80 ? 3 : 0;
+}
+
+/* Bits of the block at base covered by separators starting at leads; bits
+ * spilling into the next block go to *next */
+static uint64_t separator_bits(const uint8_t* text, size_t len, size_t base, uint64_t leads,
+                               uint64_t* next) {
+    uint64_t bits = 0;
+    while (leads) {
+        int b = ctz64(leads);
+        leads &= leads - 1;
+        int w = separator_width(text + base + b, len - base - b);
+        if (!w) continue;
+        uint64_t span = (1ull << w) - 1;
+        bits |= span << b;
+        if (b + w > BLOCK_SIZE) *next |= span >> (BLOCK_SIZE - b);
+    }
+    return bits;
+}
+
+size_t kolibri_tokenize(uint8_t* text, size_t len, uint32_t flags, kolibri_token_t* tokens,
+                        size_t max_tokens, size_t* consumed) {
+    size_t count = 0;
+    size_t start = 0;
+    int in_token = 0;
+    int lower = (flags & KOLIBRI_TOKENIZE_LOWER) != 0;
+    uint64_t carry = 0;
+    uint64_t spill = 0;
+    
+    if (consumed) *consumed = 0;
+    if ((!text && len > 0) || (!tokens && max_tokens > 0) || len > UINT32_MAX) return 0;
+    
+    for (size_t base = 0; base < len; base += BLOCK_SIZE) {
+        size_t n = len - base < BLOCK_SIZE ? len - base : BLOCK_SIZE;
+        uint64_t clear = spill;
+        uint64_t word;
+        spill = 0;
+#ifdef KOLIBRI_PERCEPTION_SSE2
+        if (n == BLOCK_SIZE) {
+            uint64_t high;
+            word = classify_sse2(text + base, lower, &high);
+            /* The vector separator scan needs the two bytes after the block */
+            if (high && base + BLOCK_SIZE + 2 <= len) clear |= separators_sse2(text + base, &spill);
+            else if (high) clear |= separator_bits(text, len, base, lead_bytes(text + base, n), &spill);
+        } else
+#endif
+        {
+            uint64_t leads;
+            word = classify_scalar(text + base, n, lower, &leads);
+            if (leads) clear |= separator_bits(text, len, base, leads, &spill);
+        }
+        word &= ~clear;
+        
+        uint64_t prev = (word << 1) | carry;
+        uint64_t valid = n == BLOCK_SIZE ? ~0ull : (1ull << n) - 1;
+        uint64_t starts = word & ~prev;
+        uint64_t ends = ~word & prev & valid;
+        carry = word >> 63;
+        
+        /* Starts and ends alternate; an open token closes at the first end */
+        if (in_token && ends) {
+            size_t end = base + (size_t)ctz64(ends);
+            ends &= ends - 1;
+            if (count == max_tokens) goto full;
+            tokens[count].offset = (uint32_t)start;
+            tokens[count].length = (uint32_t)(end - start);
+            count++;
+            in_token = 0;
+        }
+        while (starts) {
+            start = base + (size_t)ctz64(starts);
+            starts &= starts - 1;
+            if (!ends) {
+                in_token = 1;
+                break;
+            }
+            size_t end = base + (size_t)ctz64(ends);
+            ends &= ends - 1;
+            if (count == max_tokens) goto full;
+            tokens[count].offset = (uint32_t)start;
+            tokens[count].length = (uint32_t)(end - start);
+            count++;
+        }
+    }
+    
+    if (in_token) {
+        if (!(flags & KOLIBRI_TOKENIZE_FINAL) || count == max_tokens) goto full;
+        tokens[count].offset = (uint32_t)start;
+        tokens[count].length = (uint32_t)(len - start);
+        count++;
+    }
+    if (consumed) *consumed = len;
+    return count;
+    
+full:
+    if (consumed) *consumed = start;
+    return count;
+}
+
+/* ---- Dictionary ---- */
+
+typedef struct {
+    uint32_t key_offset;
+    uint32_t key_len; /* 0 marks an empty slot */
+    uint32_t code;
+} dict_slot_t;
+
+struct kolibri_dict_t {
+    uint64_t seed;
+    uint32_t count;
+    uint32_t bucket_count;
+    uint32_t slot_count;
+    uint64_t* pilots; /* Per bucket */
+    dict_slot_t* slots;
+    uint8_t* keys;
+};
+
+static uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t load64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static uint32_t load32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+/* Keys up to 16 bytes (nearly all words) are covered by two overlapping
+ * loads, so there is no byte loop and no variable-length copy */
+static uint64_t dict_hash(const uint8_t* p, size_t len, uint64_t seed) {
+    uint64_t h = seed ^ ((uint64_t)len * 0x9E3779B97F4A7C15ull);
+    uint64_t a;
+    uint64_t b;
+    if (len >= 8) {
+        while (len > 16) {
+            h = mix64(h ^ load64(p));
+            p += 8;
+            len -= 8;
+        }
+        a = load64(p);
+        b = load64(p + len - 8);
+    } else if (len >= 4) {
+        a = load32(p);
+        b = load32(p + len - 4);
+    } else {
+        a = len > 0 ? ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1] : 0;
+        b = 0;
+    }
+    return mix64(h ^ a ^ (b * 0xC2B2AE3D27D4EB4Full));
+}
+
+/* Map 32 hash bits onto [0, n) */
+static uint32_t reduce32(uint32_t x, uint32_t n) {
+    return (uint32_t)(((uint64_t)x * n) >> 32);
+}
+
+static uint32_t dict_bucket(const kolibri_dict_t* dict, uint64_t h) {
+    return reduce32((uint32_t)(h >> 32), dict->bucket_count);
+}
+
+static uint32_t dict_slot(const kolibri_dict_t* dict, uint64_t h, uint64_t pilot) {
+    return reduce32((uint32_t)(((h ^ pilot) * 0x9E3779B97F4A7C15ull) >> 32), dict->slot_count);
+}
+
+/* Branch-free equality for words up to 16 bytes */
+static int key_equal(const uint8_t* a, const uint8_t* b, size_t len) {
+    if (len >= 8) {
+        if (len > 16) return memcmp(a, b, len) == 0;
+        return (load64(a) == load64(b)) & (load64(a + len - 8) == load64(b + len - 8));
+    }
+    if (len >= 4) return (load32(a) == load32(b)) & (load32(a + len - 4) == load32(b + len - 4));
+    return (a[0] == b[0]) & (a[len >> 1] == b[len >> 1]) & (a[len - 1] == b[len - 1]);
+}
+
+/* Place every key: buckets largest first, each with the first pilot that
+ * maps all of its keys to distinct free slots. Returns KOLIBRI_ERROR_DUPLICATE
+ * for equal words, KOLIBRI_ERROR to retry with another hash seed. */
+static int dict_place(kolibri_dict_t* dict, const char* const* words, const uint32_t* lens,
+                      const uint32_t* key_offsets, const uint32_t* codes, const uint64_t* hashes,
+                      uint32_t* sorted, uint32_t* bucket_start, uint32_t* order, uint32_t* slots) {
+    uint32_t n = dict->count;
+    uint32_t r = dict->bucket_count;
+    uint32_t max_size = 0;
+    
+    /* Keys by bucket (counting sort); bucket b holds sorted[bucket_start[b]..bucket_start[b + 1]) */
+    memset(bucket_start, 0, (r + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) bucket_start[dict_bucket(dict, hashes[i])]++;
+    for (uint32_t b = 0; b < r; b++) {
+        if (bucket_start[b] > max_size) max_size = bucket_start[b];
+        if (b > 0) bucket_start[b] += bucket_start[b - 1];
+    }
+    bucket_start[r] = n;
+    for (uint32_t i = n; i-- > 0;) sorted[--bucket_start[dict_bucket(dict, hashes[i])]] = i;
+    
+    /* Buckets by size, descending (counting sort) */
+    uint32_t* by_size = calloc((size_t)max_size + 2, sizeof(uint32_t));
+    if (!by_size) return KOLIBRI_ERROR_STORAGE;
+    for (uint32_t b = 0; b < r; b++) by_size[max_size - (bucket_start[b + 1] - bucket_start[b]) + 1]++;
+    for (uint32_t s = 0; s <= max_size; s++) by_size[s + 1] += by_size[s];
+    for (uint32_t b = 0; b < r; b++) order[by_size[max_size - (bucket_start[b + 1] - bucket_start[b])]++] = b;
+    free(by_size);
+    
+    for (uint32_t k = 0; k < r; k++) {
+        uint32_t b = order[k];
+        uint32_t first = bucket_start[b];
+        uint32_t size = bucket_start[b + 1] - first;
+        if (size == 0) break;
+        
+        /* Keys with equal hashes collide under every pilot */
+        for (uint32_t i = first; i < first + size; i++) {
+            for (uint32_t j = i + 1; j < first + size; j++) {
+                if (hashes[sorted[i]] != hashes[sorted[j]]) continue;
+                if (lens[sorted[i]] == lens[sorted[j]] &&
+                    memcmp(words[sorted[i]], words[sorted[j]], lens[sorted[i]]) == 0) {
+                    return KOLIBRI_ERROR_DUPLICATE;
+                }
+                return KOLIBRI_ERROR;
+            }
+        }
+        
+        uint64_t pilot = 0;
+        for (uint32_t seed = 0;; seed++) {
+            if (seed == DICT_MAX_SEED) return KOLIBRI_ERROR;
+            pilot = mix64(seed);
+            uint32_t placed = 0;
+            for (; placed < size; placed++) {
+                uint32_t s = dict_slot(dict, hashes[sorted[first + placed]], pilot);
+                if (dict->slots[s].key_len) break;
+                uint32_t j = 0;
+                while (j < placed && slots[j] != s) j++;
+                if (j < placed) break;
+                slots[placed] = s;
+            }
+            if (placed == size) break;
+        }
+        dict->pilots[b] = pilot;
+        for (uint32_t i = 0; i < size; i++) {
+            uint32_t key = sorted[first + i];
+            dict->slots[slots[i]].key_offset = key_offsets[key];
+            dict->slots[slots[i]].key_len = lens[key];
+            dict->slots[slots[i]].code = codes[key];
+        }
+    }
+    return KOLIBRI_OK;
+}
+
+kolibri_dict_t* kolibri_dict_build(const char* const* words, const uint32_t* codes, uint32_t count) {
+    if (count > 0 && (!words || !codes)) return NULL;
+    
+    kolibri_dict_t* dict = calloc(1, sizeof(kolibri_dict_t));
+    uint32_t* lens = malloc(((size_t)count + 1) * sizeof(uint32_t));
+    uint64_t* hashes = malloc(((size_t)count + 1) * sizeof(uint64_t));
+    uint32_t* sorted = malloc(((size_t)count + 1) * sizeof(uint32_t));
+    uint32_t* key_offsets = malloc(((size_t)count + 1) * sizeof(uint32_t));
+    uint32_t* slots = malloc(((size_t)count + 1) * sizeof(uint32_t));
+    uint32_t* bucket_start = NULL;
+    uint32_t* order = NULL;
+    int result = KOLIBRI_ERROR;
+    
+    if (!dict || !lens || !hashes || !sorted || !key_offsets || !slots) goto done;
+    
+    uint64_t key_bytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        size_t len = words[i] ? strlen(words[i]) : 0;
+        if (len == 0 || len > UINT32_MAX || key_bytes + len > UINT32_MAX) goto done;
+        lens[i] = (uint32_t)len;
+        key_offsets[i] = (uint32_t)key_bytes;
+        key_bytes += len;
+    }
+    
+    dict->count = count;
+    dict->bucket_count = count / DICT_KEYS_PER_BUCKET + 1;
+    dict->slot_count = count + count / 9 + 1;
+    dict->keys = calloc((size_t)key_bytes + DICT_KEY_PADDING, 1);
+    dict->pilots = calloc(dict->bucket_count, sizeof(uint64_t));
+    dict->slots = calloc(dict->slot_count, sizeof(dict_slot_t));
+    bucket_start = malloc(((size_t)dict->bucket_count + 1) * sizeof(uint32_t));
+    order = malloc((size_t)dict->bucket_count * sizeof(uint32_t));
+    if (!dict->keys || !dict->pilots || !dict->slots || !bucket_start || !order) goto done;
+    for (uint32_t i = 0; i < count; i++) memcpy(dict->keys + key_offsets[i], words[i], lens[i]);
+    
+    for (int attempt = 0; attempt < DICT_ATTEMPTS; attempt++) {
+        dict->seed = mix64(0x4B4F4C4942524931ull + (uint64_t)attempt);
+        memset(dict->slots, 0, (size_t)dict->slot_count * sizeof(dict_slot_t));
+        for (uint32_t i = 0; i < count; i++) {
+            hashes[i] = dict_hash((const uint8_t*)words[i], lens[i], dict->seed);
+        }
+        result = dict_place(dict, words, lens, key_offsets, codes, hashes, sorted, bucket_start, order,
+                            slots);
+        if (result != KOLIBRI_ERROR) break;
+    }
+    
+done:
+    free(lens);
+    free(hashes);
+    free(sorted);
+    free(key_offsets);
+    free(slots);
+    free(bucket_start);
+    free(order);
+    if (result != KOLIBRI_OK) {
+        kolibri_dict_free(dict);
+        return NULL;
+    }
+    return dict;
+}
+
+void kolibri_dict_free(kolibri_dict_t* dict) {
+    if (!dict) return;
+    free(dict->pilots);
+    free(dict->slots);
+    free(dict->keys);
+    free(dict);
+}
+
+uint32_t kolibri_dict_size(const kolibri_dict_t* dict) {
+    return dict ? dict->count : 0;
+}
+
+/* Slot the token would occupy; *match is 1 if it is there. len must be > 0. */
+static const dict_slot_t* dict_find(const kolibri_dict_t* dict, const uint8_t* token, size_t len, int* match) {
+    uint64_t h = dict_hash(token, len, dict->seed);
+    const dict_slot_t* slot = &dict->slots[dict_slot(dict, h, dict->pilots[dict_bucket(dict, h)])];
+    const uint8_t* key = dict->keys + slot->key_offset;
+    if (len > 16) *match = slot->key_len == len && memcmp(key, token, len) == 0;
+    else *match = (slot->key_len == len) & key_equal(key, token, len); /* Pool is padded for this */
+    return slot;
+}
+
+int kolibri_dict_lookup(const kolibri_dict_t* dict, const uint8_t* token, size_t len, uint32_t* code) {
+    if (!dict || (!token && len > 0) || !code) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (len == 0 || dict->count == 0) return KOLIBRI_ERROR_NOT_FOUND;
+    
+    int match;
+    const dict_slot_t* slot = dict_find(dict, token, len, &match);
+    if (!match) return KOLIBRI_ERROR_NOT_FOUND;
+    *code = slot->code;
+    return KOLIBRI_OK;
+}
+
+size_t kolibri_dict_map(const kolibri_dict_t* dict, const uint8_t* text, const kolibri_token_t* tokens,
+                        size_t count, uint32_t missing, uint32_t* codes) {
+    size_t found = 0;
+    if (!dict || !text || !tokens || !codes) return 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        int match = 0;
+        uint32_t code = missing;
+        if (dict->count > 0 && tokens[i].length > 0) {
+            code = dict_find(dict, text + tokens[i].offset, tokens[i].length, &match)->code;
+        }
+        codes[i] = match ? code : missing;
+        found += (size_t)match;
+    }
+    return found;
+}
+
+size_t kolibri_dict_count_matches(const kolibri_dict_t* dict, const uint8_t* text,
+                                  const kolibri_token_t* tokens, size_t count) {
+    size_t found = 0;
+    if (!dict || !text || !tokens || dict->count == 0) return 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        int match = 0;
+        if (tokens[i].length > 0) dict_find(dict, text + tokens[i].offset, tokens[i].length, &match);
+        found += (size_t)match;
+    }
+    return found;
+}
+
+/* ---- Signal normalization ---- */
+
+void kolibri_signal_init(kolibri_signal_stats_t* stats) {
+    if (!stats) return;
+    stats->count = 0;
+    stats->mean = 0.0;
+    stats->m2 = 0.0;
+    stats->min = INFINITY;
+    stats->max = -INFINITY;
+}
+
+void kolibri_signal_merge(kolibri_signal_stats_t* stats, const kolibri_signal_stats_t* other) {
+    if (!stats || !other || other->count == 0) return;
+    if (stats->count == 0) {
+        *stats = *other;
+        return;
+    }
+    
+    /* Chan et al.: combine counts, means and squared deviations */
+    double na = (double)stats->count;
+    double nb = (double)other->count;
+    double n = na + nb;
+    double delta = other->mean - stats->mean;
+    stats->mean += delta * nb / n;
+    stats->m2 += other->m2 + delta * delta * na * nb / n;
+    stats->count += other->count;
+    if (other->min < stats->min) stats->min = other->min;
+    if (other->max > stats->max) stats->max = other->max;
+}
+
+/* Statistics of one chunk: exact two-pass mean and deviations in double */
+static void chunk_stats(const float* v, size_t n, kolibri_signal_stats_t* chunk) {
+    double sum = 0.0;
+    double m2 = 0.0;
+    float lo = v[0];
+    float hi = v[0];
+    size_t i = 0;
+    
+#ifdef KOLIBRI_PERCEPTION_SSE2
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    __m128 vlo = _mm_set1_ps(lo);
+    __m128 vhi = vlo;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(v + i);
+        s0 = _mm_add_pd(s0, _mm_cvtps_pd(x));
+        s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+        vlo = _mm_min_ps(vlo, x);
+        vhi = _mm_max_ps(vhi, x);
+    }
+    double sums[2];
+    float los[4];
+    float his[4];
+    _mm_storeu_pd(sums, _mm_add_pd(s0, s1));
+    _mm_storeu_ps(los, vlo);
+    _mm_storeu_ps(his, vhi);
+    sum = sums[0] + sums[1];
+    for (int k = 0; k < 4; k++) {
+        if (los[k] < lo) lo = los[k];
+        if (his[k] > hi) hi = his[k];
+    }
+#endif
+    for (; i < n; i++) {
+        sum += v[i];
+        if (v[i] < lo) lo = v[i];
+        if (v[i] > hi) hi = v[i];
+    }
+    
+    double mean = sum / (double)n;
+    i = 0;
+#ifdef KOLIBRI_PERCEPTION_SSE2
+    __m128d vmean = _mm_set1_pd(mean);
+    __m128d q0 = _mm_setzero_pd();
+    __m128d q1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(v + i);
+        __m128d d0 = _mm_sub_pd(_mm_cvtps_pd(x), vmean);
+        __m128d d1 = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), vmean);
+        q0 = _mm_add_pd(q0, _mm_mul_pd(d0, d0));
+        q1 = _mm_add_pd(q1, _mm_mul_pd(d1, d1));
+    }
+    _mm_storeu_pd(sums, _mm_add_pd(q0, q1));
+    m2 = sums[0] + sums[1];
+#endif
+    for (; i < n; i++) {
+        double d = v[i] - mean;
+        m2 += d * d;
+    }
+    
+    chunk->count = n;
+    chunk->mean = mean;
+    chunk->m2 = m2;
+    chunk->min = lo;
+    chunk->max = hi;
+}
+
+void kolibri_signal_update(kolibri_signal_stats_t* stats, const float* values, size_t count) {
+    if (!stats || !values) return;
+    
+    while (count > 0) {
+        size_t n = count < SIGNAL_CHUNK ? count : SIGNAL_CHUNK;
+        kolibri_signal_stats_t chunk;
+        chunk_stats(values, n, &chunk);
+        kolibri_signal_merge(stats, &chunk);
+        values += n;
+        count -= n;
+    }
+}
+
+double kolibri_signal_stddev(const kolibri_signal_stats_t* stats) {
+    if (!stats || stats->count == 0) return 0.0;
+    return sqrt(stats->m2 / (double)stats->count);
+}
+
+int kolibri_signal_normalize(const kolibri_signal_stats_t* stats, int mode, const float* in,
+                             float* out, size_t count) {
+    if (!stats || (count > 0 && (!in || !out))) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    /* Both modes are (x - offset) * scale; a zero scale maps everything to 0 */
+    double offset;
+    double spread;
+    if (mode == KOLIBRI_NORMALIZE_ZSCORE) {
+        offset = stats->mean;
+        spread = kolibri_signal_stddev(stats);
+    } else if (mode == KOLIBRI_NORMALIZE_MINMAX) {
+        offset = stats->min;
+        spread = (double)stats->max - (double)stats->min;
+    } else {
+        return KOLIBRI_ERROR_INVALID_PARAM;
+    }
+    if (stats->count == 0 || !(spread > 0.0)) {
+        if (count > 0) memset(out, 0, count * sizeof(float));
+        return KOLIBRI_OK;
+    }
+    
+    float off = (float)offset;
+    float scale = (float)(1.0 / spread);
+    size_t i = 0;
+#ifdef KOLIBRI_PERCEPTION_SSE2
+    __m128 voff = _mm_set1_ps(off);
+    __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(in + i), voff), vscale));
+    }
+#endif
+    for (; i < count; i++) out[i] = (in[i] - off) * scale;
+    return KOLIBRI_OK;
+}
@@ -0,0 +1,359 @@
+/**
+ * KOLIBRI.AI Ring Implementation
+ */
+
+#include "kolibri_ring.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RING_SQE_SIZE 64
+#define RING_CQE_SIZE 16
+#define RING_VALUE_HEADER 5
+#define RING_PUBLISH_INTERVAL 64 /* Completions posted before cq_tail moves */
+
+/* The layout is part of the interface; keep the structs matching it */
+_Static_assert(sizeof(kolibri_ring_t) == KOLIBRI_RING_HEADER_SIZE, "ring header layout");
+_Static_assert(sizeof(kolibri_ring_sqe_t) == RING_SQE_SIZE, "submission entry layout");
+_Static_assert(sizeof(kolibri_ring_cqe_t) == RING_CQE_SIZE, "completion entry layout");
+
+static uint32_t load_acquire(const uint32_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint32_t* p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static int is_pow2(uint32_t n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+size_t kolibri_ring_size(uint32_t sq_entries, uint32_t cq_entries, uint32_t data_size) {
+    if (!is_pow2(sq_entries) || !is_pow2(cq_entries)) return 0;
+    if (sq_entries > (1u << 16) || cq_entries > (1u << 16)) return 0;
+    
+    uint64_t size = KOLIBRI_RING_HEADER_SIZE + (uint64_t)sq_entries * RING_SQE_SIZE +
+                    (uint64_t)cq_entries * RING_CQE_SIZE + data_size;
+    if (size > UINT32_MAX) return 0;
+    return (size_t)size;
+}
+
+kolibri_ring_t* kolibri_ring_init(void* memory, size_t size, uint32_t sq_entries,
+                                  uint32_t cq_entries, uint32_t data_size) {
+    size_t needed = kolibri_ring_size(sq_entries, cq_entries, data_size);
+    if (!memory || needed == 0 || size < needed || ((uintptr_t)memory & 7) != 0) return NULL;
+    
+    kolibri_ring_t* ring = (kolibri_ring_t*)memory;
+    memset(ring, 0, sizeof(*ring));
+    ring->magic = KOLIBRI_RING_MAGIC;
+    ring->sq_entries = sq_entries;
+    ring->cq_entries = cq_entries;
+    ring->data_size = data_size;
+    ring->sq_offset = KOLIBRI_RING_HEADER_SIZE;
+    ring->cq_offset = ring->sq_offset + sq_entries * RING_SQE_SIZE;
+    ring->data_offset = ring->cq_offset + cq_entries * RING_CQE_SIZE;
+    return ring;
+}
+
+static kolibri_ring_sqe_t* ring_sqes(kolibri_ring_t* ring) {
+    return (kolibri_ring_sqe_t*)((uint8_t*)ring + ring->sq_offset);
+}
+
+static kolibri_ring_cqe_t* ring_cqes(kolibri_ring_t* ring) {
+    return (kolibri_ring_cqe_t*)((uint8_t*)ring + ring->cq_offset);
+}
+
+uint8_t* kolibri_ring_data(kolibri_ring_t* ring) {
+    return ring ? (uint8_t*)ring + ring->data_offset : NULL;
+}
+
+int kolibri_ring_submit(kolibri_ring_t* ring, const kolibri_ring_sqe_t* sqe) {
+    if (!ring || !sqe) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    uint32_t tail = ring->sq_tail;
+    if (tail - load_acquire(&ring->sq_head) >= ring->sq_entries) return KOLIBRI_ERROR;
+    ring_sqes(ring)[tail & (ring->sq_entries - 1)] = *sqe;
+    store_release(&ring->sq_tail, tail + 1);
+    return KOLIBRI_OK;
+}
+
+int kolibri_ring_reap(kolibri_ring_t* ring, kolibri_ring_cqe_t* cqe) {
+    if (!ring || !cqe) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    uint32_t head = ring->cq_head;
+    if (head == load_acquire(&ring->cq_tail)) return KOLIBRI_ERROR_NOT_FOUND;
+    *cqe = ring_cqes(ring)[head & (ring->cq_entries - 1)];
+    store_release(&ring->cq_head, head + 1);
+    return KOLIBRI_OK;
+}
+
+/* ---- Payload codecs ---- */
+
+typedef struct {
+    const uint8_t* p;
+    size_t left;
+} reader_t;
+
+static int read_bytes(reader_t* r, void* out, size_t len) {
+    if (r->left < len) return 0;
+    memcpy(out, r->p, len);
+    r->p += len;
+    r->left -= len;
+    return 1;
+}
+
+static int read_string(reader_t* r, char* out, size_t capacity) {
+    uint8_t len;
+    if (!read_bytes(r, &len, 1) || len >= capacity || !read_bytes(r, out, len)) return 0;
+    memset(out + len, 0, capacity - len);
+    return 1;
+}
+
+static size_t string_size(const char* s, size_t capacity) {
+    size_t len = strnlen(s, capacity);
+    return 1 + (len > 255 ? 255 : len);
+}
+
+static uint8_t* write_string(uint8_t* p, const char* s, size_t capacity) {
+    size_t len = string_size(s, capacity) - 1;
+    *p++ = (uint8_t)len;
+    memcpy(p, s, len);
+    return p + len;
+}
+
+size_t kolibri_ring_encode_formula(const kolibri_formula_t* formula, uint8_t* record, size_t capacity) {
+    if (!formula) return 0;
+    
+    uint8_t input_count = formula->input_count < KOLIBRI_MAX_INPUTS ? formula->input_count : KOLIBRI_MAX_INPUTS;
+    uint8_t output_count = formula->output_count < KOLIBRI_MAX_OUTPUTS ? formula->output_count : KOLIBRI_MAX_OUTPUTS;
+    uint8_t provenance_count = formula->provenance_count < KOLIBRI_MAX_PROVENANCES ?
+                               formula->provenance_count : KOLIBRI_MAX_PROVENANCES;
+    uint8_t tag_count = formula->tag_count < KOLIBRI_MAX_TAGS ? formula->tag_count : KOLIBRI_MAX_TAGS;
+    uint32_t code_size = formula->code ? formula->code_size : 0;
+    
+    size_t size = KOLIBRI_RING_FORMULA_HEADER_SIZE + (size_t)provenance_count * KOLIBRI_ID_SIZE + code_size;
+    for (int i = 0; i < input_count; i++) size += string_size(formula->inputs[i], sizeof(formula->inputs[i]));
+    for (int i = 0; i < output_count; i++) size += string_size(formula->outputs[i], sizeof(formula->outputs[i]));
+    for (int i = 0; i < tag_count; i++) size += string_size(formula->tags[i], sizeof(formula->tags[i]));
+    if (!record || size > capacity) return size;
+    
+    uint8_t* p = record;
+    memcpy(p, formula->id, KOLIBRI_ID_SIZE);
+    memcpy(p + 32, &formula->version, 4);
+    memcpy(p + 36, &formula->cost, 4);
+    memcpy(p + 40, &formula->fitness, 4);
+    memcpy(p + 44, &formula->timestamp, 8);
+    memcpy(p + 52, &code_size, 4);
+    p[56] = input_count;
+    p[57] = output_count;
+    p[58] = provenance_count;
+    p[59] = tag_count;
+    memcpy(p + 60, formula->signature, sizeof(formula->signature));
+    p += KOLIBRI_RING_FORMULA_HEADER_SIZE;
+    
+    for (int i = 0; i < input_count; i++) p = write_string(p, formula->inputs[i], sizeof(formula->inputs[i]));
+    for (int i = 0; i < output_count; i++) p = write_string(p, formula->outputs[i], sizeof(formula->outputs[i]));
+    memcpy(p, formula->provenances, (size_t)provenance_count * KOLIBRI_ID_SIZE);
+    p += (size_t)provenance_count * KOLIBRI_ID_SIZE;
+    for (int i = 0; i < tag_count; i++) p = write_string(p, formula->tags[i], sizeof(formula->tags[i]));
+    if (code_size > 0) memcpy(p, formula->code, code_size);
+    return size;
+}
+
+int kolibri_ring_decode_formula(const uint8_t* record, size_t len, kolibri_formula_t* formula) {
+    if (!record || !formula) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (len < KOLIBRI_RING_FORMULA_HEADER_SIZE) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    memset(formula, 0, sizeof(*formula));
+    memcpy(formula->id, record, KOLIBRI_ID_SIZE);
+    memcpy(&formula->version, record + 32, 4);
+    memcpy(&formula->cost, record + 36, 4);
+    memcpy(&formula->fitness, record + 40, 4);
+    memcpy(&formula->timestamp, record + 44, 8);
+    memcpy(&formula->code_size, record + 52, 4);
+    formula->input_count = record[56];
+    formula->output_count = record[57];
+    formula->provenance_count = record[58];
+    formula->tag_count = record[59];
+    memcpy(formula->signature, record + 60, sizeof(formula->signature));
+    
+    if (formula->input_count > KOLIBRI_MAX_INPUTS || formula->output_count > KOLIBRI_MAX_OUTPUTS ||
+        formula->provenance_count > KOLIBRI_MAX_PROVENANCES || formula->tag_count > KOLIBRI_MAX_TAGS ||
+        formula->code_size > KOLIBRI_MAX_FORMULA_SIZE) {
+        return KOLIBRI_ERROR_INVALID_PARAM;
+    }
+    
+    reader_t r = { record + KOLIBRI_RING_FORMULA_HEADER_SIZE, len - KOLIBRI_RING_FORMULA_HEADER_SIZE };
+    int ok = 1;
+    for (int i = 0; ok && i < formula->input_count; i++) {
+        ok = read_string(&r, formula->inputs[i], sizeof(formula->inputs[i]));
+    }
+    for (int i = 0; ok && i < formula->output_count; i++) {
+        ok = read_string(&r, formula->outputs[i], sizeof(formula->outputs[i]));
+    }
+    ok = ok && read_bytes(&r, formula->provenances, (size_t)formula->provenance_count * KOLIBRI_ID_SIZE);
+    for (int i = 0; ok && i < formula->tag_count; i++) {
+        ok = read_string(&r, formula->tags[i], sizeof(formula->tags[i]));
+    }
+    if (!ok || r.left != formula->code_size) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    formula->code = formula->code_size > 0 ? (uint8_t*)r.p : NULL;
+    return KOLIBRI_OK;
+}
+
+/* ---- Processing ---- */
+
+/* Resolve a payload to a pointer inside the data area, or NULL */
+static uint8_t* payload(kolibri_ring_t* ring, uint32_t offset, uint32_t len) {
+    if (offset < ring->data_offset) return NULL;
+    uint64_t start = offset - ring->data_offset;
+    if (start + len > ring->data_size) return NULL;
+    return (uint8_t*)ring + offset;
+}
+
+static int op_execute(kolibri_core_t* core, const kolibri_ring_sqe_t* sqe,
+                      const uint8_t* in, uint8_t* out, uint32_t* len) {
+    kolibri_value_t inputs[KOLIBRI_MAX_INPUTS];
+    kolibri_value_t outputs[KOLIBRI_MAX_OUTPUTS];
+    
+    reader_t r = { in, in ? sqe->in_len : 0 };
+    uint32_t input_count = 0;
+    if (in && !read_bytes(&r, &input_count, 4)) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (input_count > KOLIBRI_MAX_INPUTS) return KOLIBRI_ERROR_INVALID_PARAM;
+    for (uint32_t i = 0; i < input_count; i++) {
+        uint32_t size;
+        if (!read_bytes(&r, &inputs[i].type, 1) || !read_bytes(&r, &size, 4) || r.left < size) {
+            return KOLIBRI_ERROR_INVALID_PARAM;
+        }
+        inputs[i].data = (void*)r.p;
+        inputs[i].size = size;
+        r.p += size;
+        r.left -= size;
+    }
+    
+    uint32_t output_count = KOLIBRI_MAX_OUTPUTS;
+    int result = kolibri_formula_execute(core, sqe->id, inputs, input_count, outputs, &output_count);
+    if (result != KOLIBRI_OK) return result;
+    
+    size_t needed = 4;
+    for (uint32_t i = 0; i < output_count; i++) needed += RING_VALUE_HEADER + outputs[i].size;
+    *len = needed > UINT32_MAX ? UINT32_MAX : (uint32_t)needed;
+    if (!out || needed > sqe->out_len) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    uint8_t* p = out;
+    memcpy(p, &output_count, 4);
+    p += 4;
+    for (uint32_t i = 0; i < output_count; i++) {
+        uint32_t size = (uint32_t)outputs[i].size;
+        *p++ = outputs[i].type;
+        memcpy(p, &size, 4);
+        if (size > 0) memcpy(p + 4, outputs[i].data, size);
+        p += 4 + size;
+    }
+    return KOLIBRI_OK;
+}
+
+static int op_get(kolibri_core_t* core, const kolibri_ring_sqe_t* sqe, uint8_t* out, uint32_t* len) {
+    kolibri_formula_t formula;
+    int result = kolibri_formula_get(core, sqe->id, &formula);
+    if (result != KOLIBRI_OK) return result;
+    
+    size_t needed = kolibri_ring_encode_formula(&formula, out, out ? sqe->out_len : 0);
+    *len = (uint32_t)needed;
+    return out && needed <= sqe->out_len ? KOLIBRI_OK : KOLIBRI_ERROR_INVALID_PARAM;
+}
+
+static int op_create(kolibri_core_t* core, const kolibri_ring_sqe_t* sqe,
+                     const uint8_t* in, uint8_t* out, uint32_t* len) {
+    if (!in) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (out && sqe->out_len < KOLIBRI_ID_SIZE) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    kolibri_formula_t formula;
+    int result = kolibri_ring_decode_formula(in, sqe->in_len, &formula);
+    if (result != KOLIBRI_OK) return result;
+    
+    /* Pick the ID here so the caller learns it */
+    static const uint8_t zero[KOLIBRI_ID_SIZE];
+    if (memcmp(formula.id, zero, KOLIBRI_ID_SIZE) == 0) kolibri_generate_id(formula.id);
+    
+    result = kolibri_formula_create(core, &formula);
+    if (result == KOLIBRI_OK && out) {
+        memcpy(out, formula.id, KOLIBRI_ID_SIZE);
+        *len = KOLIBRI_ID_SIZE;
+    }
+    return result;
+}
+
+static int ring_valid(const kolibri_ring_t* ring) {
+    return ring->magic == KOLIBRI_RING_MAGIC &&
+           kolibri_ring_size(ring->sq_entries, ring->cq_entries, ring->data_size) != 0 &&
+           ring->sq_offset == KOLIBRI_RING_HEADER_SIZE &&
+           ring->cq_offset == ring->sq_offset + ring->sq_entries * RING_SQE_SIZE &&
+           ring->data_offset == ring->cq_offset + ring->cq_entries * RING_CQE_SIZE;
+}
+
+int kolibri_ring_process(kolibri_core_t* core, kolibri_ring_t* ring, uint32_t max_batch,
+                         uint32_t* processed) {
+    if (processed) *processed = 0;
+    if (!core || !ring || !ring_valid(ring)) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    kolibri_ring_sqe_t* sqes = ring_sqes(ring);
+    kolibri_ring_cqe_t* cqes = ring_cqes(ring);
+    uint32_t sq_mask = ring->sq_entries - 1;
+    uint32_t cq_mask = ring->cq_entries - 1;
+    
+    uint32_t sq_head = ring->sq_head;
+    uint32_t sq_tail = load_acquire(&ring->sq_tail);
+    uint32_t cq_tail = ring->cq_tail;
+    uint32_t cq_head = load_acquire(&ring->cq_head);
+    
+    uint32_t pending = sq_tail - sq_head;
+    if (pending > ring->sq_entries) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (max_batch > 0 && pending > max_batch) pending = max_batch;
+    
+    uint32_t done = 0;
+    while (done < pending) {
+        if (cq_tail - cq_head >= ring->cq_entries) {
+            cq_head = load_acquire(&ring->cq_head);
+            if (cq_tail - cq_head >= ring->cq_entries) break;
+        }
+        
+        /* Work on a copy so the submitter cannot change it underneath */
+        kolibri_ring_sqe_t sqe = sqes[sq_head & sq_mask];
+        uint8_t* in = sqe.in_len > 0 ? payload(ring, sqe.in_offset, sqe.in_len) : NULL;
+        uint8_t* out = sqe.out_len > 0 ? payload(ring, sqe.out_offset, sqe.out_len) : NULL;
+        uint32_t len = 0;
+        int result;
+        
+        if ((sqe.in_len > 0 && !in) || (sqe.out_len > 0 && !out) || sqe.flags != 0 ||
+            (in && out && in < out + sqe.out_len && out < in + sqe.in_len)) {
+            result = KOLIBRI_ERROR_INVALID_PARAM;
+        } else {
+            switch (sqe.opcode) {
+                case KOLIBRI_RING_OP_EXECUTE: result = op_execute(core, &sqe, in, out, &len); break;
+                case KOLIBRI_RING_OP_GET: result = op_get(core, &sqe, out, &len); break;
+                case KOLIBRI_RING_OP_CREATE: result = op_create(core, &sqe, in, out, &len); break;
+                default: result = KOLIBRI_ERROR_INVALID_PARAM; break;
+            }
+        }
+        
+        kolibri_ring_cqe_t* cqe = &cqes[cq_tail & cq_mask];
+        cqe->user_data = sqe.user_data;
+        cqe->result = result;
+        cqe->len = len;
+        sq_head++;
+        cq_tail++;
+        done++;
+        
+        /* Let a concurrent reaper start on long batches */
+        if (done % RING_PUBLISH_INTERVAL == 0) {
+            store_release(&ring->sq_head, sq_head);
+            store_release(&ring->cq_tail, cq_tail);
+        }
+    }
+    
+    store_release(&ring->sq_head, sq_head);
+    store_release(&ring->cq_tail, cq_tail);
+    if (processed) *processed = done;
+    return KOLIBRI_OK;
+}
@@ -0,0 +1,432 @@
+/**
+ * KOLIBRI.AI SHA-256 Implementation
+ */
+
+#include "kolibri_sha256.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KOLIBRI_SHA256_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/* Backends */
+#define SHA256_GENERIC 0
+#define SHA256_SHANI 1
+#define SHA256_AVX2 2
+
+static const uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t H256[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static uint32_t load_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void store_state(const uint32_t state[8], uint8_t* hash) {
+    for (int i = 0; i < 8; i++) store_be32(hash + 4 * i, state[i]);
+}
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* Portable compression function */
+static void sha256_blocks_generic(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    uint32_t w[64];
+
+    while (blocks--) {
+        for (int t = 0; t < 16; t++) w[t] = load_be32(data + 4 * t);
+        for (int t = 16; t < 64; t++) {
+            uint32_t s0 = ROR32(w[t - 15], 7) ^ ROR32(w[t - 15], 18) ^ (w[t - 15] >> 3);
+            uint32_t s1 = ROR32(w[t - 2], 17) ^ ROR32(w[t - 2], 19) ^ (w[t - 2] >> 10);
+            w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int t = 0; t < 64; t++) {
+            uint32_t t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) + ((e & f) ^ (~e & g)) +
+                          K256[t] + w[t];
+            uint32_t t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        data += KOLIBRI_SHA256_BLOCK_SIZE;
+    }
+}
+
+#ifdef KOLIBRI_SHA256_X86
+
+/* SHA-NI compression function */
+__attribute__((target("sha,sse4.1")))
+static void sha256_blocks_shani(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    /* Rearrange ABCD/EFGH into the ABEF/CDGH layout the instructions use */
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    while (blocks--) {
+        __m128i abef = state0;
+        __m128i cdgh = state1;
+        __m128i msg[4];
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), mask);
+        }
+
+        for (int i = 0; i < 16; i++) {
+            __m128i wk = _mm_add_epi32(msg[i & 3], _mm_loadu_si128((const __m128i*)&K256[4 * i]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
+
+            if (i < 12) {
+                /* W[4i+16..4i+19] from words 4i..4i+15 */
+                __m128i next = _mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+                msg[i & 3] = _mm_sha256msg2_epu32(next, msg[(i + 3) & 3]);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+        data += KOLIBRI_SHA256_BLOCK_SIZE;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i*)&state[0], state0);
+    _mm_storeu_si128((__m128i*)&state[4], state1);
+}
+
+#define AVX2_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+/* Transpose eight rows of eight 32-bit words */
+__attribute__((target("avx2")))
+static void transpose8(__m256i r[8]) {
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/* One block in each of eight lanes; s holds a..h with one lane per message */
+__attribute__((target("avx2")))
+static void sha256_x8_block(__m256i s[8], const uint8_t* const blocks[8]) {
+    const __m256i bswap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                          12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    __m256i w[16];
+    for (int half = 0; half < 2; half++) {
+        __m256i* r = &w[8 * half];
+        for (int lane = 0; lane < 8; lane++) {
+            r[lane] = _mm256_loadu_si256((const __m256i*)(blocks[lane] + 32 * half));
+        }
+        transpose8(r);
+        for (int i = 0; i < 8; i++) r[i] = _mm256_shuffle_epi8(r[i], bswap);
+    }
+
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3];
+    __m256i e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 64; t++) {
+        __m256i wt;
+        if (t < 16) {
+            wt = w[t];
+        } else {
+            __m256i w15 = w[(t - 15) & 15];
+            __m256i w2 = w[(t - 2) & 15];
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROR(w15, 7), AVX2_ROR(w15, 18)),
+                                          _mm256_srli_epi32(w15, 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROR(w2, 17), AVX2_ROR(w2, 19)),
+                                          _mm256_srli_epi32(w2, 10));
+            wt = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0),
+                                  _mm256_add_epi32(w[(t - 7) & 15], s1));
+            w[t & 15] = wt;
+        }
+
+        __m256i sig1 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROR(e, 6), AVX2_ROR(e, 11)), AVX2_ROR(e, 25));
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sig1),
+                                      _mm256_add_epi32(ch, _mm256_add_epi32(wt, _mm256_set1_epi32((int)K256[t]))));
+        __m256i sig0 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROR(a, 2), AVX2_ROR(a, 13)), AVX2_ROR(a, 22));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = _mm256_add_epi32(sig0, maj);
+        h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+    }
+
+    s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+    s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+    s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+    s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+}
+
+#endif /* KOLIBRI_SHA256_X86 */
+
+/* Runtime backend selection */
+static atomic_int sha256_selected = -1;
+
+static int sha256_detect(void) {
+    int backend = SHA256_GENERIC;
+#ifdef KOLIBRI_SHA256_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        int sse41 = (ecx & bit_SSE4_1) != 0;
+        int ssse3 = (ecx & bit_SSSE3) != 0;
+        int ymm = 0;
+        if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+            uint32_t xcr0_lo, xcr0_hi;
+            __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+            ymm = (xcr0_lo & 0x6) == 0x6;
+        }
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            if (ymm && (ebx & bit_AVX2)) backend = SHA256_AVX2;
+            if (sse41 && ssse3 && (ebx & bit_SHA)) backend = SHA256_SHANI;
+        }
+    }
+#endif
+    return backend;
+}
+
+static int sha256_backend_id(void) {
+    int backend = atomic_load_explicit(&sha256_selected, memory_order_relaxed);
+    if (backend < 0) {
+        backend = sha256_detect();
+        atomic_store_explicit(&sha256_selected, backend, memory_order_relaxed);
+    }
+    return backend;
+}
+
+static void sha256_blocks(uint32_t state[8], const uint8_t* data, size_t blocks) {
+#ifdef KOLIBRI_SHA256_X86
+    if (sha256_backend_id() == SHA256_SHANI) {
+        sha256_blocks_shani(state, data, blocks);
+        return;
+    }
+#endif
+    sha256_blocks_generic(state, data, blocks);
+}
+
+const char* kolibri_sha256_backend(void) {
+    switch (sha256_backend_id()) {
+        case SHA256_SHANI: return "sha-ni";
+        case SHA256_AVX2: return "avx2";
+        default: return "generic";
+    }
+}
+
+/* Streaming interface */
+void kolibri_sha256_init(kolibri_sha256_ctx_t* ctx) {
+    memcpy(ctx->state, H256, sizeof(H256));
+    ctx->length = 0;
+    ctx->buffered = 0;
+}
+
+void kolibri_sha256_update(kolibri_sha256_ctx_t* ctx, const void* data, size_t len) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    ctx->length += len;
+
+    if (ctx->buffered > 0) {
+        size_t take = KOLIBRI_SHA256_BLOCK_SIZE - ctx->buffered;
+        if (take > len) take = len;
+        memcpy(ctx->buffer + ctx->buffered, bytes, take);
+        ctx->buffered += take;
+        bytes += take;
+        len -= take;
+        if (ctx->buffered < KOLIBRI_SHA256_BLOCK_SIZE) return;
+        sha256_blocks(ctx->state, ctx->buffer, 1);
+        ctx->buffered = 0;
+    }
+
+    size_t blocks = len / KOLIBRI_SHA256_BLOCK_SIZE;
+    if (blocks > 0) {
+        sha256_blocks(ctx->state, bytes, blocks);
+        bytes += blocks * KOLIBRI_SHA256_BLOCK_SIZE;
+        len -= blocks * KOLIBRI_SHA256_BLOCK_SIZE;
+    }
+
+    memcpy(ctx->buffer, bytes, len);
+    ctx->buffered = len;
+}
+
+void kolibri_sha256_final(kolibri_sha256_ctx_t* ctx, uint8_t* hash) {
+    uint64_t bits = ctx->length * 8;
+
+    ctx->buffer[ctx->buffered++] = 0x80;
+    if (ctx->buffered > KOLIBRI_SHA256_BLOCK_SIZE - 8) {
+        memset(ctx->buffer + ctx->buffered, 0, KOLIBRI_SHA256_BLOCK_SIZE - ctx->buffered);
+        sha256_blocks(ctx->state, ctx->buffer, 1);
+        ctx->buffered = 0;
+    }
+    memset(ctx->buffer + ctx->buffered, 0, KOLIBRI_SHA256_BLOCK_SIZE - 8 - ctx->buffered);
+    store_be32(ctx->buffer + 56, (uint32_t)(bits >> 32));
+    store_be32(ctx->buffer + 60, (uint32_t)bits);
+    sha256_blocks(ctx->state, ctx->buffer, 1);
+
+    store_state(ctx->state, hash);
+}
+
+void kolibri_sha256(const void* data, size_t len, uint8_t* hash) {
+    kolibri_sha256_ctx_t ctx;
+    kolibri_sha256_init(&ctx);
+    kolibri_sha256_update(&ctx, data, len);
+    kolibri_sha256_final(&ctx, hash);
+}
+
+#ifdef KOLIBRI_SHA256_X86
+
+/* Padded blocks of a message, counted from zero */
+static size_t padded_blocks(size_t len) {
+    return (len + 9 + KOLIBRI_SHA256_BLOCK_SIZE - 1) / KOLIBRI_SHA256_BLOCK_SIZE;
+}
+
+/* Block n of the padded message; tail blocks are built in scratch */
+static const uint8_t* padded_block(const uint8_t* data, size_t len, size_t n,
+                                   uint8_t scratch[KOLIBRI_SHA256_BLOCK_SIZE]) {
+    size_t offset = n * KOLIBRI_SHA256_BLOCK_SIZE;
+    if (offset + KOLIBRI_SHA256_BLOCK_SIZE <= len) return data + offset;
+
+    memset(scratch, 0, KOLIBRI_SHA256_BLOCK_SIZE);
+    if (offset < len) memcpy(scratch, data + offset, len - offset);
+    if (offset <= len) scratch[len - offset] = 0x80;
+    if (n == padded_blocks(len) - 1) {
+        uint64_t bits = (uint64_t)len * 8;
+        store_be32(scratch + 56, (uint32_t)(bits >> 32));
+        store_be32(scratch + 60, (uint32_t)bits);
+    }
+    return scratch;
+}
+
+/* Hash up to eight messages in lockstep; lanes beyond count are idle */
+__attribute__((target("avx2")))
+static void sha256_x8(const uint8_t* const* data, const size_t* lens, const size_t* order,
+                      size_t count, uint8_t (*hashes)[KOLIBRI_SHA256_SIZE]) {
+    static const uint8_t idle[KOLIBRI_SHA256_BLOCK_SIZE];
+    uint8_t scratch[8][KOLIBRI_SHA256_BLOCK_SIZE];
+    size_t nblocks[8] = {0};
+    size_t max_blocks = 0;
+
+    for (size_t lane = 0; lane < count; lane++) {
+        nblocks[lane] = padded_blocks(lens[order[lane]]);
+        if (nblocks[lane] > max_blocks) max_blocks = nblocks[lane];
+    }
+
+    __m256i s[8];
+    for (int i = 0; i < 8; i++) s[i] = _mm256_set1_epi32((int)H256[i]);
+
+    for (size_t n = 0; n < max_blocks; n++) {
+        const uint8_t* blocks[8];
+        for (size_t lane = 0; lane < 8; lane++) {
+            blocks[lane] = idle;
+            if (lane < count && n < nblocks[lane]) {
+                size_t m = order[lane];
+                blocks[lane] = padded_block(data[m], lens[m], n, scratch[lane]);
+            }
+        }
+        sha256_x8_block(s, blocks);
+
+        /* Collect lanes that just consumed their last block */
+        for (size_t lane = 0; lane < count; lane++) {
+            if (nblocks[lane] != n + 1) continue;
+            uint32_t words[8][8];
+            for (int i = 0; i < 8; i++) _mm256_storeu_si256((__m256i*)words[i], s[i]);
+            for (size_t l = lane; l < count; l++) {
+                if (nblocks[l] != n + 1) continue;
+                for (int i = 0; i < 8; i++) store_be32(hashes[order[l]] + 4 * i, words[i][l]);
+            }
+            break;
+        }
+    }
+}
+
+static int compare_block_counts(const void* a, const void* b) {
+    const size_t* x = (const size_t*)a;
+    const size_t* y = (const size_t*)b;
+    return (x[0] > y[0]) - (x[0] < y[0]);
+}
+
+#endif /* KOLIBRI_SHA256_X86 */
+
+/* Batch interface */
+void kolibri_sha256_batch(const uint8_t* const* data, const size_t* lens, size_t count,
+                          uint8_t (*hashes)[KOLIBRI_SHA256_SIZE]) {
+    if (!data || !lens || !hashes) return;
+
+#ifdef KOLIBRI_SHA256_X86
+    if (count >= 8 && sha256_backend_id() == SHA256_AVX2) {
+        /* Group messages of equal block count so lanes finish together */
+        int uniform = 1;
+        for (size_t i = 1; i < count && uniform; i++) {
+            uniform = padded_blocks(lens[i]) == padded_blocks(lens[0]);
+        }
+
+        size_t* order = (size_t*)malloc(sizeof(size_t) * 2 * count);
+        if (order) {
+            for (size_t i = 0; i < count; i++) {
+                order[2 * i] = padded_blocks(lens[i]);
+                order[2 * i + 1] = i;
+            }
+            if (!uniform) qsort(order, count, sizeof(size_t) * 2, compare_block_counts);
+            for (size_t i = 0; i < count; i++) order[i] = order[2 * i + 1];
+
+            for (size_t i = 0; i < count; i += 8) {
+                size_t lanes = count - i < 8 ? count - i : 8;
+                sha256_x8(data, lens, order + i, lanes, hashes);
+            }
+            free(order);
+            return;
+        }
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++) {
+        kolibri_sha256(data[i], lens[i], hashes[i]);
+    }
+}
@@ -0,0 +1,489 @@
+/**
+ * KOLIBRI.AI Shared Store Implementation
+ *
+ * Publication is a seqlock over whole halves rather than over records:
+ * the writer never modifies a byte a reader of the published half can
+ * reach, except for single u64 slot stores, so readers only have to retry
+ * when a rebuild starts reusing the half they were reading. Lookups copy
+ * the record out and then check the generation; a torn copy is discarded.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* memfd_create */
+#endif
+
+#include "kolibri_shared.h"
+#include "kolibri_ring.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SLOT_EMPTY 0
+#define SLOT_DELETED 1
+#define SLOT_OFFSET_BITS 48
+#define SLOT_OFFSET_MASK ((1ull << SLOT_OFFSET_BITS) - 1)
+#define RECORD_HEADER_SIZE 8
+#define MAX_SEGMENT_SIZE (1ull << SLOT_OFFSET_BITS)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t header_size;
+    uint64_t segment_size;
+    uint32_t max_formulas;
+    uint32_t slot_count;     /* Per half, power of two */
+    uint32_t data_size;      /* Per half */
+    uint32_t reserved0;
+    uint64_t half_offset[2];
+    uint8_t reserved1[16];
+    uint64_t generation;     /* 64: published by the writer */
+    uint64_t version;
+    uint32_t active;
+    uint32_t count;
+    uint8_t reserved2[40];
+    uint32_t tail;           /* 128: writer bookkeeping for the active half */
+    uint32_t used_slots;     /* Live and deleted */
+    uint8_t reserved3[120];
+} shared_header_t;
+
+_Static_assert(sizeof(shared_header_t) == KOLIBRI_SHARED_HEADER_SIZE, "shared header is 256 bytes");
+_Static_assert(offsetof(shared_header_t, generation) == 64, "published state starts a cache line");
+_Static_assert(offsetof(shared_header_t, tail) == 128, "writer state starts a cache line");
+
+struct kolibri_shared_t {
+    uint8_t* base;
+    size_t size;
+    int fd;
+    int writable;
+};
+
+/* ---- Layout ---- */
+
+static shared_header_t* header(const kolibri_shared_t* shared) {
+    return (shared_header_t*)shared->base;
+}
+
+static uint64_t* half_slots(const kolibri_shared_t* shared, uint32_t half) {
+    return (uint64_t*)(shared->base + header(shared)->half_offset[half]);
+}
+
+static uint64_t half_data(const kolibri_shared_t* shared, uint32_t half) {
+    return header(shared)->half_offset[half] + (uint64_t)header(shared)->slot_count * sizeof(uint64_t);
+}
+
+static uint32_t next_pow2(uint64_t v) {
+    uint32_t p = 1;
+    while (p < v && p < (1u << 31)) p <<= 1;
+    return p;
+}
+
+static uint32_t slot_count_for(uint32_t max_formulas) {
+    return next_pow2((uint64_t)max_formulas * 2); /* Rebuild at 3/4 full with deletes */
+}
+
+size_t kolibri_shared_size(uint32_t max_formulas, uint32_t data_size) {
+    if (max_formulas == 0 || data_size < RECORD_HEADER_SIZE || max_formulas > (1u << 29)) return 0;
+    uint64_t half = (uint64_t)slot_count_for(max_formulas) * sizeof(uint64_t) + ((data_size + 7ull) & ~7ull);
+    uint64_t size = KOLIBRI_SHARED_HEADER_SIZE + 2 * half;
+    if (size >= MAX_SEGMENT_SIZE || size > SIZE_MAX) return 0;
+    return (size_t)size;
+}
+
+static uint64_t id_hash(const uint8_t* id) {
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < KOLIBRI_ID_SIZE; i += 8) {
+        uint64_t word;
+        memcpy(&word, id + i, sizeof(word));
+        h ^= word;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+static uint64_t make_slot(uint64_t hash, uint64_t offset) {
+    return (hash & ~SLOT_OFFSET_MASK) | offset;
+}
+
+static size_t record_size(uint32_t len) {
+    return (RECORD_HEADER_SIZE + (size_t)len + 7) & ~(size_t)7;
+}
+
+/*
+ * Record a slot value points to, checked against the half's data area so
+ * that a slot read during a rebuild cannot send a reader outside it.
+ * Returns NULL if the slot is empty or deleted, or the record is invalid.
+ */
+static const uint8_t* slot_record(const kolibri_shared_t* shared, uint32_t half, uint64_t slot,
+                                  uint32_t* len) {
+    if (slot == SLOT_EMPTY || slot == SLOT_DELETED) return NULL;
+    
+    uint64_t offset = slot & SLOT_OFFSET_MASK;
+    uint64_t begin = half_data(shared, half);
+    uint64_t end = begin + header(shared)->data_size;
+    if ((offset & 7) != 0 || offset < begin || offset + RECORD_HEADER_SIZE > end) return NULL;
+    
+    const uint8_t* record = shared->base + offset;
+    memcpy(len, record, sizeof(*len));
+    if (*len < KOLIBRI_RING_FORMULA_HEADER_SIZE || *len > end - offset - RECORD_HEADER_SIZE) return NULL;
+    return record + RECORD_HEADER_SIZE;
+}
+
+/* Probe the half for id; returns the slot index, with *record set if found.
+ * Otherwise the index is where id would go: the first deleted slot on the
+ * probe path, else the empty slot that ended it (UINT32_MAX if none). */
+static uint32_t probe(const kolibri_shared_t* shared, uint32_t half, const uint8_t* id, uint64_t hash,
+                      const uint8_t** record, uint32_t* len) {
+    const uint64_t* slots = half_slots(shared, half);
+    uint32_t mask = header(shared)->slot_count - 1;
+    uint32_t free_slot = UINT32_MAX;
+    
+    *record = NULL;
+    for (uint32_t n = 0, i = (uint32_t)hash & mask; n <= mask; n++, i = (i + 1) & mask) {
+        uint64_t slot = __atomic_load_n(&slots[i], __ATOMIC_ACQUIRE);
+        if (slot == SLOT_EMPTY) return free_slot != UINT32_MAX ? free_slot : i;
+        if (slot == SLOT_DELETED) {
+            if (free_slot == UINT32_MAX) free_slot = i;
+            continue;
+        }
+        if ((slot ^ hash) & ~SLOT_OFFSET_MASK) continue;
+        
+        const uint8_t* r = slot_record(shared, half, slot, len);
+        if (r && memcmp(r, id, KOLIBRI_ID_SIZE) == 0) {
+            *record = r;
+            return i;
+        }
+    }
+    return free_slot;
+}
+
+/* ---- Segments ---- */
+
+static int map_segment(int fd, int writable, kolibri_shared_t** shared) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < KOLIBRI_SHARED_HEADER_SIZE) return KOLIBRI_ERROR_STORAGE;
+    
+    size_t size = (size_t)st.st_size;
+    void* base = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) return KOLIBRI_ERROR_STORAGE;
+    
+    kolibri_shared_t* s = (kolibri_shared_t*)calloc(1, sizeof(kolibri_shared_t));
+    if (!s) {
+        munmap(base, size);
+        return KOLIBRI_ERROR_STORAGE;
+    }
+    s->base = (uint8_t*)base;
+    s->size = size;
+    s->fd = fd;
+    s->writable = writable;
+    *shared = s;
+    return KOLIBRI_OK;
+}
+
+/* Check that a mapped header describes a segment of this size */
+static int validate_segment(const kolibri_shared_t* shared) {
+    const shared_header_t* hdr = header(shared);
+    if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != KOLIBRI_SHARED_MAGIC ||
+        hdr->header_size != KOLIBRI_SHARED_HEADER_SIZE || hdr->segment_size != shared->size ||
+        hdr->max_formulas == 0 || hdr->slot_count != slot_count_for(hdr->max_formulas) ||
+        kolibri_shared_size(hdr->max_formulas, hdr->data_size) != shared->size) {
+        return KOLIBRI_ERROR_INVALID_PARAM;
+    }
+    
+    uint64_t half = (shared->size - KOLIBRI_SHARED_HEADER_SIZE) / 2;
+    if (hdr->half_offset[0] != KOLIBRI_SHARED_HEADER_SIZE ||
+        hdr->half_offset[1] != KOLIBRI_SHARED_HEADER_SIZE + half) {
+        return KOLIBRI_ERROR_INVALID_PARAM;
+    }
+    return KOLIBRI_OK;
+}
+
+int kolibri_shared_create(const char* name, uint32_t max_formulas, uint32_t data_size,
+                          kolibri_shared_t** shared) {
+    size_t size = kolibri_shared_size(max_formulas, data_size);
+    if (!shared || size == 0) return KOLIBRI_ERROR_INVALID_PARAM;
+    *shared = NULL;
+    
+    int fd;
+    if (name) {
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    } else {
+#ifdef __linux__
+        fd = memfd_create("kolibri-shared", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+        return KOLIBRI_ERROR_INVALID_PARAM;
+#endif
+    }
+    if (fd < 0) return KOLIBRI_ERROR_STORAGE;
+    
+    int result = ftruncate(fd, (off_t)size) == 0 ? KOLIBRI_OK : KOLIBRI_ERROR_STORAGE;
+#ifdef __linux__
+    /* Workers can then rely on the size they mapped */
+    if (result == KOLIBRI_OK && !name) fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+#endif
+    if (result == KOLIBRI_OK) result = map_segment(fd, 1, shared);
+    if (result != KOLIBRI_OK) {
+        close(fd);
+        if (name) shm_unlink(name);
+        return result;
+    }
+    
+    /* The object is zero-filled: both halves start with empty slots */
+    shared_header_t* hdr = header(*shared);
+    uint64_t half = (size - KOLIBRI_SHARED_HEADER_SIZE) / 2;
+    hdr->header_size = KOLIBRI_SHARED_HEADER_SIZE;
+    hdr->segment_size = size;
+    hdr->max_formulas = max_formulas;
+    hdr->slot_count = slot_count_for(max_formulas);
+    hdr->data_size = (uint32_t)(half - (uint64_t)hdr->slot_count * sizeof(uint64_t));
+    hdr->half_offset[0] = KOLIBRI_SHARED_HEADER_SIZE;
+    hdr->half_offset[1] = KOLIBRI_SHARED_HEADER_SIZE + half;
+    __atomic_store_n(&hdr->magic, KOLIBRI_SHARED_MAGIC, __ATOMIC_RELEASE);
+    return KOLIBRI_OK;
+}
+
+int kolibri_shared_attach_fd(int fd, kolibri_shared_t** shared) {
+    if (fd < 0 || !shared) return KOLIBRI_ERROR_INVALID_PARAM;
+    *shared = NULL;
+    
+    int own = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (own < 0) return KOLIBRI_ERROR_STORAGE;
+    
+    kolibri_shared_t* s = NULL;
+    int result = map_segment(own, 0, &s);
+    if (result != KOLIBRI_OK) {
+        close(own);
+        return result;
+    }
+    result = validate_segment(s);
+    if (result != KOLIBRI_OK) {
+        kolibri_shared_close(s);
+        return result;
+    }
+    *shared = s;
+    return KOLIBRI_OK;
+}
+
+int kolibri_shared_attach(const char* name, kolibri_shared_t** shared) {
+    if (!name || !shared) return KOLIBRI_ERROR_INVALID_PARAM;
+    *shared = NULL;
+    
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return KOLIBRI_ERROR_NOT_FOUND;
+    int result = kolibri_shared_attach_fd(fd, shared);
+    close(fd);
+    return result;
+}
+
+void kolibri_shared_close(kolibri_shared_t* shared) {
+    if (!shared) return;
+    munmap(shared->base, shared->size);
+    close(shared->fd);
+    free(shared);
+}
+
+int kolibri_shared_unlink(const char* name) {
+    if (!name) return KOLIBRI_ERROR_INVALID_PARAM;
+    return shm_unlink(name) == 0 ? KOLIBRI_OK : KOLIBRI_ERROR_NOT_FOUND;
+}
+
+int kolibri_shared_fd(const kolibri_shared_t* shared) {
+    return shared ? shared->fd : -1;
+}
+
+int kolibri_shared_writable(const kolibri_shared_t* shared) {
+    return shared ? shared->writable : 0;
+}
+
+/* ---- Writer ---- */
+
+static void publish_version(shared_header_t* hdr) {
+    __atomic_store_n(&hdr->version, hdr->version + 1, __ATOMIC_RELEASE);
+}
+
+/* Encode formula at the given data offset of the half; the caller has
+ * checked that size bytes fit */
+static void write_record(kolibri_shared_t* shared, uint64_t offset, const kolibri_formula_t* formula,
+                         size_t size) {
+    uint8_t* p = shared->base + offset;
+    uint32_t len = (uint32_t)kolibri_ring_encode_formula(formula, p + RECORD_HEADER_SIZE,
+                                                         size - RECORD_HEADER_SIZE);
+    memcpy(p, &len, sizeof(len));
+    memset(p + 4, 0, 4);
+    memset(p + RECORD_HEADER_SIZE + len, 0, size - RECORD_HEADER_SIZE - len);
+}
+
+/*
+ * Copy the live formulas of the published half, with formula added or
+ * replacing its previous version, into the other half and publish that.
+ * The generation is bumped first: readers still holding the other half
+ * from the last rebuild see it change and retry.
+ */
+static int rebuild(kolibri_shared_t* shared, const kolibri_formula_t* formula, size_t formula_size) {
+    shared_header_t* hdr = header(shared);
+    uint32_t from = hdr->active;
+    uint32_t to = from ^ 1;
+    const uint64_t* old_slots = half_slots(shared, from);
+    uint64_t* slots = half_slots(shared, to);
+    uint64_t data = half_data(shared, to);
+    uint32_t mask = hdr->slot_count - 1;
+    uint64_t tail = 0;
+    uint32_t count = 0;
+    
+    __atomic_store_n(&hdr->generation, hdr->generation + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memset(slots, 0, (size_t)hdr->slot_count * sizeof(uint64_t));
+    
+    for (uint32_t i = 0; i <= mask + 1; i++) {
+        uint64_t hash;
+        size_t size;
+        const uint8_t* record = NULL;
+        uint32_t len = 0;
+        
+        if (i <= mask) {
+            record = slot_record(shared, from, old_slots[i], &len);
+            if (!record || memcmp(record, formula->id, KOLIBRI_ID_SIZE) == 0) continue;
+            hash = id_hash(record);
+            size = record_size(len);
+        } else {
+            hash = id_hash(formula->id);
+            size = formula_size;
+        }
+        if (tail + size > hdr->data_size || count >= hdr->max_formulas) return KOLIBRI_ERROR_STORAGE;
+        
+        uint64_t offset = data + tail;
+        if (record) memcpy(shared->base + offset, record - RECORD_HEADER_SIZE, size);
+        else write_record(shared, offset, formula, size);
+        
+        uint32_t s = (uint32_t)hash & mask;
+        while (slots[s] != SLOT_EMPTY) s = (s + 1) & mask;
+        slots[s] = make_slot(hash, offset);
+        tail += size;
+        count++;
+    }
+    
+    __atomic_store_n(&hdr->active, to, __ATOMIC_RELEASE);
+    hdr->tail = (uint32_t)tail;
+    hdr->used_slots = count;
+    __atomic_store_n(&hdr->count, count, __ATOMIC_RELAXED);
+    publish_version(hdr);
+    return KOLIBRI_OK;
+}
+
+int kolibri_shared_put(kolibri_shared_t* shared, const kolibri_formula_t* formula) {
+    if (!shared || !formula) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (!shared->writable) return KOLIBRI_ERROR;
+    if (formula->code_size > KOLIBRI_MAX_FORMULA_SIZE) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (formula->code_size > 0 && !formula->code) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    shared_header_t* hdr = header(shared);
+    uint32_t half = hdr->active;
+    uint64_t hash = id_hash(formula->id);
+    size_t size = record_size((uint32_t)kolibri_ring_encode_formula(formula, NULL, 0));
+    const uint8_t* existing;
+    uint32_t len;
+    uint32_t s = probe(shared, half, formula->id, hash, &existing, &len);
+    
+    if (!existing && hdr->count >= hdr->max_formulas) return KOLIBRI_ERROR_STORAGE;
+    uint64_t* slots = half_slots(shared, half);
+    int new_slot = !existing && (s == UINT32_MAX || slots[s] == SLOT_EMPTY);
+    if ((uint64_t)hdr->tail + size > hdr->data_size || s == UINT32_MAX ||
+        (new_slot && (hdr->used_slots + 1) * 4 > hdr->slot_count * 3)) {
+        return rebuild(shared, formula, size);
+    }
+    
+    /* Append, then publish with one slot store; a replaced record stays
+     * intact for readers that already found it */
+    uint64_t offset = half_data(shared, half) + hdr->tail;
+    write_record(shared, offset, formula, size);
+    __atomic_store_n(&slots[s], make_slot(hash, offset), __ATOMIC_RELEASE);
+    hdr->tail += (uint32_t)size;
+    if (new_slot) hdr->used_slots++;
+    if (!existing) __atomic_store_n(&hdr->count, hdr->count + 1, __ATOMIC_RELAXED);
+    publish_version(hdr);
+    return KOLIBRI_OK;
+}
+
+int kolibri_shared_delete(kolibri_shared_t* shared, const uint8_t* id) {
+    if (!shared || !id) return KOLIBRI_ERROR_INVALID_PARAM;
+    if (!shared->writable) return KOLIBRI_ERROR;
+    
+    shared_header_t* hdr = header(shared);
+    const uint8_t* existing;
+    uint32_t len;
+    uint32_t s = probe(shared, hdr->active, id, id_hash(id), &existing, &len);
+    if (!existing) return KOLIBRI_ERROR_NOT_FOUND;
+    
+    __atomic_store_n(&half_slots(shared, hdr->active)[s], (uint64_t)SLOT_DELETED, __ATOMIC_RELEASE);
+    __atomic_store_n(&hdr->count, hdr->count - 1, __ATOMIC_RELAXED);
+    publish_version(hdr);
+    return KOLIBRI_OK;
+}
+
+/* ---- Readers ---- */
+
+int kolibri_shared_get(const kolibri_shared_t* shared, const uint8_t* id, kolibri_formula_t* formula,
+                       uint8_t* code, uint32_t code_capacity) {
+    if (!shared || !id || !formula) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    const shared_header_t* hdr = header(shared);
+    uint64_t hash = id_hash(id);
+    for (;;) {
+        uint64_t generation = __atomic_load_n(&hdr->generation, __ATOMIC_ACQUIRE);
+        uint32_t half = __atomic_load_n(&hdr->active, __ATOMIC_ACQUIRE) & 1;
+        const uint8_t* record;
+        uint32_t len;
+        int result = KOLIBRI_ERROR_NOT_FOUND;
+        
+        probe(shared, half, id, hash, &record, &len);
+        if (record) {
+            result = kolibri_ring_decode_formula(record, len, formula);
+            if (result == KOLIBRI_OK && code && formula->code_size > code_capacity) {
+                result = KOLIBRI_ERROR_INVALID_PARAM;
+            }
+            if (result == KOLIBRI_OK && code && formula->code_size > 0) {
+                memcpy(code, formula->code, formula->code_size);
+            }
+            formula->code = result == KOLIBRI_OK && code && formula->code_size > 0 ? code : NULL;
+        }
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&hdr->generation, __ATOMIC_RELAXED) == generation) return result;
+    }
+}
+
+int kolibri_shared_ids(const kolibri_shared_t* shared, uint8_t (*ids)[KOLIBRI_ID_SIZE],
+                       uint32_t max_ids, uint32_t* count) {
+    if (!shared || !count || (!ids && max_ids > 0)) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    const shared_header_t* hdr = header(shared);
+    for (;;) {
+        uint64_t generation = __atomic_load_n(&hdr->generation, __ATOMIC_ACQUIRE);
+        uint32_t half = __atomic_load_n(&hdr->active, __ATOMIC_ACQUIRE) & 1;
+        const uint64_t* slots = half_slots(shared, half);
+        uint32_t n = 0;
+        
+        for (uint32_t i = 0; i < hdr->slot_count && n < max_ids; i++) {
+            uint32_t len;
+            const uint8_t* record = slot_record(shared, half, __atomic_load_n(&slots[i], __ATOMIC_ACQUIRE), &len);
+            if (record) memcpy(ids[n++], record, KOLIBRI_ID_SIZE);
+        }
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&hdr->generation, __ATOMIC_RELAXED) == generation) {
+            *count = n;
+            return KOLIBRI_OK;
+        }
+    }
+}
+
+uint32_t kolibri_shared_count(const kolibri_shared_t* shared) {
+    return shared ? __atomic_load_n(&header(shared)->count, __ATOMIC_RELAXED) : 0;
+}
+
+uint64_t kolibri_shared_version(const kolibri_shared_t* shared) {
+    return shared ? __atomic_load_n(&header(shared)->version, __ATOMIC_ACQUIRE) : 0;
+}
@@ -0,0 +1,830 @@
+/**
+ * KOLIBRI.AI Sync Implementation
+ *
+ * Protocol (initiator A, responder B), each message framed as type u8,
+ * length u32 LE, payload:
+ *
+ *   A -> B  'I'  IBLT fold: size u32, then 3 * size cells
+ *   B -> A  'R'  fold did not decode; A doubles the size, or at
+ *                KOLIBRI_IBLT_MAX_SIZE sends 'K' instead
+ *   A -> B  'K'  every key A holds: count u32, keys
+ *   B -> A  'P'  plan: count u32 + IDs B wants, then the records B pushes
+ *   A -> B  'F'  the records B asked for
+ *
+ * Each record is a length u32 followed by a formula record in the
+ * little-endian layout of kolibri_ring.h. Only the fold, the decoded
+ * difference and the differing formulas cross the wire. Received records are
+ * checked against the trusted key, if one is set, before any is stored.
+ */
+
+#include "kolibri_sync.h"
+#include "kolibri_ring.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define SYNC_MSG_IBLT 'I'
+#define SYNC_MSG_RETRY 'R'
+#define SYNC_MSG_KEYS 'K'
+#define SYNC_MSG_PLAN 'P'
+#define SYNC_MSG_RECORDS 'F'
+#define SYNC_MAX_MESSAGE (1u << 30)
+#define SYNC_CELL_WIRE_SIZE (4 + KOLIBRI_SYNC_KEY_SIZE + 8)
+#define SYNC_PIPE_SIZE 65536
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+/* ---- IBLT ---- */
+
+static void make_key(uint8_t* key, const uint8_t* id, uint32_t version) {
+    memcpy(key, id, KOLIBRI_ID_SIZE);
+    put_u32(key + KOLIBRI_ID_SIZE, version);
+}
+
+/* Seeded mix of a key; seed 0 is the checksum, 1..3 the subtable positions.
+ * Must be identical on every peer, so words are read little-endian. */
+static uint64_t key_hash(const uint8_t* key, uint64_t seed) {
+    uint64_t h = 0x9E3779B97F4A7C15ull * (seed + 1);
+    for (int i = 0; i < KOLIBRI_SYNC_KEY_SIZE; i += 4) {
+        h ^= get_u32(key + i);
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+    }
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+int kolibri_iblt_init(kolibri_iblt_t* table, uint32_t size) {
+    if (!table || size == 0 || (size & (size - 1)) != 0) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    table->cells = (kolibri_iblt_cell_t*)calloc((size_t)KOLIBRI_IBLT_HASHES * size,
+                                                sizeof(kolibri_iblt_cell_t));
+    table->size = table->cells ? size : 0;
+    return table->cells ? KOLIBRI_OK : KOLIBRI_ERROR_STORAGE;
+}
+
+void kolibri_iblt_free(kolibri_iblt_t* table) {
+    if (!table) return;
+    free(table->cells);
+    table->cells = NULL;
+    table->size = 0;
+}
+
+static void cell_apply(kolibri_iblt_cell_t* cell, const uint8_t* key, uint64_t check, int32_t delta) {
+    cell->count += delta;
+    for (int i = 0; i < KOLIBRI_SYNC_KEY_SIZE; i++) cell->key[i] ^= key[i];
+    cell->check ^= check;
+}
+
+static void iblt_apply(kolibri_iblt_t* table, const uint8_t* key, int32_t delta) {
+    uint64_t check = key_hash(key, 0);
+    for (uint32_t j = 0; j < KOLIBRI_IBLT_HASHES; j++) {
+        uint32_t pos = (uint32_t)key_hash(key, j + 1) & (table->size - 1);
+        cell_apply(&table->cells[j * table->size + pos], key, check, delta);
+    }
+}
+
+void kolibri_iblt_update(kolibri_iblt_t* table, const uint8_t* id, uint32_t version, int32_t delta) {
+    if (!table || !table->cells || !id) return;
+    
+    uint8_t key[KOLIBRI_SYNC_KEY_SIZE];
+    make_key(key, id, version);
+    iblt_apply(table, key, delta);
+}
+
+int kolibri_iblt_fold(const kolibri_iblt_t* table, uint32_t size, kolibri_iblt_t* out) {
+    if (!table || !out || size > table->size) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    int result = kolibri_iblt_init(out, size);
+    if (result != KOLIBRI_OK) return result;
+    
+    for (uint32_t j = 0; j < KOLIBRI_IBLT_HASHES; j++) {
+        const kolibri_iblt_cell_t* src = &table->cells[j * table->size];
+        kolibri_iblt_cell_t* dst = &out->cells[j * size];
+        for (uint32_t i = 0; i < table->size; i++) {
+            cell_apply(&dst[i & (size - 1)], src[i].key, src[i].check, src[i].count);
+        }
+    }
+    return KOLIBRI_OK;
+}
+
+static int cell_is_pure(const kolibri_iblt_cell_t* cell) {
+    return (cell->count == 1 || cell->count == -1) && key_hash(cell->key, 0) == cell->check;
+}
+
+static int cell_is_empty(const kolibri_iblt_cell_t* cell) {
+    if (cell->count != 0 || cell->check != 0) return 0;
+    for (int i = 0; i < KOLIBRI_SYNC_KEY_SIZE; i++) {
+        if (cell->key[i]) return 0;
+    }
+    return 1;
+}
+
+/* Growable list of keys */
+typedef struct {
+    uint8_t (*keys)[KOLIBRI_SYNC_KEY_SIZE];
+    uint32_t count;
+    uint32_t capacity;
+} key_list_t;
+
+static int key_list_add(key_list_t* list, const uint8_t* key) {
+    if (list->count == list->capacity) {
+        uint32_t capacity = list->capacity ? list->capacity * 2 : 64;
+        uint8_t (*keys)[KOLIBRI_SYNC_KEY_SIZE] =
+            (uint8_t (*)[KOLIBRI_SYNC_KEY_SIZE])realloc(list->keys, (size_t)capacity * KOLIBRI_SYNC_KEY_SIZE);
+        if (!keys) return KOLIBRI_ERROR_STORAGE;
+        list->keys = keys;
+        list->capacity = capacity;
+    }
+    memcpy(list->keys[list->count++], key, KOLIBRI_SYNC_KEY_SIZE);
+    return KOLIBRI_OK;
+}
+
+/* Peel a difference table (theirs - ours) into the keys only they hold and
+ * the keys only we hold. Returns KOLIBRI_ERROR if it does not fully decode. */
+static int iblt_peel(kolibri_iblt_t* diff, key_list_t* theirs, key_list_t* ours) {
+    uint32_t total = KOLIBRI_IBLT_HASHES * diff->size;
+    uint32_t limit = total * 2; /* More keys than this means corrupt input */
+    int progress = 1;
+    
+    while (progress) {
+        progress = 0;
+        for (uint32_t c = 0; c < total; c++) {
+            kolibri_iblt_cell_t* cell = &diff->cells[c];
+            if (!cell_is_pure(cell)) continue;
+            
+            uint8_t key[KOLIBRI_SYNC_KEY_SIZE];
+            int32_t sign = cell->count;
+            memcpy(key, cell->key, sizeof(key));
+            if (key_list_add(sign > 0 ? theirs : ours, key) != KOLIBRI_OK) return KOLIBRI_ERROR_STORAGE;
+            if (theirs->count + ours->count > limit) return KOLIBRI_ERROR;
+            
+            iblt_apply(diff, key, -sign);
+            progress = 1;
+        }
+    }
+    
+    for (uint32_t c = 0; c < total; c++) {
+        if (!cell_is_empty(&diff->cells[c])) return KOLIBRI_ERROR;
+    }
+    return KOLIBRI_OK;
+}
+
+/* ---- Transports ---- */
+
+void kolibri_transport_destroy(kolibri_transport_t* transport) {
+    if (transport && transport->destroy) transport->destroy(transport);
+}
+
+/* One direction of an in-process pair */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t data[SYNC_PIPE_SIZE];
+    size_t head;
+    size_t used;
+    int closed;
+    int refs;
+} byte_pipe_t;
+
+typedef struct {
+    kolibri_transport_t base;
+    byte_pipe_t* in;
+    byte_pipe_t* out;
+} pair_transport_t;
+
+static int pair_send(kolibri_transport_t* transport, const void* data, size_t len) {
+    byte_pipe_t* pipe = ((pair_transport_t*)transport)->out;
+    const uint8_t* bytes = (const uint8_t*)data;
+    
+    pthread_mutex_lock(&pipe->lock);
+    while (len > 0) {
+        while (pipe->used == SYNC_PIPE_SIZE && !pipe->closed) {
+            pthread_cond_wait(&pipe->cond, &pipe->lock);
+        }
+        if (pipe->closed) break;
+        
+        /* Contiguous free space after the tail */
+        size_t tail = (pipe->head + pipe->used) % SYNC_PIPE_SIZE;
+        size_t n = SYNC_PIPE_SIZE - tail;
+        if (n > SYNC_PIPE_SIZE - pipe->used) n = SYNC_PIPE_SIZE - pipe->used;
+        if (n > len) n = len;
+        memcpy(pipe->data + tail, bytes, n);
+        pipe->used += n;
+        bytes += n;
+        len -= n;
+        pthread_cond_broadcast(&pipe->cond);
+    }
+    pthread_mutex_unlock(&pipe->lock);
+    
+    return len == 0 ? KOLIBRI_OK : KOLIBRI_ERROR_TRANSPORT;
+}
+
+static int pair_recv(kolibri_transport_t* transport, void* data, size_t len) {
+    byte_pipe_t* pipe = ((pair_transport_t*)transport)->in;
+    uint8_t* bytes = (uint8_t*)data;
+    
+    pthread_mutex_lock(&pipe->lock);
+    while (len > 0) {
+        while (pipe->used == 0 && !pipe->closed) {
+            pthread_cond_wait(&pipe->cond, &pipe->lock);
+        }
+        if (pipe->used == 0) break;
+        
+        size_t n = SYNC_PIPE_SIZE - pipe->head;
+        if (n > pipe->used) n = pipe->used;
+        if (n > len) n = len;
+        memcpy(bytes, pipe->data + pipe->head, n);
+        pipe->head = (pipe->head + n) % SYNC_PIPE_SIZE;
+        pipe->used -= n;
+        bytes += n;
+        len -= n;
+        pthread_cond_broadcast(&pipe->cond);
+    }
+    pthread_mutex_unlock(&pipe->lock);
+    
+    return len == 0 ? KOLIBRI_OK : KOLIBRI_ERROR_TRANSPORT;
+}
+
+/* Close a pipe end; the pipe is freed once both ends let go */
+static void pipe_release(byte_pipe_t* pipe) {
+    pthread_mutex_lock(&pipe->lock);
+    pipe->closed = 1;
+    int refs = --pipe->refs;
+    pthread_cond_broadcast(&pipe->cond);
+    pthread_mutex_unlock(&pipe->lock);
+    
+    if (refs == 0) {
+        pthread_mutex_destroy(&pipe->lock);
+        pthread_cond_destroy(&pipe->cond);
+        free(pipe);
+    }
+}
+
+static void pair_destroy(kolibri_transport_t* transport) {
+    pair_transport_t* pair = (pair_transport_t*)transport;
+    pipe_release(pair->in);
+    pipe_release(pair->out);
+    free(pair);
+}
+
+static byte_pipe_t* pipe_create(void) {
+    byte_pipe_t* pipe = (byte_pipe_t*)calloc(1, sizeof(byte_pipe_t));
+    if (!pipe) return NULL;
+    pthread_mutex_init(&pipe->lock, NULL);
+    pthread_cond_init(&pipe->cond, NULL);
+    pipe->refs = 2;
+    return pipe;
+}
+
+int kolibri_transport_pair(kolibri_transport_t** a, kolibri_transport_t** b) {
+    if (!a || !b) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    pair_transport_t* ends[2] = {
+        (pair_transport_t*)calloc(1, sizeof(pair_transport_t)),
+        (pair_transport_t*)calloc(1, sizeof(pair_transport_t))
+    };
+    byte_pipe_t* ab = pipe_create();
+    byte_pipe_t* ba = pipe_create();
+    if (!ends[0] || !ends[1] || !ab || !ba) {
+        free(ends[0]);
+        free(ends[1]);
+        free(ab);
+        free(ba);
+        return KOLIBRI_ERROR_STORAGE;
+    }
+    
+    for (int i = 0; i < 2; i++) {
+        ends[i]->base.send = pair_send;
+        ends[i]->base.recv = pair_recv;
+        ends[i]->base.destroy = pair_destroy;
+    }
+    ends[0]->out = ab;
+    ends[0]->in = ba;
+    ends[1]->out = ba;
+    ends[1]->in = ab;
+    
+    *a = &ends[0]->base;
+    *b = &ends[1]->base;
+    return KOLIBRI_OK;
+}
+
+/* Stream socket */
+typedef struct {
+    kolibri_transport_t base;
+    int fd;
+} fd_transport_t;
+
+static int fd_send(kolibri_transport_t* transport, const void* data, size_t len) {
+    int fd = ((fd_transport_t*)transport)->fd;
+    const uint8_t* bytes = (const uint8_t*)data;
+    
+    while (len > 0) {
+        ssize_t n = send(fd, bytes, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return KOLIBRI_ERROR_TRANSPORT;
+        bytes += n;
+        len -= (size_t)n;
+    }
+    return KOLIBRI_OK;
+}
+
+static int fd_recv(kolibri_transport_t* transport, void* data, size_t len) {
+    int fd = ((fd_transport_t*)transport)->fd;
+    uint8_t* bytes = (uint8_t*)data;
+    
+    while (len > 0) {
+        ssize_t n = recv(fd, bytes, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return KOLIBRI_ERROR_TRANSPORT;
+        bytes += n;
+        len -= (size_t)n;
+    }
+    return KOLIBRI_OK;
+}
+
+static void fd_destroy(kolibri_transport_t* transport) {
+    close(((fd_transport_t*)transport)->fd);
+    free(transport);
+}
+
+static kolibri_transport_t* fd_transport(int fd) {
+    if (fd < 0) return NULL;
+    
+    fd_transport_t* t = (fd_transport_t*)calloc(1, sizeof(fd_transport_t));
+    if (!t) {
+        close(fd);
+        return NULL;
+    }
+    t->base.send = fd_send;
+    t->base.recv = fd_recv;
+    t->base.destroy = fd_destroy;
+    t->fd = fd;
+    return &t->base;
+}
+
+static int unix_address(const char* path, struct sockaddr_un* addr) {
+    if (!path || strlen(path) >= sizeof(addr->sun_path)) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+    return KOLIBRI_OK;
+}
+
+int kolibri_transport_unix_listen(const char* path) {
+    struct sockaddr_un addr;
+    if (unix_address(path, &addr) != KOLIBRI_OK) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return KOLIBRI_ERROR_TRANSPORT;
+    
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        close(fd);
+        return KOLIBRI_ERROR_TRANSPORT;
+    }
+    return fd;
+}
+
+kolibri_transport_t* kolibri_transport_unix_accept(int listen_fd) {
+    int fd;
+    do {
+        fd = accept(listen_fd, NULL, NULL);
+    } while (fd < 0 && errno == EINTR);
+    return fd_transport(fd);
+}
+
+kolibri_transport_t* kolibri_transport_unix_connect(const char* path) {
+    struct sockaddr_un addr;
+    if (unix_address(path, &addr) != KOLIBRI_OK) return NULL;
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return NULL;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return NULL;
+    }
+    return fd_transport(fd);
+}
+
+/* ---- Messages ---- */
+
+/* Growable message buffer */
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} sync_buf_t;
+
+static uint8_t* buf_reserve(sync_buf_t* buf, size_t extra) {
+    if (buf->capacity - buf->size < extra) {
+        size_t capacity = buf->capacity ? buf->capacity : 4096;
+        while (capacity - buf->size < extra) capacity *= 2;
+        uint8_t* data = (uint8_t*)realloc(buf->data, capacity);
+        if (!data) return NULL;
+        buf->data = data;
+        buf->capacity = capacity;
+    }
+    uint8_t* p = buf->data + buf->size;
+    buf->size += extra;
+    return p;
+}
+
+static int send_msg(kolibri_transport_t* t, kolibri_sync_stats_t* stats, uint8_t type,
+                    const uint8_t* payload, size_t len) {
+    if (len > SYNC_MAX_MESSAGE) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    uint8_t header[5];
+    header[0] = type;
+    put_u32(header + 1, (uint32_t)len);
+    if (t->send(t, header, sizeof(header)) != KOLIBRI_OK) return KOLIBRI_ERROR_TRANSPORT;
+    if (len > 0 && t->send(t, payload, len) != KOLIBRI_OK) return KOLIBRI_ERROR_TRANSPORT;
+    
+    stats->bytes_sent += sizeof(header) + len;
+    return KOLIBRI_OK;
+}
+
+static int recv_msg(kolibri_transport_t* t, kolibri_sync_stats_t* stats, uint8_t* type,
+                    sync_buf_t* buf) {
+    uint8_t header[5];
+    if (t->recv(t, header, sizeof(header)) != KOLIBRI_OK) return KOLIBRI_ERROR_TRANSPORT;
+    
+    uint32_t len = get_u32(header + 1);
+    if (len > SYNC_MAX_MESSAGE) return KOLIBRI_ERROR_TRANSPORT;
+    
+    buf->size = 0;
+    if (len > 0) {
+        uint8_t* payload = buf_reserve(buf, len);
+        if (!payload) return KOLIBRI_ERROR_STORAGE;
+        if (t->recv(t, payload, len) != KOLIBRI_OK) return KOLIBRI_ERROR_TRANSPORT;
+    }
+    
+    *type = header[0];
+    stats->bytes_received += sizeof(header) + len;
+    return KOLIBRI_OK;
+}
+
+static int send_iblt(kolibri_transport_t* t, kolibri_sync_stats_t* stats, const kolibri_iblt_t* table) {
+    sync_buf_t buf = {0};
+    size_t cells = (size_t)KOLIBRI_IBLT_HASHES * table->size;
+    uint8_t* p = buf_reserve(&buf, 4 + cells * SYNC_CELL_WIRE_SIZE);
+    if (!p) return KOLIBRI_ERROR_STORAGE;
+    
+    put_u32(p, table->size);
+    p += 4;
+    for (size_t c = 0; c < cells; c++) {
+        put_u32(p, (uint32_t)table->cells[c].count);
+        memcpy(p + 4, table->cells[c].key, KOLIBRI_SYNC_KEY_SIZE);
+        put_u64(p + 4 + KOLIBRI_SYNC_KEY_SIZE, table->cells[c].check);
+        p += SYNC_CELL_WIRE_SIZE;
+    }
+    
+    int result = send_msg(t, stats, SYNC_MSG_IBLT, buf.data, buf.size);
+    free(buf.data);
+    return result;
+}
+
+/* Append one formula record: length u32, then the ring record */
+static int put_record(sync_buf_t* buf, const kolibri_formula_t* formula) {
+    size_t size = kolibri_ring_encode_formula(formula, NULL, 0);
+    uint8_t* p = buf_reserve(buf, 4 + size);
+    if (!p) return KOLIBRI_ERROR_STORAGE;
+    
+    put_u32(p, (uint32_t)size);
+    kolibri_ring_encode_formula(formula, p + 4, size);
+    return KOLIBRI_OK;
+}
+
+/* Decode every record, verify them all against the trusted key if one is
+ * set, then store each record that is missing here or newer than our copy */
+static int ingest_records(kolibri_core_t* core, const uint8_t* p, size_t len, uint32_t count,
+                          kolibri_sync_stats_t* stats) {
+    if (count == 0) return KOLIBRI_OK;
+    if (count > len / (4 + KOLIBRI_RING_FORMULA_HEADER_SIZE)) return KOLIBRI_ERROR_TRANSPORT;
+    
+    kolibri_formula_t* formulas = (kolibri_formula_t*)malloc((size_t)count * sizeof(kolibri_formula_t));
+    if (!formulas) return KOLIBRI_ERROR_STORAGE;
+    
+    int result = KOLIBRI_OK;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t size = len >= 4 ? get_u32(p) : 0;
+        if (len < 4 || len - 4 < size ||
+            kolibri_ring_decode_formula(p + 4, size, &formulas[i]) != KOLIBRI_OK) {
+            result = KOLIBRI_ERROR_TRANSPORT;
+            goto done;
+        }
+        p += 4 + (size_t)size;
+        len -= 4 + (size_t)size;
+    }
+    
+    const uint8_t* trusted_key = kolibri_sync_trusted_key(core);
+    if (trusted_key && kolibri_verify_formula_batch(formulas, count, trusted_key, NULL) != KOLIBRI_OK) {
+        result = KOLIBRI_ERROR_SIGNATURE;
+        goto done;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        kolibri_formula_t local;
+        if (kolibri_formula_get(core, formulas[i].id, &local) == KOLIBRI_OK &&
+            local.version >= formulas[i].version) {
+            continue;
+        }
+        result = kolibri_sync_store(core, &formulas[i]);
+        if (result != KOLIBRI_OK) goto done;
+        stats->formulas_received++;
+    }
+    
+done:
+    free(formulas);
+    return result;
+}
+
+/* ---- Protocol ---- */
+
+static int compare_keys(const void* a, const void* b) {
+    return memcmp(a, b, KOLIBRI_SYNC_KEY_SIZE);
+}
+
+static int compare_id_to_key(const void* id, const void* key) {
+    return memcmp(id, key, KOLIBRI_ID_SIZE);
+}
+
+/* Version of id in a sorted key list, or -1 if absent */
+static int64_t find_version(const key_list_t* list, const uint8_t* id) {
+    if (list->count == 0) return -1;
+    const uint8_t* key = (const uint8_t*)bsearch(id, list->keys, list->count,
+                                                 KOLIBRI_SYNC_KEY_SIZE, compare_id_to_key);
+    return key ? (int64_t)get_u32(key + KOLIBRI_ID_SIZE) : -1;
+}
+
+/* Responder: given the keys only the initiator holds and the keys only we
+ * hold, ask for what is newer there and push what is newer here */
+static int send_plan(kolibri_core_t* core, kolibri_transport_t* t, kolibri_sync_stats_t* stats,
+                     key_list_t* theirs, const key_list_t* ours) {
+    sync_buf_t buf = {0};
+    int result = KOLIBRI_ERROR_STORAGE;
+    
+    if (theirs->count > 1) qsort(theirs->keys, theirs->count, KOLIBRI_SYNC_KEY_SIZE, compare_keys);
+    
+    if (!buf_reserve(&buf, 4)) goto done;
+    uint32_t wants = 0;
+    for (uint32_t i = 0; i < theirs->count; i++) {
+        kolibri_formula_t local;
+        uint32_t version = get_u32(theirs->keys[i] + KOLIBRI_ID_SIZE);
+        if (kolibri_formula_get(core, theirs->keys[i], &local) == KOLIBRI_OK &&
+            local.version >= version) {
+            continue;
+        }
+        uint8_t* p = buf_reserve(&buf, KOLIBRI_ID_SIZE);
+        if (!p) goto done;
+        memcpy(p, theirs->keys[i], KOLIBRI_ID_SIZE);
+        wants++;
+    }
+    put_u32(buf.data, wants);
+    
+    size_t push_at = buf.size;
+    if (!buf_reserve(&buf, 4)) goto done;
+    uint32_t pushes = 0;
+    for (uint32_t i = 0; i < ours->count; i++) {
+        kolibri_formula_t local;
+        if (kolibri_formula_get(core, ours->keys[i], &local) != KOLIBRI_OK) continue;
+        if (find_version(theirs, ours->keys[i]) >= (int64_t)local.version) continue;
+        if (put_record(&buf, &local) != KOLIBRI_OK) goto done;
+        pushes++;
+    }
+    put_u32(buf.data + push_at, pushes);
+    
+    result = send_msg(t, stats, SYNC_MSG_PLAN, buf.data, buf.size);
+    if (result == KOLIBRI_OK) stats->formulas_sent += pushes;
+    
+done:
+    free(buf.data);
+    return result;
+}
+
+int kolibri_sync_initiate(kolibri_core_t* core, kolibri_transport_t* transport,
+                          kolibri_sync_stats_t* stats) {
+    if (!core || !transport) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    kolibri_sync_stats_t local_stats;
+    if (!stats) stats = &local_stats;
+    memset(stats, 0, sizeof(*stats));
+    
+    const kolibri_iblt_t* table = kolibri_sync_table(core);
+    sync_buf_t buf = {0};
+    sync_buf_t reply = {0};
+    uint8_t type = 0;
+    int result;
+    
+    /* Offer folds of growing size until the responder can decode one */
+    for (uint32_t size = KOLIBRI_IBLT_MIN_SIZE; ; size *= 2) {
+        kolibri_iblt_t fold;
+        result = kolibri_iblt_fold(table, size, &fold);
+        if (result == KOLIBRI_OK) {
+            result = send_iblt(transport, stats, &fold);
+            kolibri_iblt_free(&fold);
+        }
+        if (result == KOLIBRI_OK) result = recv_msg(transport, stats, &type, &buf);
+        if (result != KOLIBRI_OK) goto done;
+        stats->rounds++;
+        
+        if (type != SYNC_MSG_RETRY) break;
+        if (size < KOLIBRI_IBLT_MAX_SIZE) continue;
+        
+        /* Too different for the table: send every key */
+        uint8_t (*keys)[KOLIBRI_SYNC_KEY_SIZE] = NULL;
+        uint32_t count = 0;
+        result = kolibri_sync_keys(core, &keys, &count);
+        uint8_t* p = result == KOLIBRI_OK ? buf_reserve(&reply, 4 + (size_t)count * KOLIBRI_SYNC_KEY_SIZE) : NULL;
+        if (p) {
+            put_u32(p, count);
+            if (count > 0) memcpy(p + 4, keys, (size_t)count * KOLIBRI_SYNC_KEY_SIZE);
+            result = send_msg(transport, stats, SYNC_MSG_KEYS, reply.data, reply.size);
+        } else if (result == KOLIBRI_OK) {
+            result = KOLIBRI_ERROR_STORAGE;
+        }
+        free(keys);
+        if (result == KOLIBRI_OK) result = recv_msg(transport, stats, &type, &buf);
+        if (result != KOLIBRI_OK) goto done;
+        stats->full_list = 1;
+        break;
+    }
+    
+    if (type != SYNC_MSG_PLAN || buf.size < 4) {
+        result = KOLIBRI_ERROR_TRANSPORT;
+        goto done;
+    }
+    
+    /* Plan: IDs wanted, then records pushed to us */
+    uint32_t wants = get_u32(buf.data);
+    if ((buf.size - 4) / KOLIBRI_ID_SIZE < wants || buf.size - 4 - (size_t)wants * KOLIBRI_ID_SIZE < 4) {
+        result = KOLIBRI_ERROR_TRANSPORT;
+        goto done;
+    }
+    const uint8_t* ids = buf.data + 4;
+    const uint8_t* pushed = ids + (size_t)wants * KOLIBRI_ID_SIZE;
+    
+    reply.size = 0;
+    if (!buf_reserve(&reply, 4)) {
+        result = KOLIBRI_ERROR_STORAGE;
+        goto done;
+    }
+    uint32_t sent = 0;
+    for (uint32_t i = 0; i < wants; i++) {
+        kolibri_formula_t formula;
+        if (kolibri_formula_get(core, ids + (size_t)i * KOLIBRI_ID_SIZE, &formula) != KOLIBRI_OK) continue;
+        if (put_record(&reply, &formula) != KOLIBRI_OK) {
+            result = KOLIBRI_ERROR_STORAGE;
+            goto done;
+        }
+        sent++;
+    }
+    put_u32(reply.data, sent);
+    
+    /* Build the reply before ingesting, which may replace the stored copies */
+    result = send_msg(transport, stats, SYNC_MSG_RECORDS, reply.data, reply.size);
+    if (result != KOLIBRI_OK) goto done;
+    stats->formulas_sent += sent;
+    
+    result = ingest_records(core, pushed + 4, buf.size - (size_t)(pushed + 4 - buf.data),
+                            get_u32(pushed), stats);
+    
+done:
+    free(buf.data);
+    free(reply.data);
+    return result;
+}
+
+int kolibri_sync_respond(kolibri_core_t* core, kolibri_transport_t* transport,
+                         kolibri_sync_stats_t* stats) {
+    if (!core || !transport) return KOLIBRI_ERROR_INVALID_PARAM;
+    
+    kolibri_sync_stats_t local_stats;
+    if (!stats) stats = &local_stats;
+    memset(stats, 0, sizeof(*stats));
+    
+    const kolibri_iblt_t* table = kolibri_sync_table(core);
+    sync_buf_t buf = {0};
+    key_list_t theirs = {0};
+    key_list_t ours = {0};
+    uint8_t type;
+    int result;
+    
+    for (;;) {
+        result = recv_msg(transport, stats, &type, &buf);
+        if (result != KOLIBRI_OK) goto done;
+        theirs.count = 0;
+        ours.count = 0;
+        
+        if (type == SYNC_MSG_IBLT) {
+            stats->rounds++;
+            uint32_t size = buf.size >= 4 ? get_u32(buf.data) : 0;
+            if (size < KOLIBRI_IBLT_MIN_SIZE || size > KOLIBRI_IBLT_MAX_SIZE || (size & (size - 1)) != 0 ||
+                buf.size != 4 + (size_t)KOLIBRI_IBLT_HASHES * size * SYNC_CELL_WIRE_SIZE) {
+                result = KOLIBRI_ERROR_TRANSPORT;
+                goto done;
+            }
+            
+            /* Difference table: theirs - ours */
+            kolibri_iblt_t diff;
+            result = kolibri_iblt_fold(table, size, &diff);
+            if (result != KOLIBRI_OK) goto done;
+            const uint8_t* p = buf.data + 4;
+            for (uint32_t c = 0; c < KOLIBRI_IBLT_HASHES * size; c++) {
+                kolibri_iblt_cell_t* cell = &diff.cells[c];
+                cell->count = (int32_t)get_u32(p) - cell->count;
+                for (int i = 0; i < KOLIBRI_SYNC_KEY_SIZE; i++) cell->key[i] ^= p[4 + i];
+                cell->check ^= get_u64(p + 4 + KOLIBRI_SYNC_KEY_SIZE);
+                p += SYNC_CELL_WIRE_SIZE;
+            }
+            result = iblt_peel(&diff, &theirs, &ours);
+            kolibri_iblt_free(&diff);
+            
+            if (result == KOLIBRI_ERROR) {
+                result = send_msg(transport, stats, SYNC_MSG_RETRY, NULL, 0);
+                if (result != KOLIBRI_OK) goto done;
+                continue;
+            }
+            if (result != KOLIBRI_OK) goto done;
+        } else if (type == SYNC_MSG_KEYS) {
+            /* Full list: diff it against every key we hold */
+            uint32_t count = buf.size >= 4 ? get_u32(buf.data) : 0;
+            if (buf.size < 4 || (buf.size - 4) / KOLIBRI_SYNC_KEY_SIZE != count ||
+                (buf.size - 4) % KOLIBRI_SYNC_KEY_SIZE != 0) {
+                result = KOLIBRI_ERROR_TRANSPORT;
+                goto done;
+            }
+            key_list_t all = {(uint8_t (*)[KOLIBRI_SYNC_KEY_SIZE])(buf.data + 4), count, count};
+            if (all.count > 1) qsort(all.keys, all.count, KOLIBRI_SYNC_KEY_SIZE, compare_keys);
+            
+            uint8_t (*mine)[KOLIBRI_SYNC_KEY_SIZE] = NULL;
+            uint32_t mine_count = 0;
+            result = kolibri_sync_keys(core, &mine, &mine_count);
+            for (uint32_t i = 0; i < mine_count && result == KOLIBRI_OK; i++) {
+                if (find_version(&all, mine[i]) != (int64_t)get_u32(mine[i] + KOLIBRI_ID_SIZE)) {
+                    result = key_list_add(&ours, mine[i]);
+                }
+            }
+            free(mine);
+            for (uint32_t i = 0; i < all.count && result == KOLIBRI_OK; i++) {
+                kolibri_formula_t local;
+                if (kolibri_formula_get(core, all.keys[i], &local) != KOLIBRI_OK ||
+                    local.version != get_u32(all.keys[i] + KOLIBRI_ID_SIZE)) {
+                    result = key_list_add(&theirs, all.keys[i]);
+                }
+            }
+            if (result != KOLIBRI_OK) goto done;
+            stats->full_list = 1;
+        } else {
+            result = KOLIBRI_ERROR_TRANSPORT;
+            goto done;
+        }
+        break;
+    }
+    
+    result = send_plan(core, transport, stats, &theirs, &ours);
+    if (result != KOLIBRI_OK) goto done;
+    
+    /* Records we asked for */
+    result = recv_msg(transport, stats, &type, &buf);
+    if (result != KOLIBRI_OK) goto done;
+    if (type != SYNC_MSG_RECORDS || buf.size < 4) {
+        result = KOLIBRI_ERROR_TRANSPORT;
+        goto done;
+    }
+    result = ingest_records(core, buf.data + 4, buf.size - 4, get_u32(buf.data), stats);
+    
+done:
+    free(buf.data);
+    free(theirs.keys);
+    free(ours.keys);
+    return result;
+}
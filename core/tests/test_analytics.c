@@ -0,0 +1,295 @@
+/**
+ * KOLIBRI.AI Tests - Formula sketches, similarity search and duplicate rejection
+ */
+
+#include "kolibri_analytics.h"
+#include "test_util.h"
+#include <string.h>
+#include <stdio.h>
+
+#define FAMILIES 400
+#define TERMS 16
+#define IMPORT_PATH "test_analytics.kfr"
+
+static uint32_t rng_state = 4242;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t constants[FAMILIES + 1][TERMS];
+
+static void make_constants(void) {
+    for (int f = 0; f <= FAMILIES; f++) {
+        for (int t = 0; t < TERMS; t++) constants[f][t] = 1000 + rng() % 1000000;
+    }
+}
+
+/* Family f: TERMS products of a constant and an input joined by + and -.
+ * The constants are unique to the family, so two families share few
+ * shingles while changing one constant leaves most of them in place. */
+static uint32_t family_code(char* code, uint32_t f, int changed_term, uint32_t changed_value) {
+    int len = sprintf(code, "y =");
+    for (int t = 0; t < TERMS; t++) {
+        uint32_t bits = (f * 2654435761u) >> t;
+        uint32_t constant = t == changed_term ? changed_value : constants[f][t];
+        len += sprintf(code + len, "%s %u %c %c", t == 0 ? "" : bits & 1 ? " +" : " -", constant,
+                       bits & 2 ? '*' : '/', bits & 4 ? 'x' : 'z');
+    }
+    return (uint32_t)len;
+}
+
+static void make_formula(kolibri_formula_t* formula, char* code, uint32_t f, uint32_t n) {
+    memset(formula, 0, sizeof(*formula));
+    memcpy(formula->id, &n, sizeof(n));
+    formula->id[31] = 0x3C;
+    formula->version = 1;
+    formula->input_count = 2;
+    strcpy(formula->inputs[0], "x");
+    strcpy(formula->inputs[1], "z");
+    formula->output_count = 1;
+    strcpy(formula->outputs[0], "y");
+    formula->code_size = family_code(code, f, -1, 0);
+    formula->code = (uint8_t*)code;
+}
+
+/* The same formula with its parameters renamed, spacing dropped and a
+ * comment added */
+static void make_renamed(kolibri_formula_t* formula, char* code, const kolibri_formula_t* original) {
+    *formula = *original;
+    strcpy(formula->inputs[0], "alpha");
+    strcpy(formula->inputs[1], "beta");
+    strcpy(formula->outputs[0], "out");
+    
+    size_t len = 0;
+    for (uint32_t i = 0; i < original->code_size; i++) {
+        uint8_t c = original->code[i];
+        const char* name = c == 'x' ? "alpha" : c == 'z' ? "beta" : c == 'y' ? "out" : NULL;
+        if (name) {
+            len += (size_t)sprintf(code + len, "%s", name);
+        } else if (c != ' ') {
+            code[len++] = (char)c;
+        }
+    }
+    len += (size_t)sprintf(code + len, " // renamed\n");
+    formula->code_size = (uint32_t)len;
+    formula->code = (uint8_t*)code;
+}
+
+static void test_sketch(void) {
+    char code[512], renamed_code[512], variant_code[512], other_code[512];
+    kolibri_formula_t formula, renamed, variant, other;
+    kolibri_sketch_t a, b;
+    make_formula(&formula, code, 0, 0);
+    make_renamed(&renamed, renamed_code, &formula);
+    
+    kolibri_formula_sketch(&formula, &a);
+    kolibri_formula_sketch(&renamed, &b);
+    CHECK(memcmp(a.structure, b.structure, sizeof(a.structure)) == 0);
+    CHECK(memcmp(a.minhash, b.minhash, sizeof(a.minhash)) == 0);
+    CHECK(kolibri_sketch_similarity(&a, &b) == 1.0f);
+    
+    /* One changed constant: a different structure that is still close */
+    variant = formula;
+    variant.code_size = family_code(variant_code, 0, 5, 7);
+    variant.code = (uint8_t*)variant_code;
+    kolibri_formula_sketch(&variant, &b);
+    CHECK(memcmp(a.structure, b.structure, sizeof(a.structure)) != 0);
+    float similarity = kolibri_sketch_similarity(&a, &b);
+    CHECK(similarity > 0.5f && similarity < 1.0f);
+    
+    /* Another family, or another arity, is far away */
+    make_formula(&other, other_code, 1, 1);
+    kolibri_formula_sketch(&other, &b);
+    CHECK(kolibri_sketch_similarity(&a, &b) < 0.3f);
+    other = formula;
+    other.input_count = 3;
+    strcpy(other.inputs[2], "w");
+    kolibri_formula_sketch(&other, &b);
+    CHECK(memcmp(a.structure, b.structure, sizeof(a.structure)) != 0);
+    
+    /* Code shorter than a shingle is one shingle of its tokens */
+    other = formula;
+    other.code_size = 3;
+    kolibri_formula_sketch(&other, &a);
+    other.code_size = 0;
+    kolibri_formula_sketch(&other, &b);
+    CHECK(memcmp(a.minhash, b.minhash, sizeof(a.minhash)) != 0);
+}
+
+/* Query a one-constant variant of family f; returns how many came back
+ * and checks the first is stored ID n */
+static uint32_t query_variant(kolibri_core_t* core, uint32_t f, uint32_t n, float threshold) {
+    char code[512];
+    kolibri_formula_t variant;
+    make_formula(&variant, code, f, 0xFFFFFF);
+    variant.code_size = family_code(code, f, (int)(f % TERMS), 1 + f);
+    
+    kolibri_similar_t results[4];
+    uint32_t count = 99;
+    CHECK(kolibri_formula_find_similar(core, &variant, threshold, results, 4, &count) == KOLIBRI_OK);
+    if (count > 0) {
+        CHECK(memcmp(results[0].id, &n, sizeof(n)) == 0 && results[0].id[31] == 0x3C);
+        CHECK(results[0].similarity > threshold && results[0].similarity < 1.0f);
+    }
+    return count;
+}
+
+static void test_find_similar(void) {
+    kolibri_core_t* core = kolibri_init(NULL);
+    REQUIRE(core);
+    for (uint32_t f = 0; f < FAMILIES; f++) {
+        kolibri_formula_t formula;
+        char code[512];
+        make_formula(&formula, code, f, f);
+        REQUIRE(kolibri_formula_create(core, &formula) == KOLIBRI_OK);
+    }
+    
+    /* Every variant finds its own family and nothing else */
+    int found = 0;
+    for (uint32_t f = 0; f < FAMILIES; f++) found += query_variant(core, f, f, 0.5f) == 1;
+    CHECK(found == FAMILIES);
+    
+    /* A renamed copy matches at 1; a stored formula does not find itself */
+    kolibri_formula_t formula, renamed;
+    char code[512], renamed_code[512];
+    make_formula(&formula, code, 7, 7);
+    make_renamed(&renamed, renamed_code, &formula);
+    memset(renamed.id, 0xEE, sizeof(renamed.id));
+    kolibri_similar_t results[4];
+    uint32_t count = 0;
+    CHECK(kolibri_formula_find_similar(core, &renamed, 1.0f, results, 4, &count) == KOLIBRI_OK);
+    CHECK(count == 1 && memcmp(results[0].id, formula.id, KOLIBRI_ID_SIZE) == 0 && results[0].similarity == 1.0f);
+    CHECK(kolibri_formula_find_similar(core, &formula, 0.5f, results, 4, &count) == KOLIBRI_OK);
+    CHECK(count == 0);
+    
+    /* A family that is not stored finds nothing */
+    make_formula(&formula, code, FAMILIES, FAMILIES);
+    CHECK(kolibri_formula_find_similar(core, &formula, 0.3f, results, 4, &count) == KOLIBRI_OK);
+    CHECK(count == 0);
+    
+    /* Deleted formulas leave the index; updates replace their sketch */
+    for (uint32_t f = 0; f < FAMILIES; f += 2) {
+        uint32_t n = f;
+        uint8_t id[KOLIBRI_ID_SIZE] = { 0 };
+        memcpy(id, &n, sizeof(n));
+        id[31] = 0x3C;
+        REQUIRE(kolibri_formula_delete(core, id) == KOLIBRI_OK);
+    }
+    make_formula(&formula, code, FAMILIES, 1);
+    REQUIRE(kolibri_formula_update(core, &formula) == KOLIBRI_OK);
+    int correct = 0;
+    for (uint32_t f = 0; f < FAMILIES; f++) {
+        correct += query_variant(core, f, f, 0.5f) == (f % 2 == 0 || f == 1 ? 0u : 1u);
+    }
+    CHECK(correct == FAMILIES);
+    CHECK(query_variant(core, FAMILIES, 1, 0.5f) == 1);
+    
+    /* Deleted slots are reused by new formulas */
+    for (uint32_t f = 0; f < FAMILIES; f += 2) {
+        make_formula(&formula, code, f, f);
+        REQUIRE(kolibri_formula_create(core, &formula) == KOLIBRI_OK);
+    }
+    found = 0;
+    for (uint32_t f = 2; f < FAMILIES; f++) found += query_variant(core, f, f, 0.5f) == 1;
+    CHECK(found == FAMILIES - 2);
+    
+    CHECK(kolibri_formula_find_similar(NULL, &formula, 0.5f, results, 4, &count) == KOLIBRI_ERROR_INVALID_PARAM);
+    CHECK(kolibri_formula_find_similar(core, &formula, -1.0f, results, 4, &count) == KOLIBRI_ERROR_INVALID_PARAM);
+    kolibri_destroy(core);
+}
+
+static uint64_t formula_count(kolibri_core_t* core) {
+    kolibri_metrics_t metrics;
+    kolibri_get_metrics(core, &metrics);
+    return metrics.formula_count;
+}
+
+static void test_reject(void) {
+    kolibri_core_t* core = kolibri_init(NULL);
+    REQUIRE(core);
+    CHECK(kolibri_set_duplicate_threshold(core, -0.5f) == KOLIBRI_ERROR_INVALID_PARAM);
+    CHECK(kolibri_set_duplicate_threshold(core, 1.0f) == KOLIBRI_OK);
+    
+    kolibri_formula_t formula, copy;
+    char code[512], copy_code[512];
+    make_formula(&formula, code, 3, 3);
+    REQUIRE(kolibri_formula_create(core, &formula) == KOLIBRI_OK);
+    
+    /* At 1 a renamed copy under a new ID is refused, a variant is not */
+    make_renamed(&copy, copy_code, &formula);
+    copy.id[0] = 100;
+    CHECK(kolibri_formula_create(core, &copy) == KOLIBRI_ERROR_DUPLICATE);
+    kolibri_formula_t got;
+    CHECK(kolibri_formula_get(core, copy.id, &got) == KOLIBRI_ERROR_NOT_FOUND);
+    CHECK(formula_count(core) == 1);
+    kolibri_formula_t variant = formula;
+    variant.id[0] = 101;
+    variant.code_size = family_code(copy_code, 3, 0, 5);
+    variant.code = (uint8_t*)copy_code;
+    CHECK(kolibri_formula_create(core, &variant) == KOLIBRI_OK);
+    
+    /* Below 1 the variant counts too; other families are still accepted */
+    CHECK(kolibri_set_duplicate_threshold(core, 0.5f) == KOLIBRI_OK);
+    variant.id[0] = 102;
+    variant.code_size = family_code(copy_code, 3, 1, 5);
+    CHECK(kolibri_formula_create(core, &variant) == KOLIBRI_ERROR_DUPLICATE);
+    make_formula(&copy, copy_code, 4, 4);
+    CHECK(kolibri_formula_create(core, &copy) == KOLIBRI_OK);
+    CHECK(formula_count(core) == 3);
+    
+    /* Updates and re-creates of a stored ID are never refused */
+    make_formula(&copy, copy_code, 3, 4);
+    CHECK(kolibri_formula_update(core, &copy) == KOLIBRI_OK);
+    make_renamed(&copy, copy_code, &formula);
+    CHECK(kolibri_formula_update(core, &copy) == KOLIBRI_OK);
+    CHECK(kolibri_formula_create(core, &formula) == KOLIBRI_OK);
+    copy.id[0] = 103;
+    CHECK(kolibri_formula_update(core, &copy) == KOLIBRI_OK);
+    CHECK(kolibri_formula_get(core, copy.id, &got) == KOLIBRI_OK);
+    
+    /* Once the originals are deleted the copy is accepted */
+    CHECK(kolibri_set_duplicate_threshold(core, 1.0f) == KOLIBRI_OK);
+    copy.id[0] = 104;
+    CHECK(kolibri_formula_create(core, &copy) == KOLIBRI_ERROR_DUPLICATE);
+    static const uint8_t deleted[] = { 3, 4, 103 };
+    for (int k = 0; k < 3; k++) {
+        uint8_t id[KOLIBRI_ID_SIZE];
+        memcpy(id, formula.id, KOLIBRI_ID_SIZE);
+        id[0] = deleted[k];
+        REQUIRE(kolibri_formula_delete(core, id) == KOLIBRI_OK);
+    }
+    CHECK(kolibri_formula_create(core, &copy) == KOLIBRI_OK);
+    
+    /* Import stores duplicates regardless */
+    CHECK(kolibri_storage_export(core, IMPORT_PATH) == KOLIBRI_OK);
+    kolibri_core_t* other = kolibri_init(NULL);
+    REQUIRE(other);
+    copy.id[0] = 106;
+    REQUIRE(kolibri_formula_create(other, &copy) == KOLIBRI_OK);
+    CHECK(kolibri_set_duplicate_threshold(other, 1.0f) == KOLIBRI_OK);
+    CHECK(kolibri_storage_import(other, IMPORT_PATH) == KOLIBRI_OK);
+    copy.id[0] = 104;
+    CHECK(kolibri_formula_get(other, copy.id, &got) == KOLIBRI_OK);
+    variant.id[0] = 101;
+    CHECK(kolibri_formula_get(other, variant.id, &got) == KOLIBRI_OK);
+    kolibri_destroy(other);
+    remove(IMPORT_PATH);
+    
+    /* 0 allows duplicates again */
+    CHECK(kolibri_set_duplicate_threshold(core, 0.0f) == KOLIBRI_OK);
+    copy.id[0] = 105;
+    CHECK(kolibri_formula_create(core, &copy) == KOLIBRI_OK);
+    kolibri_destroy(core);
+}
+
+int main(void) {
+    make_constants();
+    test_sketch();
+    test_find_similar();
+    test_reject();
+    return TEST_RESULT();
+}
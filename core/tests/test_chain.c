@@ -0,0 +1,479 @@
+/**
+ * KOLIBRI.AI Tests - Compact block encoding, the block log and Merkle proofs
+ */
+
+#include "kolibri_chain.h"
+#include "test_util.h"
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHAIN_DIR "test_chain.d"
+#define LOG_PATH CHAIN_DIR "/blocks.log"
+#define EXPORT_A "test_chain_a.kch"
+#define EXPORT_B "test_chain_b.kch"
+#define DAMAGED "test_chain_damaged.kch"
+
+static const uint8_t private_key[32] = { 2, 7 };
+
+static long file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+/* Three IDs derived from seed, the second and third one bit apart */
+static void make_ids(uint8_t ids[3][32], int seed) {
+    memset(ids, seed, 3 * 32);
+    ids[1][0] ^= 1;
+    ids[2][0] ^= 2;
+}
+
+/* A fresh log holding a genesis block and count - 1 signed blocks */
+static void build_log(int count, int seed) {
+    remove(LOG_PATH);
+    mkdir(CHAIN_DIR, 0755);
+    kolibri_chain_t* chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    for (int b = 1; b < count; b++) {
+        uint8_t ids[3][32];
+        make_ids(ids, seed + b);
+        kolibri_block_t block;
+        REQUIRE(chain_create_block(chain, private_key, (const uint8_t (*)[32])ids, 3, &block) == CHAIN_OK);
+        REQUIRE(chain_add_block(chain, &block) == CHAIN_OK);
+    }
+    chain_destroy(chain);
+}
+
+static uint32_t block_count(kolibri_chain_t* chain) {
+    chain_info_t info;
+    REQUIRE(chain_get_info(chain, &info) == CHAIN_OK);
+    return info.block_count;
+}
+
+static void flip_byte(const char* path, long offset) {
+    FILE* f = fopen(path, "r+b");
+    REQUIRE(f);
+    fseek(f, offset, SEEK_SET);
+    int c = fgetc(f);
+    fseek(f, offset, SEEK_SET);
+    fputc(c ^ 0x40, f);
+    fclose(f);
+}
+
+static void test_encoding(void) {
+    kolibri_chain_t* chain = chain_init(NULL);
+    REQUIRE(chain);
+    uint8_t ids[3][32];
+    make_ids(ids, 5);
+    kolibri_block_t block;
+    REQUIRE(chain_create_block(chain, private_key, (const uint8_t (*)[32])ids, 3, &block) == CHAIN_OK);
+    
+    /* The encoding holds exactly formula_count IDs */
+    uint8_t buf[CHAIN_BLOCK_ENCODED_SIZE(3)];
+    CHECK(chain_block_encode(&block, buf, sizeof(buf) - 1) == 0);
+    REQUIRE(chain_block_encode(&block, buf, sizeof(buf)) == sizeof(buf));
+    
+    kolibri_block_t decoded;
+    size_t consumed = 0;
+    REQUIRE(chain_block_decode(buf, sizeof(buf), &decoded, &consumed) == CHAIN_OK);
+    CHECK(consumed == sizeof(buf));
+    CHECK(decoded.block_number == block.block_number && decoded.timestamp == block.timestamp);
+    CHECK(decoded.formula_count == 3 && memcmp(decoded.formula_ids, ids, sizeof(ids)) == 0);
+    CHECK(memcmp(decoded.merkle_root, block.merkle_root, CHAIN_HASH_SIZE) == 0);
+    CHECK(memcmp(decoded.signature, block.signature, CHAIN_SIGNATURE_SIZE) == 0);
+    
+    uint8_t hash[CHAIN_HASH_SIZE], decoded_hash[CHAIN_HASH_SIZE];
+    CHECK(chain_block_hash(&block, hash) == CHAIN_OK);
+    CHECK(chain_block_hash(&decoded, decoded_hash) == CHAIN_OK);
+    CHECK(memcmp(hash, decoded_hash, CHAIN_HASH_SIZE) == 0);
+    CHECK(chain_block_decode(buf, sizeof(buf) - 1, &decoded, NULL) == CHAIN_ERROR);
+    
+    CHECK(chain_add_block(chain, &block) == CHAIN_OK);
+    CHECK(chain_verify_block(chain, &block) == CHAIN_OK);
+    chain_destroy(chain);
+}
+
+static void test_log_reload(void) {
+    build_log(7, 1);
+    long size = file_size(LOG_PATH);
+    REQUIRE(size > 0);
+    
+    /* Every block comes back from the log */
+    kolibri_chain_t* chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    CHECK(block_count(chain) == 7);
+    kolibri_block_t block;
+    CHECK(chain_get_block(chain, 4, &block) == CHAIN_OK);
+    uint8_t ids[3][32];
+    make_ids(ids, 1 + 4);
+    CHECK(block.formula_count == 3 && memcmp(block.formula_ids, ids, sizeof(ids)) == 0);
+    CHECK(chain_verify_block(chain, &block) == CHAIN_OK);
+    chain_destroy(chain);
+    
+    /* A torn final record is dropped and the log cut back */
+    CHECK(truncate(LOG_PATH, size - 10) == 0);
+    chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    CHECK(block_count(chain) == 6);
+    chain_destroy(chain);
+    CHECK(file_size(LOG_PATH) < size - 10);
+    chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    CHECK(block_count(chain) == 6);
+    chain_destroy(chain);
+    
+    /* A damaged block in the middle fails init and leaves the file alone */
+    build_log(7, 1);
+    flip_byte(LOG_PATH, size / 3);
+    CHECK(chain_init(CHAIN_DIR) == NULL);
+    CHECK(file_size(LOG_PATH) == size);
+    
+    /* So does a bad header in a record that is all there */
+    build_log(7, 1);
+    flip_byte(LOG_PATH, size - (long)CHAIN_BLOCK_ENCODED_SIZE(3) + 108 + 3);
+    CHECK(chain_init(CHAIN_DIR) == NULL);
+    CHECK(file_size(LOG_PATH) == size);
+    
+    /* And an unknown magic */
+    build_log(7, 1);
+    flip_byte(LOG_PATH, 0);
+    CHECK(chain_init(CHAIN_DIR) == NULL);
+    CHECK(file_size(LOG_PATH) == size);
+    
+    /* An empty log starts over from a fresh genesis */
+    CHECK(truncate(LOG_PATH, 0) == 0);
+    chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    CHECK(block_count(chain) == 1);
+    chain_destroy(chain);
+    
+    remove(LOG_PATH);
+    rmdir(CHAIN_DIR);
+}
+
+static void test_import(void) {
+    build_log(5, 1);
+    kolibri_chain_t* chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    REQUIRE(chain_export(chain, EXPORT_A) == CHAIN_OK);
+    chain_destroy(chain);
+    build_log(5, 9);
+    chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    REQUIRE(chain_export(chain, EXPORT_B) == CHAIN_OK);
+    chain_destroy(chain);
+    
+    /* Importing the same chain twice is fine; a conflicting one is not */
+    kolibri_chain_t* merged = chain_init(NULL);
+    REQUIRE(merged);
+    CHECK(chain_import(merged, EXPORT_A) == CHAIN_OK);
+    CHECK(block_count(merged) == 5);
+    CHECK(chain_import(merged, EXPORT_A) == CHAIN_OK);
+    CHECK(chain_import(merged, EXPORT_B) == CHAIN_ERROR_VERIFICATION);
+    CHECK(block_count(merged) == 5);
+    
+    /* An empty file has no header to read */
+    FILE* f = fopen(EXPORT_B, "wb");
+    REQUIRE(f);
+    fclose(f);
+    CHECK(chain_import(merged, EXPORT_B) == CHAIN_ERROR);
+    chain_destroy(merged);
+    
+    remove(EXPORT_A);
+    remove(EXPORT_B);
+    remove(LOG_PATH);
+    rmdir(CHAIN_DIR);
+}
+
+/* Leaf counts of the blocks holding proofs; odd sizes promote nodes */
+static const uint32_t leaf_counts[] = { 1, 2, 3, 5, 7, 130 };
+#define MERKLE_BLOCKS (sizeof(leaf_counts) / sizeof(leaf_counts[0]))
+
+/* The block and leaf committing ID (block, leaf); block MERKLE_BLOCKS + 1
+ * commits leaf 2 of the five-leaf block again */
+static void merkle_id(uint8_t* id, uint32_t block, uint32_t leaf) {
+    memset(id, 0, 32);
+    memcpy(id, &leaf, sizeof(leaf));
+    memcpy(id + 4, &block, sizeof(block));
+    id[31] = 0x77;
+}
+
+static void expected_position(uint32_t block, uint32_t leaf, uint32_t* block_number, uint32_t* leaf_index) {
+    *block_number = block;
+    *leaf_index = leaf;
+    if (leaf_counts[block - 1] == 5 && leaf == 2) {
+        *block_number = MERKLE_BLOCKS + 1;
+        *leaf_index = 1;
+    }
+}
+
+/* Genesis, one block per leaf count, then a block re-committing an ID */
+static void add_merkle_blocks(kolibri_chain_t* chain) {
+    static uint8_t ids[130][32];
+    kolibri_block_t block;
+    for (uint32_t b = 1; b <= MERKLE_BLOCKS; b++) {
+        for (uint32_t i = 0; i < leaf_counts[b - 1]; i++) merkle_id(ids[i], b, i);
+        REQUIRE(chain_create_block(chain, NULL, (const uint8_t (*)[32])ids, leaf_counts[b - 1], &block) == CHAIN_OK);
+        REQUIRE(chain_add_block(chain, &block) == CHAIN_OK);
+    }
+    uint32_t five = 0;
+    while (leaf_counts[five] != 5) five++;
+    merkle_id(ids[0], 999, 0);
+    merkle_id(ids[1], five + 1, 2);
+    REQUIRE(chain_create_block(chain, NULL, (const uint8_t (*)[32])ids, 2, &block) == CHAIN_OK);
+    REQUIRE(chain_add_block(chain, &block) == CHAIN_OK);
+}
+
+/* Every committed ID is indexed at its newest block and proves against it */
+static int index_matches(kolibri_chain_t* chain) {
+    int ok = 1;
+    for (uint32_t b = 1; b <= MERKLE_BLOCKS; b++) {
+        for (uint32_t i = 0; i < leaf_counts[b - 1]; i++) {
+            uint8_t id[32];
+            uint32_t block_number, leaf_index, want_block, want_leaf;
+            merkle_id(id, b, i);
+            expected_position(b, i, &want_block, &want_leaf);
+            if (chain_find_formula(chain, id, &block_number, &leaf_index) != CHAIN_OK ||
+                block_number != want_block || leaf_index != want_leaf) {
+                ok = 0;
+                continue;
+            }
+            
+            chain_merkle_proof_t proof;
+            kolibri_block_t block;
+            if (chain_merkle_prove(chain, id, &proof) != CHAIN_OK ||
+                chain_get_block(chain, block_number, &block) != CHAIN_OK ||
+                proof.block_number != block_number || proof.leaf_index != leaf_index ||
+                proof.leaf_count != block.formula_count ||
+                chain_merkle_verify(block.merkle_root, id, &proof) != CHAIN_OK) {
+                ok = 0;
+            }
+        }
+    }
+    return ok;
+}
+
+static void test_merkle(void) {
+    kolibri_chain_t* chain = chain_init(NULL);
+    REQUIRE(chain);
+    add_merkle_blocks(chain);
+    CHECK(index_matches(chain));
+    
+    /* A single leaf is its own root */
+    uint8_t id[32];
+    chain_merkle_proof_t proof;
+    merkle_id(id, 1, 0);
+    REQUIRE(chain_merkle_prove(chain, id, &proof) == CHAIN_OK);
+    CHECK(proof.leaf_count == 1 && proof.sibling_count == 0);
+    
+    /* Tampered siblings, leaves and positions are rejected */
+    kolibri_block_t block;
+    uint32_t last = MERKLE_BLOCKS;
+    REQUIRE(chain_get_block(chain, last, &block) == CHAIN_OK);
+    for (uint32_t leaf = 0; leaf < leaf_counts[last - 1]; leaf += 43) {
+        merkle_id(id, last, leaf);
+        REQUIRE(chain_merkle_prove(chain, id, &proof) == CHAIN_OK);
+        CHECK(proof.sibling_count > 0 && proof.sibling_count <= 8);
+        for (uint32_t s = 0; s < proof.sibling_count; s++) {
+            proof.siblings[s][s % CHAIN_HASH_SIZE] ^= 1;
+            CHECK(chain_merkle_verify(block.merkle_root, id, &proof) == CHAIN_ERROR_VERIFICATION);
+            proof.siblings[s][s % CHAIN_HASH_SIZE] ^= 1;
+        }
+        CHECK(chain_merkle_verify(block.merkle_root, id, &proof) == CHAIN_OK);
+        
+        uint8_t other[32];
+        merkle_id(other, last, leaf + 1);
+        CHECK(chain_merkle_verify(block.merkle_root, other, &proof) == CHAIN_ERROR_VERIFICATION);
+        
+        uint32_t leaf_index = proof.leaf_index;
+        proof.leaf_index = leaf_index ^ 1;
+        CHECK(chain_merkle_verify(block.merkle_root, id, &proof) == CHAIN_ERROR_VERIFICATION);
+        proof.leaf_index = proof.leaf_count;
+        CHECK(chain_merkle_verify(block.merkle_root, id, &proof) == CHAIN_ERROR_VERIFICATION);
+        proof.leaf_index = leaf_index;
+    }
+    
+    /* Unknown IDs are not indexed */
+    merkle_id(id, 12345, 0);
+    CHECK(chain_find_formula(chain, id, NULL, NULL) == CHAIN_ERROR_NOT_FOUND);
+    CHECK(chain_merkle_prove(chain, id, &proof) == CHAIN_ERROR_NOT_FOUND);
+    
+    /* The index is rebuilt from an import and from the block log */
+    REQUIRE(chain_export(chain, EXPORT_A) == CHAIN_OK);
+    chain_destroy(chain);
+    chain = chain_init(NULL);
+    REQUIRE(chain);
+    CHECK(chain_import(chain, EXPORT_A) == CHAIN_OK);
+    CHECK(index_matches(chain));
+    chain_destroy(chain);
+    
+    remove(LOG_PATH);
+    mkdir(CHAIN_DIR, 0755);
+    chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    add_merkle_blocks(chain);
+    chain_destroy(chain);
+    chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    CHECK(block_count(chain) == MERKLE_BLOCKS + 2);
+    CHECK(index_matches(chain));
+    chain_destroy(chain);
+    
+    remove(EXPORT_A);
+    remove(LOG_PATH);
+    rmdir(CHAIN_DIR);
+}
+
+/* Blocks for whole-chain verification: b holds 1 + b % 8 IDs and odd
+ * blocks are signed */
+#define VERIFY_BLOCKS 300
+
+static uint32_t verify_ids(uint32_t b) {
+    return b == 0 ? 0 : 1 + b % 8;
+}
+
+static void add_verify_blocks(kolibri_chain_t* chain, uint32_t from, uint32_t to) {
+    uint8_t ids[8][32];
+    for (uint32_t b = from; b < to; b++) {
+        for (uint32_t i = 0; i < verify_ids(b); i++) {
+            memset(ids[i], (int)i, 32);
+            memcpy(ids[i], &b, sizeof(b));
+        }
+        kolibri_block_t block;
+        REQUIRE(chain_create_block(chain, b % 2 ? private_key : NULL, (const uint8_t (*)[32])ids,
+                                   verify_ids(b), &block) == CHAIN_OK);
+        REQUIRE(chain_add_block(chain, &block) == CHAIN_OK);
+    }
+}
+
+/* Offset of block b in an export */
+static long export_offset(uint32_t b) {
+    long offset = 8;
+    for (uint32_t i = 0; i < b; i++) offset += (long)CHAIN_BLOCK_ENCODED_SIZE(verify_ids(i));
+    return offset;
+}
+
+static uint8_t* read_file(const char* path, long* size) {
+    FILE* f = fopen(path, "rb");
+    REQUIRE(f);
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* bytes = (uint8_t*)malloc((size_t)*size);
+    REQUIRE(bytes && fread(bytes, 1, (size_t)*size, f) == (size_t)*size);
+    fclose(f);
+    return bytes;
+}
+
+static void write_file(const char* path, const uint8_t* bytes, long size) {
+    FILE* f = fopen(path, "wb");
+    REQUIRE(f);
+    REQUIRE(fwrite(bytes, 1, (size_t)size, f) == (size_t)size);
+    fclose(f);
+}
+
+/* Verify with one thread and with eight; both must report the same */
+static int verify(const char* path, const chain_checkpoint_t* checkpoint, chain_verify_report_t* report) {
+    chain_verify_report_t threaded;
+    int result = chain_verify_file(path, checkpoint, 1, report);
+    CHECK(chain_verify_file(path, checkpoint, 8, &threaded) == result);
+    CHECK(memcmp(report, &threaded, sizeof(threaded)) == 0);
+    return result;
+}
+
+/* A copy of the export with one byte of block b flipped */
+static void expect_failure(const uint8_t* bytes, long size, uint32_t b, long at, int stage) {
+    uint8_t* damaged = (uint8_t*)malloc((size_t)size);
+    REQUIRE(damaged);
+    memcpy(damaged, bytes, (size_t)size);
+    damaged[export_offset(b) + at] ^= 0x10;
+    write_file(DAMAGED, damaged, size);
+    free(damaged);
+    
+    chain_verify_report_t report;
+    CHECK(verify(DAMAGED, NULL, &report) == CHAIN_ERROR_VERIFICATION);
+    CHECK(report.failed_block == b && report.failed_stage == stage);
+    CHECK(report.blocks_verified == b && report.last.block_number == b - 1);
+}
+
+static void test_verify_file(void) {
+    remove(LOG_PATH);
+    mkdir(CHAIN_DIR, 0755);
+    kolibri_chain_t* chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    add_verify_blocks(chain, 1, VERIFY_BLOCKS);
+    chain_info_t info;
+    REQUIRE(chain_get_info(chain, &info) == CHAIN_OK);
+    REQUIRE(chain_export(chain, EXPORT_A) == CHAIN_OK);
+    chain_destroy(chain);
+    
+    /* A clean export and a clean log */
+    chain_verify_report_t report;
+    CHECK(verify(EXPORT_A, NULL, &report) == CHAIN_OK);
+    CHECK(report.blocks_verified == VERIFY_BLOCKS && report.last.block_number == VERIFY_BLOCKS - 1);
+    CHECK(memcmp(report.last.hash, info.latest_hash, CHAIN_HASH_SIZE) == 0);
+    CHECK(verify(LOG_PATH, NULL, &report) == CHAIN_OK);
+    CHECK(report.blocks_verified == VERIFY_BLOCKS);
+    CHECK(memcmp(report.last.hash, info.latest_hash, CHAIN_HASH_SIZE) == 0);
+    
+    long size;
+    uint8_t* bytes = read_file(EXPORT_A, &size);
+    
+    /* A file cut short inside block 200 */
+    write_file(DAMAGED, bytes, export_offset(200) + 50);
+    CHECK(verify(DAMAGED, NULL, &report) == CHAIN_ERROR_VERIFICATION);
+    CHECK(report.failed_block == 200 && report.failed_stage == CHAIN_STAGE_READ);
+    
+    /* An ID no longer matches merkle_root; a signature is damaged; an
+     * unsigned block points at the wrong predecessor */
+    expect_failure(bytes, size, 150, CHAIN_BLOCK_HEADER_SIZE + 5, CHAIN_STAGE_MERKLE);
+    expect_failure(bytes, size, 77, (long)CHAIN_BLOCK_ENCODED_SIZE(verify_ids(77)) - 10, CHAIN_STAGE_SIGNATURE);
+    expect_failure(bytes, size, 220, 3, CHAIN_STAGE_LINK);
+    
+    /* Resume from the report of a shorter chain */
+    chain = chain_init(CHAIN_DIR);
+    REQUIRE(chain);
+    add_verify_blocks(chain, VERIFY_BLOCKS, VERIFY_BLOCKS + 100);
+    REQUIRE(chain_get_info(chain, &info) == CHAIN_OK);
+    REQUIRE(chain_export(chain, EXPORT_B) == CHAIN_OK);
+    chain_destroy(chain);
+    
+    CHECK(verify(EXPORT_A, NULL, &report) == CHAIN_OK);
+    chain_checkpoint_t checkpoint = report.last;
+    CHECK(verify(EXPORT_B, &checkpoint, &report) == CHAIN_OK);
+    CHECK(report.blocks_verified == 100 && report.last.block_number == VERIFY_BLOCKS + 99);
+    CHECK(memcmp(report.last.hash, info.latest_hash, CHAIN_HASH_SIZE) == 0);
+    CHECK(verify(LOG_PATH, &checkpoint, &report) == CHAIN_OK);
+    CHECK(report.blocks_verified == 100);
+    
+    /* History before the checkpoint is not re-checked */
+    free(bytes);
+    bytes = read_file(EXPORT_B, &size);
+    bytes[export_offset(150) + CHAIN_BLOCK_HEADER_SIZE + 5] ^= 0x10;
+    write_file(DAMAGED, bytes, size);
+    CHECK(verify(DAMAGED, &checkpoint, &report) == CHAIN_OK);
+    CHECK(report.blocks_verified == 100);
+    
+    /* A checkpoint hash that does not match the file */
+    checkpoint.hash[0] ^= 1;
+    CHECK(verify(EXPORT_B, &checkpoint, &report) == CHAIN_ERROR_VERIFICATION);
+    CHECK(report.failed_block == checkpoint.block_number && report.failed_stage == CHAIN_STAGE_HASH);
+    CHECK(report.blocks_verified == 0);
+    
+    free(bytes);
+    remove(DAMAGED);
+    remove(EXPORT_A);
+    remove(EXPORT_B);
+    remove(LOG_PATH);
+    rmdir(CHAIN_DIR);
+}
+
+int main(void) {
+    test_encoding();
+    test_log_reload();
+    test_import();
+    test_merkle();
+    test_verify_file();
+    return TEST_RESULT();
+}
@@ -0,0 +1,109 @@
+/**
+ * KOLIBRI.AI Tests - Ed25519 against RFC 8032 and batch verification
+ */
+
+#include "kolibri_ed25519.h"
+#include "test_util.h"
+#include <string.h>
+#include <stdio.h>
+
+/* RFC 8032 section 7.1, tests 1-3 */
+static const struct {
+    const char* seed;
+    const char* public_key;
+    const char* message;
+    const char* signature;
+} vectors[] = {
+    { "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+      "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+      "",
+      "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e065224901555fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b" },
+    { "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+      "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+      "72",
+      "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00" },
+    { "c5aa8df43f9f837bedb7442f31dcb7b166d38535076f094b85ce3a2e0b4458f7",
+      "fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025",
+      "af82",
+      "6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac18ff9b538d16f290ae67f760984dc6594a7c15e9716ed28dc027beceea1ec40a" },
+};
+
+static size_t from_hex(const char* hex, uint8_t* out) {
+    size_t len = strlen(hex) / 2;
+    for (size_t i = 0; i < len; i++) {
+        unsigned int byte;
+        sscanf(hex + 2 * i, "%2x", &byte);
+        out[i] = (uint8_t)byte;
+    }
+    return len;
+}
+
+static void test_vectors(void) {
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+        uint8_t seed[32], expected_key[32], expected_signature[64], message[8];
+        from_hex(vectors[v].seed, seed);
+        from_hex(vectors[v].public_key, expected_key);
+        from_hex(vectors[v].signature, expected_signature);
+        size_t len = from_hex(vectors[v].message, message);
+        
+        uint8_t public_key[32], signature[64];
+        kolibri_ed25519_public_key(seed, public_key);
+        CHECK(memcmp(public_key, expected_key, 32) == 0);
+        kolibri_ed25519_sign(seed, public_key, message, len, signature);
+        CHECK(memcmp(signature, expected_signature, 64) == 0);
+        CHECK(kolibri_ed25519_verify(public_key, message, len, signature) == 0);
+        
+        /* A changed signature, message or key no longer verifies */
+        signature[5] ^= 1;
+        CHECK(kolibri_ed25519_verify(public_key, message, len, signature) != 0);
+        signature[5] ^= 1;
+        signature[40] ^= 1;
+        CHECK(kolibri_ed25519_verify(public_key, message, len, signature) != 0);
+        signature[40] ^= 1;
+        message[len] = 0;
+        CHECK(kolibri_ed25519_verify(public_key, message, len + 1, signature) != 0);
+        public_key[0] ^= 1;
+        CHECK(kolibri_ed25519_verify(public_key, message, len, signature) != 0);
+    }
+}
+
+/* A batch longer than one MSM chunk, with a few signers shared */
+static void test_batch(void) {
+    enum { COUNT = 150 };
+    static uint8_t keys[COUNT][32], signatures[COUNT][64], messages[COUNT][40];
+    const uint8_t* message_ptrs[COUNT];
+    const uint8_t* key_ptrs[COUNT];
+    const uint8_t* signature_ptrs[COUNT];
+    size_t lens[COUNT];
+    int valid[COUNT];
+    
+    for (size_t i = 0; i < COUNT; i++) {
+        uint8_t seed[32];
+        memset(seed, (int)(i % 40), sizeof(seed));
+        for (size_t k = 0; k < sizeof(messages[i]); k++) messages[i][k] = (uint8_t)(i * 7 + k);
+        lens[i] = i % 41;
+        kolibri_ed25519_public_key(seed, keys[i]);
+        kolibri_ed25519_sign(seed, keys[i], messages[i], lens[i], signatures[i]);
+        message_ptrs[i] = messages[i];
+        key_ptrs[i] = keys[i];
+        signature_ptrs[i] = signatures[i];
+    }
+    
+    CHECK(kolibri_ed25519_verify_batch(message_ptrs, lens, key_ptrs, signature_ptrs, COUNT, valid) == 0);
+    for (size_t i = 0; i < COUNT; i++) CHECK(valid[i] == 1);
+    CHECK(kolibri_ed25519_verify_batch(message_ptrs, lens, key_ptrs, signature_ptrs, 0, NULL) == 0);
+    
+    /* Tampered entries are reported one by one */
+    signatures[3][40] ^= 1;
+    signatures[70][2] ^= 1;
+    messages[149][0] ^= 1;
+    CHECK(kolibri_ed25519_verify_batch(message_ptrs, lens, key_ptrs, signature_ptrs, COUNT, valid) != 0);
+    for (size_t i = 0; i < COUNT; i++) CHECK(valid[i] == (i == 3 || i == 70 || i == 149 ? 0 : 1));
+    CHECK(kolibri_ed25519_verify_batch(message_ptrs, lens, key_ptrs, signature_ptrs, COUNT, NULL) != 0);
+}
+
+int main(void) {
+    test_vectors();
+    test_batch();
+    return TEST_RESULT();
+}
@@ -0,0 +1,230 @@
+/**
+ * KOLIBRI.AI Tests - LZ codec and compressed packs
+ */
+
+#include "kolibri_core.h"
+#include "test_util.h"
+#include <string.h>
+#include <stdio.h>
+
+#define PACK_PATH "test_pack.kpk"
+
+static const uint8_t private_key[32] = { 3, 3, 0, 7 };
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* Compress and decompress len bytes; returns the compressed size */
+static size_t lz_round_trip(const uint8_t* src, size_t len) {
+    size_t bound = kolibri_lz_bound(len);
+    uint8_t* packed = (uint8_t*)malloc(bound);
+    uint8_t* out = (uint8_t*)malloc(len + 1);
+    REQUIRE(packed && out);
+    
+    size_t size = kolibri_lz_compress(src, len, packed, bound);
+    CHECK(size > 0 && size <= bound);
+    CHECK(kolibri_lz_decompress(packed, size, out, len) == 0);
+    CHECK(len == 0 || memcmp(src, out, len) == 0);
+    
+    /* The wrong output size and a cut stream must both be rejected */
+    CHECK(kolibri_lz_decompress(packed, size, out, len + 1) != 0);
+    if (size > 1) CHECK(kolibri_lz_decompress(packed, size - 1, out, len) != 0);
+    
+    free(packed);
+    free(out);
+    return size;
+}
+
+static void test_lz(void) {
+    size_t len = 300000;
+    uint8_t* data = (uint8_t*)malloc(len);
+    REQUIRE(data);
+    
+    /* Incompressible input stays within the bound */
+    for (size_t i = 0; i < len; i++) data[i] = (uint8_t)rng();
+    lz_round_trip(data, len);
+    
+    /* Text with repeats, including matches further back than most */
+    static const char* words[] = { "kolibri ", "formula ", "y = x * 2 ", "sin(x) ", "provenance " };
+    size_t n = 0;
+    while (n < len) {
+        const char* w = words[rng() % 5];
+        size_t wl = strlen(w);
+        if (n + wl > len) wl = len - n;
+        memcpy(data + n, w, wl);
+        n += wl;
+    }
+    CHECK(lz_round_trip(data, len) < len / 3);
+    
+    /* Long runs use overlapping matches */
+    memset(data, 'a', len);
+    CHECK(lz_round_trip(data, len) < len / 100);
+    
+    for (size_t small = 0; small < 20; small++) lz_round_trip(data, small);
+    free(data);
+}
+
+static void make_formula(kolibri_formula_t* formula, char* code, uint32_t n) {
+    memset(formula, 0, sizeof(*formula));
+    memcpy(formula->id, &n, sizeof(n));
+    formula->id[31] = 0x33;
+    formula->version = 1 + n % 3;
+    formula->input_count = 2;
+    strcpy(formula->inputs[0], "x");
+    strcpy(formula->inputs[1], "z");
+    formula->output_count = 1;
+    strcpy(formula->outputs[0], "y");
+    formula->code_size = (uint32_t)sprintf(code, "y = %s(x * %u) + z / %u", n % 2 ? "sin" : "log", n, n % 13 + 1);
+    formula->code = (uint8_t*)code;
+    formula->cost = n % 50;
+    formula->fitness = (float)(n % 100) / 100.0f;
+    formula->provenance_count = 1;
+    formula->provenances[0][0] = (uint8_t)n;
+    formula->tag_count = 2;
+    strcpy(formula->tags[0], "physics");
+    strcpy(formula->tags[1], n % 2 ? "wave" : "decay");
+}
+
+/* Every formula 0..count-1 came back intact */
+static int pack_matches(kolibri_core_t* core, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        kolibri_formula_t expected, got;
+        char code[128];
+        make_formula(&expected, code, i);
+        if (kolibri_formula_get(core, expected.id, &got) != KOLIBRI_OK) return 0;
+        if (got.version != expected.version || got.code_size != expected.code_size ||
+            memcmp(got.code, expected.code, got.code_size) != 0 || got.cost != expected.cost ||
+            got.fitness != expected.fitness ||
+            got.input_count != 2 || strcmp(got.inputs[1], "z") != 0 ||
+            got.output_count != 1 || strcmp(got.outputs[0], "y") != 0 ||
+            got.provenance_count != 1 || got.provenances[0][0] != (uint8_t)i ||
+            got.tag_count != 2 || strcmp(got.tags[1], expected.tags[1]) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static uint64_t formula_count(kolibri_core_t* core) {
+    kolibri_metrics_t metrics;
+    kolibri_get_metrics(core, &metrics);
+    return metrics.formula_count;
+}
+
+static void flip_byte(const char* path, long offset) {
+    FILE* f = fopen(path, "r+b");
+    REQUIRE(f);
+    fseek(f, offset, SEEK_SET);
+    int c = fgetc(f);
+    fseek(f, offset, SEEK_SET);
+    fputc(c ^ 0x40, f);
+    fclose(f);
+}
+
+static void test_formula_pack(void) {
+    const uint32_t count = 3000;
+    uint8_t public_key[32];
+    kolibri_derive_public_key(private_key, public_key);
+    
+    kolibri_core_t* source = kolibri_init(NULL);
+    REQUIRE(source);
+    for (uint32_t i = 0; i < count; i++) {
+        kolibri_formula_t formula;
+        char code[128];
+        make_formula(&formula, code, i);
+        kolibri_sign_formula(&formula, private_key);
+        REQUIRE(kolibri_formula_create(source, &formula) == KOLIBRI_OK);
+    }
+    
+    kolibri_pack_stats_t stats;
+    REQUIRE(kolibri_storage_export_pack(source, PACK_PATH, &stats) == KOLIBRI_OK);
+    CHECK(stats.records == count);
+    CHECK(stats.frames > 3);
+    CHECK(stats.packed_bytes < stats.raw_bytes);
+    
+    /* Records are a length and a ring record, newest formula first */
+    kolibri_pack_reader_t* reader = kolibri_pack_open(PACK_PATH);
+    REQUIRE(reader);
+    CHECK(kolibri_pack_kind(reader) == KOLIBRI_PACK_KIND_FORMULAS);
+    uint32_t index;
+    CHECK(kolibri_pack_find_record(reader, 1000, &index) == KOLIBRI_PACK_OK);
+    const kolibri_pack_frame_t* frame = kolibri_pack_frame(reader, index);
+    REQUIRE(frame && frame->first_record <= 1000 && 1000 < frame->first_record + frame->record_count);
+    uint8_t* raw = (uint8_t*)malloc(frame->raw_size);
+    REQUIRE(raw);
+    CHECK(kolibri_pack_read_frame(reader, index, raw) == KOLIBRI_PACK_OK);
+    uint32_t first = 0;
+    memcpy(&first, raw + 4, sizeof(first));
+    CHECK(first == count - 1 - frame->first_record);
+    free(raw);
+    frame = kolibri_pack_frame(reader, 3);
+    long corrupt_at = (long)(frame->offset + 16 + frame->stored_size / 2);
+    kolibri_pack_close(reader);
+    
+    for (uint32_t threads = 1; threads <= 4; threads *= 4) {
+        kolibri_core_t* core = kolibri_init(NULL);
+        CHECK(kolibri_storage_import_pack(core, PACK_PATH, threads, NULL) == KOLIBRI_OK);
+        CHECK(formula_count(core) == count);
+        CHECK(pack_matches(core, count));
+        kolibri_destroy(core);
+    }
+    
+    /* kolibri_storage_import recognizes packs; a trusted key checks them */
+    kolibri_core_t* core = kolibri_init(NULL);
+    kolibri_set_trusted_key(core, public_key);
+    CHECK(kolibri_storage_import(core, PACK_PATH) == KOLIBRI_OK);
+    CHECK(formula_count(core) == count);
+    kolibri_destroy(core);
+    
+    uint8_t wrong_private[32] = { 9 };
+    uint8_t wrong_key[32];
+    kolibri_derive_public_key(wrong_private, wrong_key);
+    core = kolibri_init(NULL);
+    kolibri_set_trusted_key(core, wrong_key);
+    CHECK(kolibri_storage_import_pack(core, PACK_PATH, 2, NULL) == KOLIBRI_ERROR_SIGNATURE);
+    CHECK(formula_count(core) == 0);
+    kolibri_destroy(core);
+    
+    /* A damaged frame fails its checksum */
+    flip_byte(PACK_PATH, corrupt_at);
+    core = kolibri_init(NULL);
+    kolibri_set_trusted_key(core, public_key);
+    CHECK(kolibri_storage_import_pack(core, PACK_PATH, 2, NULL) == KOLIBRI_ERROR_STORAGE);
+    CHECK(formula_count(core) == 0);
+    kolibri_destroy(core);
+    flip_byte(PACK_PATH, corrupt_at);
+    
+    /* So does a pack cut short */
+    FILE* f = fopen(PACK_PATH, "rb");
+    REQUIRE(f);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    uint8_t* bytes = (uint8_t*)malloc((size_t)size);
+    REQUIRE(bytes);
+    fseek(f, 0, SEEK_SET);
+    REQUIRE(fread(bytes, 1, (size_t)size, f) == (size_t)size);
+    fclose(f);
+    f = fopen(PACK_PATH, "wb");
+    REQUIRE(f);
+    fwrite(bytes, 1, (size_t)size - 5, f);
+    fclose(f);
+    free(bytes);
+    core = kolibri_init(NULL);
+    CHECK(kolibri_storage_import_pack(core, PACK_PATH, 2, NULL) != KOLIBRI_OK);
+    kolibri_destroy(core);
+    
+    remove(PACK_PATH);
+    kolibri_destroy(source);
+}
+
+int main(void) {
+    test_lz();
+    test_formula_pack();
+    return TEST_RESULT();
+}
@@ -0,0 +1,259 @@
+/**
+ * KOLIBRI.AI Tests - Tokenizer, dictionaries and signal statistics
+ */
+
+#include "kolibri_perception.h"
+#include "test_util.h"
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+static uint32_t rng_state = 2024;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int continuation(uint8_t c) {
+    return (c & 0xC0) == 0x80;
+}
+
+/* Byte-at-a-time tokenizer following the rules in kolibri_perception.h */
+static size_t reference_tokenize(const uint8_t* text, size_t len, kolibri_token_t* tokens) {
+    uint8_t* word = (uint8_t*)calloc(len + 1, 1);
+    REQUIRE(word);
+    size_t i = 0;
+    while (i < len) {
+        uint8_t c = text[i];
+        size_t separator = 0;
+        if (c == 0xC2 && i + 1 < len && continuation(text[i + 1])) {
+            separator = 2;
+        } else if (c == 0xE2 && i + 2 < len && continuation(text[i + 2]) &&
+                   (text[i + 1] == 0x80 || (text[i + 1] == 0x81 && text[i + 2] <= 0xAF))) {
+            separator = 3;
+        } else if (c == 0xE3 && i + 2 < len && continuation(text[i + 2]) && text[i + 1] == 0x80) {
+            separator = 3;
+        }
+        if (separator) {
+            i += separator;
+            continue;
+        }
+        word[i] = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                  c == '_' || c >= 0x80;
+        i++;
+    }
+    
+    size_t count = 0;
+    for (i = 0; i < len;) {
+        if (!word[i]) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        while (i < len && word[i]) i++;
+        tokens[count].offset = (uint32_t)start;
+        tokens[count].length = (uint32_t)(i - start);
+        count++;
+    }
+    free(word);
+    return count;
+}
+
+/* Words, separators and cut UTF-8 sequences to build test text from */
+static const char* pieces[] = {
+    "hello", "World", " ", "  ", "_x9", "\xC2\xA0", "\xC2", "\xE2\x80\x94", "\xE2\x81\xAF",
+    "\xE2\x81\xB0", "\xE3\x80\x82", "\xE3\x81\x82", "\xD0\x9F\xD1\x80", "\xF0\x9F\x98\x80",
+    ",", ".\n", "ABCdef", "\xE2", "\xE3\x80", "\x80", "12345678901234567890",
+};
+
+static void test_tokenize(void) {
+    enum { CAPACITY = 4096 };
+    static uint8_t text[CAPACITY], work[CAPACITY];
+    static kolibri_token_t expected[CAPACITY + 1], tokens[CAPACITY + 1];
+    const size_t piece_count = sizeof(pieces) / sizeof(pieces[0]);
+    
+    for (int round = 0; round < 3000; round++) {
+        size_t len = 0;
+        size_t count = rng() % 200;
+        for (size_t k = 0; k < count; k++) {
+            const char* piece = pieces[rng() % piece_count];
+            size_t piece_len = strlen(piece);
+            if (len + piece_len > CAPACITY) break;
+            memcpy(text + len, piece, piece_len);
+            len += piece_len;
+        }
+        if (round % 5 == 0) {
+            for (size_t k = 0; k < len; k++) text[k] = (uint8_t)rng();
+        }
+        size_t expected_count = reference_tokenize(text, len, expected);
+        
+        /* Whole buffer at once */
+        size_t consumed;
+        memcpy(work, text, len);
+        size_t got = kolibri_tokenize(work, len, KOLIBRI_TOKENIZE_FINAL, tokens, CAPACITY + 1, &consumed);
+        CHECK(got == expected_count && consumed == len);
+        CHECK(memcmp(tokens, expected, got * sizeof(tokens[0])) == 0);
+        
+        /* Random chunks into a small token buffer, carrying over the rest */
+        size_t at = 0, seen = 0, extra = 0;
+        int matches = 1;
+        for (;;) {
+            size_t avail = len - at;
+            size_t want = rng() % 100 + extra;
+            int final = want >= avail;
+            if (!final) avail = want;
+            kolibri_token_t small[7];
+            got = kolibri_tokenize(work + at, avail, final ? KOLIBRI_TOKENIZE_FINAL : 0, small,
+                                   1 + rng() % 7, &consumed);
+            for (size_t k = 0; k < got; k++, seen++) {
+                if (seen >= expected_count || expected[seen].offset != small[k].offset + at ||
+                    expected[seen].length != small[k].length) {
+                    matches = 0;
+                }
+            }
+            at += consumed;
+            extra = consumed == 0 ? extra + 100 : 0;
+            if (final && consumed == avail) break;
+        }
+        CHECK(matches && seen == expected_count);
+        
+        /* Lower-casing folds ASCII letters only */
+        memcpy(work, text, len);
+        kolibri_tokenize(work, len, KOLIBRI_TOKENIZE_FINAL | KOLIBRI_TOKENIZE_LOWER, tokens, CAPACITY + 1, &consumed);
+        int folded = 1;
+        for (size_t k = 0; k < len; k++) {
+            uint8_t c = text[k] >= 'A' && text[k] <= 'Z' ? (uint8_t)(text[k] | 0x20) : text[k];
+            if (work[k] != c) folded = 0;
+        }
+        CHECK(folded);
+    }
+}
+
+static void test_dict(void) {
+    enum { COUNT = 20000 };
+    static char words[COUNT][24];
+    static const char* word_ptrs[COUNT];
+    static uint32_t codes[COUNT];
+    for (uint32_t i = 0; i < COUNT; i++) {
+        snprintf(words[i], sizeof(words[i]), "w%x_%u", i * 2654435761u, i);
+        word_ptrs[i] = words[i];
+        codes[i] = i * 3 + 1;
+    }
+    
+    kolibri_dict_t* dict = kolibri_dict_build(word_ptrs, codes, COUNT);
+    REQUIRE(dict);
+    CHECK(kolibri_dict_size(dict) == COUNT);
+    int bad = 0;
+    for (uint32_t i = 0; i < COUNT; i++) {
+        uint32_t code;
+        char other[32];
+        if (kolibri_dict_lookup(dict, (const uint8_t*)words[i], strlen(words[i]), &code) != KOLIBRI_OK ||
+            code != codes[i]) {
+            bad++;
+        }
+        snprintf(other, sizeof(other), "x%x_%u", i, i);
+        if (kolibri_dict_lookup(dict, (const uint8_t*)other, strlen(other), &code) != KOLIBRI_ERROR_NOT_FOUND) {
+            bad++;
+        }
+    }
+    CHECK(bad == 0);
+    kolibri_dict_free(dict);
+    
+    /* Duplicate and empty words are refused */
+    word_ptrs[1] = word_ptrs[0];
+    CHECK(kolibri_dict_build(word_ptrs, codes, COUNT) == NULL);
+    word_ptrs[1] = "";
+    CHECK(kolibri_dict_build(word_ptrs, codes, COUNT) == NULL);
+    
+    /* count_matches and map over lower-cased tokens */
+    const char* sentiment[] = { "good", "great", "excellent" };
+    const uint32_t sentiment_codes[] = { 1, 2, 3 };
+    dict = kolibri_dict_build(sentiment, sentiment_codes, 3);
+    REQUIRE(dict);
+    uint8_t text[] = "This is GOOD, really great... not excellent-ish? good!";
+    kolibri_token_t tokens[32];
+    size_t consumed;
+    size_t count = kolibri_tokenize(text, strlen((const char*)text),
+                                    KOLIBRI_TOKENIZE_FINAL | KOLIBRI_TOKENIZE_LOWER, tokens, 32, &consumed);
+    CHECK(count == 9);
+    CHECK(kolibri_dict_count_matches(dict, text, tokens, count) == 4);
+    uint32_t mapped[32];
+    CHECK(kolibri_dict_map(dict, text, tokens, count, 0, mapped) == 4);
+    const uint32_t expected[] = { 0, 0, 1, 0, 2, 0, 3, 0, 1 };
+    CHECK(memcmp(mapped, expected, sizeof(expected)) == 0);
+    kolibri_dict_free(dict);
+}
+
+static void test_signal(void) {
+    enum { COUNT = 1000003 };
+    float* values = (float*)malloc(COUNT * sizeof(float));
+    float* out = (float*)malloc(COUNT * sizeof(float));
+    REQUIRE(values && out);
+    
+    double sum = 0.0;
+    float min = 1e30f, max = -1e30f;
+    for (size_t i = 0; i < COUNT; i++) {
+        values[i] = 1000.0f + (float)(rng() % 100000) / 1000.0f;
+        sum += values[i];
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+    }
+    double mean = sum / COUNT, squares = 0.0;
+    for (size_t i = 0; i < COUNT; i++) squares += (values[i] - mean) * (values[i] - mean);
+    double stddev = sqrt(squares / COUNT);
+    
+    /* Uneven updates match a two-pass computation */
+    kolibri_signal_stats_t stats;
+    kolibri_signal_init(&stats);
+    for (size_t at = 0; at < COUNT;) {
+        size_t step = rng() % 5000;
+        if (step > COUNT - at) step = COUNT - at;
+        kolibri_signal_update(&stats, values + at, step);
+        at += step;
+    }
+    CHECK(stats.count == COUNT && stats.min == min && stats.max == max);
+    CHECK(fabs(stats.mean - mean) < 1e-9 * mean);
+    CHECK(fabs(kolibri_signal_stddev(&stats) - stddev) < 1e-9 * stddev);
+    
+    /* Merging two halves gives the same result */
+    kolibri_signal_stats_t first, second;
+    kolibri_signal_init(&first);
+    kolibri_signal_init(&second);
+    kolibri_signal_update(&first, values, COUNT / 3);
+    kolibri_signal_update(&second, values + COUNT / 3, COUNT - COUNT / 3);
+    kolibri_signal_merge(&first, &second);
+    CHECK(first.count == COUNT && fabs(first.mean - mean) < 1e-9 * mean);
+    CHECK(fabs(kolibri_signal_stddev(&first) - stddev) < 1e-9 * stddev);
+    
+    kolibri_signal_stats_t check;
+    CHECK(kolibri_signal_normalize(&stats, KOLIBRI_NORMALIZE_ZSCORE, values, out, COUNT) == KOLIBRI_OK);
+    kolibri_signal_init(&check);
+    kolibri_signal_update(&check, out, COUNT);
+    CHECK(fabs(check.mean) < 1e-4 && fabs(kolibri_signal_stddev(&check) - 1.0) < 1e-4);
+    
+    CHECK(kolibri_signal_normalize(&stats, KOLIBRI_NORMALIZE_MINMAX, values, values, COUNT) == KOLIBRI_OK);
+    kolibri_signal_init(&check);
+    kolibri_signal_update(&check, values, COUNT);
+    CHECK(check.min == 0.0f && fabs(check.max - 1.0f) < 1e-6f);
+    
+    /* A constant signal maps to 0; an unknown mode is refused */
+    float constant[5] = { 3, 3, 3, 3, 3 };
+    kolibri_signal_init(&check);
+    kolibri_signal_update(&check, constant, 5);
+    CHECK(kolibri_signal_normalize(&check, KOLIBRI_NORMALIZE_ZSCORE, constant, constant, 5) == KOLIBRI_OK);
+    CHECK(constant[0] == 0.0f && constant[4] == 0.0f);
+    CHECK(kolibri_signal_normalize(&check, 7, constant, constant, 5) == KOLIBRI_ERROR_INVALID_PARAM);
+    
+    free(values);
+    free(out);
+}
+
+int main(void) {
+    test_tokenize();
+    test_dict();
+    test_signal();
+    return TEST_RESULT();
+}
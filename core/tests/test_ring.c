@@ -0,0 +1,297 @@
+/**
+ * KOLIBRI.AI Tests - Submission/completion rings
+ */
+
+#include "kolibri_ring.h"
+#include "test_util.h"
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+static kolibri_ring_t* make_ring(uint32_t sq_entries, uint32_t cq_entries, uint32_t data_size) {
+    size_t size = kolibri_ring_size(sq_entries, cq_entries, data_size);
+    REQUIRE(size > 0);
+    void* memory = aligned_alloc(64, (size + 63) & ~(size_t)63);
+    REQUIRE(memory);
+    kolibri_ring_t* ring = kolibri_ring_init(memory, size, sq_entries, cq_entries, data_size);
+    REQUIRE(ring);
+    return ring;
+}
+
+/* Write a value list of one int and one string; returns its length */
+static uint32_t put_values(uint8_t* p, int32_t number, const char* text) {
+    uint8_t* start = p;
+    uint32_t count = 2, len = 4;
+    memcpy(p, &count, 4);
+    p += 4;
+    *p++ = 0;
+    memcpy(p, &len, 4);
+    memcpy(p + 4, &number, 4);
+    p += 8;
+    *p++ = 2;
+    len = (uint32_t)strlen(text);
+    memcpy(p, &len, 4);
+    memcpy(p + 4, text, len);
+    p += 4 + len;
+    return (uint32_t)(p - start);
+}
+
+static void process_all(kolibri_core_t* core, kolibri_ring_t* ring, uint32_t expected) {
+    uint32_t processed = 0;
+    CHECK(kolibri_ring_process(core, ring, 0, &processed) == KOLIBRI_OK);
+    CHECK(processed == expected);
+}
+
+static void test_requests(void) {
+    kolibri_core_t* core = kolibri_init(NULL);
+    REQUIRE(core);
+    CHECK(kolibri_ring_size(3, 4, 0) == 0);
+    kolibri_ring_t* ring = make_ring(256, 256, 1 << 20);
+    uint8_t* data = kolibri_ring_data(ring);
+    uint32_t base = ring->data_offset;
+    kolibri_ring_cqe_t cqe;
+    
+    /* Create with an all-zero ID reports the ID it picked */
+    kolibri_formula_t formula;
+    memset(&formula, 0, sizeof(formula));
+    formula.version = 3;
+    formula.cost = 7;
+    formula.fitness = 0.5f;
+    formula.input_count = 2;
+    strcpy(formula.inputs[0], "x");
+    strcpy(formula.inputs[1], "y");
+    formula.output_count = 1;
+    strcpy(formula.outputs[0], "r");
+    formula.tag_count = 1;
+    strcpy(formula.tags[0], "math");
+    formula.provenance_count = 1;
+    memset(formula.provenances[0], 9, KOLIBRI_ID_SIZE);
+    memset(formula.signature, 5, sizeof(formula.signature));
+    const char* code = "r = x + y";
+    formula.code = (uint8_t*)code;
+    formula.code_size = (uint32_t)strlen(code);
+    size_t record_size = kolibri_ring_encode_formula(&formula, data, 1 << 20);
+    REQUIRE(record_size > KOLIBRI_RING_FORMULA_HEADER_SIZE);
+    
+    kolibri_ring_sqe_t sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = KOLIBRI_RING_OP_CREATE;
+    sqe.user_data = 11;
+    sqe.in_offset = base;
+    sqe.in_len = (uint32_t)record_size;
+    sqe.out_offset = base + 4096;
+    sqe.out_len = KOLIBRI_ID_SIZE;
+    CHECK(kolibri_ring_submit(ring, &sqe) == KOLIBRI_OK);
+    process_all(core, ring, 1);
+    CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK);
+    CHECK(cqe.user_data == 11 && cqe.result == KOLIBRI_OK && cqe.len == KOLIBRI_ID_SIZE);
+    CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_ERROR_NOT_FOUND);
+    
+    uint8_t id[KOLIBRI_ID_SIZE];
+    memcpy(id, data + 4096, KOLIBRI_ID_SIZE);
+    kolibri_formula_t stored;
+    CHECK(kolibri_formula_get(core, id, &stored) == KOLIBRI_OK);
+    CHECK(stored.code_size == formula.code_size && memcmp(stored.code, code, stored.code_size) == 0);
+    CHECK(stored.cost == 7 && strcmp(stored.tags[0], "math") == 0);
+    
+    /* Get into an output too small reports the size it needs */
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = KOLIBRI_RING_OP_GET;
+    memcpy(sqe.id, id, KOLIBRI_ID_SIZE);
+    sqe.user_data = 12;
+    sqe.out_offset = base;
+    sqe.out_len = 16;
+    kolibri_ring_submit(ring, &sqe);
+    sqe.user_data = 13;
+    sqe.out_len = 8192;
+    kolibri_ring_submit(ring, &sqe);
+    process_all(core, ring, 2);
+    CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK);
+    CHECK(cqe.result == KOLIBRI_ERROR_INVALID_PARAM && cqe.len == record_size);
+    CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK);
+    CHECK(cqe.user_data == 13 && cqe.result == KOLIBRI_OK && cqe.len == record_size);
+    
+    kolibri_formula_t decoded;
+    CHECK(kolibri_ring_decode_formula(data, cqe.len, &decoded) == KOLIBRI_OK);
+    CHECK(memcmp(decoded.id, id, KOLIBRI_ID_SIZE) == 0 && decoded.version == 3);
+    CHECK(decoded.input_count == 2 && strcmp(decoded.inputs[1], "y") == 0);
+    CHECK(decoded.provenances[0][5] == 9 && decoded.signature[63] == 5);
+    CHECK(decoded.code_size == formula.code_size && memcmp(decoded.code, code, decoded.code_size) == 0);
+    
+    /* Execute echoes the value list */
+    uint32_t values_len = put_values(data, 42, "hello");
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = KOLIBRI_RING_OP_EXECUTE;
+    memcpy(sqe.id, id, KOLIBRI_ID_SIZE);
+    sqe.in_offset = base;
+    sqe.in_len = values_len;
+    sqe.out_offset = base + 1024;
+    sqe.out_len = 256;
+    sqe.user_data = 14;
+    kolibri_ring_submit(ring, &sqe);
+    process_all(core, ring, 1);
+    CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK);
+    CHECK(cqe.result == KOLIBRI_OK && cqe.len == values_len && memcmp(data + 1024, data, values_len) == 0);
+    
+    /* Bad requests fail on their own completions */
+    sqe.in_offset = base + 1000; /* Overlaps the output */
+    sqe.in_len = 100;
+    sqe.user_data = 15;
+    kolibri_ring_submit(ring, &sqe);
+    sqe.in_offset = 4; /* Inside the header */
+    sqe.in_len = 8;
+    sqe.user_data = 16;
+    kolibri_ring_submit(ring, &sqe);
+    sqe.in_offset = base;
+    sqe.in_len = values_len;
+    sqe.opcode = 99;
+    sqe.user_data = 17;
+    kolibri_ring_submit(ring, &sqe);
+    sqe.opcode = KOLIBRI_RING_OP_EXECUTE;
+    sqe.in_offset = base + (1 << 20) - 4; /* Runs past the data area */
+    sqe.in_len = 8;
+    sqe.user_data = 18;
+    kolibri_ring_submit(ring, &sqe);
+    sqe.in_offset = base;
+    sqe.in_len = 3; /* Cut value list */
+    sqe.user_data = 19;
+    kolibri_ring_submit(ring, &sqe);
+    memset(sqe.id, 0xEE, KOLIBRI_ID_SIZE);
+    sqe.in_len = values_len;
+    sqe.user_data = 20;
+    kolibri_ring_submit(ring, &sqe);
+    process_all(core, ring, 6);
+    for (int i = 0; i < 6; i++) {
+        CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK);
+        CHECK(cqe.user_data == (uint64_t)(15 + i));
+        CHECK(cqe.result == (i < 5 ? KOLIBRI_ERROR_INVALID_PARAM : KOLIBRI_ERROR_NOT_FOUND));
+    }
+    
+    /* A record with an impossible count is refused */
+    kolibri_ring_encode_formula(&formula, data, 1 << 20);
+    data[57] = 200;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = KOLIBRI_RING_OP_CREATE;
+    sqe.in_offset = base;
+    sqe.in_len = (uint32_t)record_size;
+    kolibri_ring_submit(ring, &sqe);
+    process_all(core, ring, 1);
+    CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK && cqe.result == KOLIBRI_ERROR_INVALID_PARAM);
+    
+    free(ring);
+    kolibri_destroy(core);
+}
+
+static void test_backpressure(void) {
+    kolibri_core_t* core = kolibri_init(NULL);
+    REQUIRE(core);
+    kolibri_ring_cqe_t cqe;
+    kolibri_ring_sqe_t sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = KOLIBRI_RING_OP_GET;
+    
+    /* A full submission queue refuses more; max_batch bounds a pass */
+    kolibri_ring_t* ring = make_ring(256, 256, 4096);
+    int submitted = 0;
+    while (kolibri_ring_submit(ring, &sqe) == KOLIBRI_OK) submitted++;
+    CHECK(submitted == 256);
+    uint32_t processed = 0;
+    CHECK(kolibri_ring_process(core, ring, 100, &processed) == KOLIBRI_OK && processed == 100);
+    process_all(core, ring, 156);
+    for (int i = 0; i < 256; i++) CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK);
+    CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_ERROR_NOT_FOUND);
+    free(ring);
+    
+    /* Processing stops when the completion queue is full */
+    ring = make_ring(64, 16, 4096);
+    for (int i = 0; i < 40; i++) kolibri_ring_submit(ring, &sqe);
+    process_all(core, ring, 16);
+    process_all(core, ring, 0);
+    for (int i = 0; i < 16; i++) CHECK(kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK);
+    process_all(core, ring, 16);
+    free(ring);
+    
+    kolibri_destroy(core);
+}
+
+typedef struct {
+    kolibri_core_t* core;
+    kolibri_ring_t* ring;
+    int stop;
+} processor_t;
+
+static void* run_processor(void* arg) {
+    processor_t* p = (processor_t*)arg;
+    while (!__atomic_load_n(&p->stop, __ATOMIC_ACQUIRE)) {
+        uint32_t processed = 0;
+        kolibri_ring_process(p->core, p->ring, 0, &processed);
+        if (processed == 0) sched_yield();
+    }
+    return NULL;
+}
+
+/* A submitter and a processor on separate threads, sharing only the ring */
+static void test_concurrent(void) {
+    const int total = 50000;
+    kolibri_core_t* core = kolibri_init(NULL);
+    REQUIRE(core);
+    kolibri_formula_t formula;
+    memset(&formula, 0, sizeof(formula));
+    memset(formula.id, 1, KOLIBRI_ID_SIZE);
+    REQUIRE(kolibri_formula_create(core, &formula) == KOLIBRI_OK);
+    
+    kolibri_ring_t* ring = make_ring(64, 64, 64 * 64);
+    uint8_t* data = kolibri_ring_data(ring);
+    processor_t processor = { core, ring, 0 };
+    pthread_t thread;
+    REQUIRE(pthread_create(&thread, NULL, run_processor, &processor) == 0);
+    
+    int sent = 0, reaped = 0, bad = 0;
+    while (reaped < total) {
+        while (sent < total && sent - reaped < 64) {
+            uint32_t slot = (uint32_t)sent & 63;
+            uint8_t* p = data + slot * 64;
+            uint32_t count = 1, len = 4;
+            int32_t value = sent;
+            memcpy(p, &count, 4);
+            p[4] = 0;
+            memcpy(p + 5, &len, 4);
+            memcpy(p + 9, &value, 4);
+            
+            kolibri_ring_sqe_t sqe;
+            memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = KOLIBRI_RING_OP_EXECUTE;
+            memcpy(sqe.id, formula.id, KOLIBRI_ID_SIZE);
+            sqe.user_data = (uint64_t)sent;
+            sqe.in_offset = ring->data_offset + slot * 64;
+            sqe.in_len = 13;
+            sqe.out_offset = sqe.in_offset + 32;
+            sqe.out_len = 32;
+            if (kolibri_ring_submit(ring, &sqe) != KOLIBRI_OK) break;
+            sent++;
+        }
+        
+        kolibri_ring_cqe_t cqe;
+        while (kolibri_ring_reap(ring, &cqe) == KOLIBRI_OK) {
+            int32_t value;
+            memcpy(&value, data + (cqe.user_data & 63) * 64 + 32 + 9, 4);
+            if (cqe.result != KOLIBRI_OK || cqe.user_data != (uint64_t)reaped || value != reaped) bad++;
+            reaped++;
+        }
+        sched_yield();
+    }
+    
+    __atomic_store_n(&processor.stop, 1, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+    CHECK(bad == 0);
+    
+    free(ring);
+    kolibri_destroy(core);
+}
+
+int main(void) {
+    test_requests();
+    test_backpressure();
+    test_concurrent();
+    return TEST_RESULT();
+}
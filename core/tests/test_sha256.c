@@ -0,0 +1,113 @@
+/**
+ * KOLIBRI.AI Tests - SHA-256 on every backend the CPU supports
+ *
+ * Includes the implementation so each backend can be selected in turn.
+ */
+
+#include "../src/kolibri_sha256.c"
+#include "test_util.h"
+#include <stdio.h>
+
+static const struct {
+    const char* message;
+    size_t repeat;
+    const char* digest;
+} vectors[] = {
+    { "", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { "abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+      "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" },
+    { "a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+};
+
+static void to_hex(const uint8_t* hash, char* hex) {
+    for (int i = 0; i < KOLIBRI_SHA256_SIZE; i++) sprintf(hex + 2 * i, "%02x", hash[i]);
+}
+
+static void test_vectors(void) {
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+        size_t piece = strlen(vectors[v].message);
+        size_t len = piece * vectors[v].repeat;
+        uint8_t* message = (uint8_t*)malloc(len + 1);
+        REQUIRE(message);
+        for (size_t r = 0; r < vectors[v].repeat; r++) memcpy(message + r * piece, vectors[v].message, piece);
+        
+        uint8_t hash[KOLIBRI_SHA256_SIZE];
+        char hex[2 * KOLIBRI_SHA256_SIZE + 1];
+        kolibri_sha256(message, len, hash);
+        to_hex(hash, hex);
+        CHECK(strcmp(hex, vectors[v].digest) == 0);
+        
+        /* Streaming in uneven pieces */
+        kolibri_sha256_ctx_t ctx;
+        kolibri_sha256_init(&ctx);
+        for (size_t at = 0, step = 1; at < len; at += step, step = step * 3 % 127 + 1) {
+            kolibri_sha256_update(&ctx, message + at, step < len - at ? step : len - at);
+        }
+        kolibri_sha256_final(&ctx, hash);
+        to_hex(hash, hex);
+        CHECK(strcmp(hex, vectors[v].digest) == 0);
+        
+        /* A batch of eight copies, so the multi-buffer path runs */
+        const uint8_t* data[8];
+        size_t lens[8];
+        uint8_t hashes[8][KOLIBRI_SHA256_SIZE];
+        for (int i = 0; i < 8; i++) {
+            data[i] = message;
+            lens[i] = len;
+        }
+        kolibri_sha256_batch(data, lens, 8, hashes);
+        for (int i = 0; i < 8; i++) {
+            to_hex(hashes[i], hex);
+            CHECK(strcmp(hex, vectors[v].digest) == 0);
+        }
+        free(message);
+    }
+}
+
+/* Batches of mixed lengths 0-300 match the one-shot hashes of the
+ * portable backend, whatever order the batch sorts them into */
+static void test_batch(const uint8_t (*expected)[KOLIBRI_SHA256_SIZE], const uint8_t* buffer) {
+    enum { COUNT = 301 };
+    const uint8_t* data[COUNT];
+    size_t lens[COUNT];
+    uint8_t hashes[COUNT][KOLIBRI_SHA256_SIZE];
+    for (size_t i = 0; i < COUNT; i++) {
+        size_t len = (i * 97) % COUNT;
+        data[i] = buffer + i;
+        lens[i] = len;
+    }
+    kolibri_sha256_batch(data, lens, COUNT, hashes);
+    for (size_t i = 0; i < COUNT; i++) {
+        uint8_t single[KOLIBRI_SHA256_SIZE];
+        kolibri_sha256(data[i], lens[i], single);
+        CHECK(memcmp(single, expected[i], KOLIBRI_SHA256_SIZE) == 0);
+        CHECK(memcmp(hashes[i], expected[i], KOLIBRI_SHA256_SIZE) == 0);
+    }
+}
+
+int main(void) {
+    int backends[3];
+    int backend_count = 0;
+    backends[backend_count++] = SHA256_GENERIC;
+#ifdef KOLIBRI_SHA256_X86
+    if (__builtin_cpu_supports("avx2")) backends[backend_count++] = SHA256_AVX2;
+    if (sha256_detect() == SHA256_SHANI) backends[backend_count++] = SHA256_SHANI;
+#endif
+    
+    uint8_t buffer[1024];
+    for (size_t i = 0; i < sizeof(buffer); i++) buffer[i] = (uint8_t)(i * 31 + 7);
+    static uint8_t expected[301][KOLIBRI_SHA256_SIZE];
+    atomic_store(&sha256_selected, SHA256_GENERIC);
+    for (size_t i = 0; i < 301; i++) kolibri_sha256(buffer + i, (i * 97) % 301, expected[i]);
+    
+    for (int b = 0; b < backend_count; b++) {
+        atomic_store(&sha256_selected, backends[b]);
+        printf("backend %s\n", kolibri_sha256_backend());
+        test_vectors();
+        test_batch((const uint8_t (*)[KOLIBRI_SHA256_SIZE])expected, buffer);
+    }
+    return TEST_RESULT();
+}
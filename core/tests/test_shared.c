@@ -0,0 +1,271 @@
+/**
+ * KOLIBRI.AI Tests - Shared-memory formula store
+ */
+
+#include "kolibri_shared.h"
+#include "test_util.h"
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static void make_id(uint8_t* id, uint32_t n) {
+    memset(id, 0, KOLIBRI_ID_SIZE);
+    memcpy(id, &n, sizeof(n));
+    id[31] = 0x5A;
+}
+
+/* Formula n at a version, with code derived from both */
+static void make_formula(kolibri_formula_t* formula, uint8_t* code, uint32_t n, uint32_t version) {
+    memset(formula, 0, sizeof(*formula));
+    make_id(formula->id, n);
+    formula->version = version;
+    formula->code_size = (version * 37 + n) % 1500 + 1;
+    for (uint32_t i = 0; i < formula->code_size; i++) code[i] = (uint8_t)(version * 13 + n + i);
+    formula->code = code;
+    formula->fitness = (float)version;
+    formula->tag_count = 1;
+    snprintf(formula->tags[0], sizeof(formula->tags[0]), "v%u", version);
+}
+
+/* The formula read for n is whole and of one version */
+static int consistent(const kolibri_formula_t* formula, uint32_t n) {
+    uint32_t version = formula->version;
+    char tag[32];
+    snprintf(tag, sizeof(tag), "v%u", version);
+    if (formula->code_size != (version * 37 + n) % 1500 + 1 || formula->fitness != (float)version ||
+        strcmp(formula->tags[0], tag) != 0) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < formula->code_size; i++) {
+        if (formula->code[i] != (uint8_t)(version * 13 + n + i)) return 0;
+    }
+    return 1;
+}
+
+static void test_segment(void) {
+    uint8_t code[KOLIBRI_MAX_FORMULA_SIZE];
+    uint8_t id[KOLIBRI_ID_SIZE];
+    kolibri_formula_t formula;
+    
+    CHECK(kolibri_shared_size(0, 100) == 0);
+    kolibri_shared_t* shared;
+    REQUIRE(kolibri_shared_create(NULL, 64, 160 * 1024, &shared) == KOLIBRI_OK);
+    CHECK(kolibri_shared_writable(shared));
+    
+    for (uint32_t n = 0; n < 64; n++) {
+        make_formula(&formula, code, n, 1);
+        CHECK(kolibri_shared_put(shared, &formula) == KOLIBRI_OK);
+    }
+    make_formula(&formula, code, 99, 1);
+    CHECK(kolibri_shared_put(shared, &formula) == KOLIBRI_ERROR_STORAGE);
+    
+    /* Rewriting every formula many times forces switches between halves */
+    for (uint32_t version = 2; version < 60; version++) {
+        for (uint32_t n = 0; n < 64; n++) {
+            make_formula(&formula, code, n, version);
+            CHECK(kolibri_shared_put(shared, &formula) == KOLIBRI_OK);
+        }
+    }
+    CHECK(kolibri_shared_count(shared) == 64);
+    for (uint32_t n = 0; n < 64; n++) {
+        make_id(id, n);
+        CHECK(kolibri_shared_get(shared, id, &formula, code, sizeof(code)) == KOLIBRI_OK);
+        CHECK(formula.version == 59 && consistent(&formula, n));
+    }
+    
+    for (uint32_t n = 0; n < 64; n += 2) {
+        make_id(id, n);
+        CHECK(kolibri_shared_delete(shared, id) == KOLIBRI_OK);
+        CHECK(kolibri_shared_delete(shared, id) == KOLIBRI_ERROR_NOT_FOUND);
+    }
+    CHECK(kolibri_shared_count(shared) == 32);
+    for (uint32_t n = 0; n < 64; n++) {
+        make_id(id, n);
+        int result = kolibri_shared_get(shared, id, &formula, NULL, 0);
+        CHECK(result == (n & 1 ? KOLIBRI_OK : KOLIBRI_ERROR_NOT_FOUND));
+    }
+    make_id(id, 1);
+    CHECK(kolibri_shared_get(shared, id, &formula, code, 1) == KOLIBRI_ERROR_INVALID_PARAM);
+    
+    uint8_t ids[128][KOLIBRI_ID_SIZE];
+    uint32_t count;
+    CHECK(kolibri_shared_ids(shared, ids, 128, &count) == KOLIBRI_OK);
+    CHECK(count == 32);
+    
+    /* A read-only mapping refuses writes */
+    kolibri_shared_t* reader;
+    REQUIRE(kolibri_shared_attach_fd(kolibri_shared_fd(shared), &reader) == KOLIBRI_OK);
+    CHECK(!kolibri_shared_writable(reader));
+    make_formula(&formula, code, 1, 1);
+    CHECK(kolibri_shared_put(reader, &formula) == KOLIBRI_ERROR);
+    kolibri_shared_close(reader);
+    kolibri_shared_close(shared);
+}
+
+/* A worker core reads through to the segment its coordinator publishes to */
+static void test_core_read_through(void) {
+    uint8_t code[KOLIBRI_MAX_FORMULA_SIZE];
+    kolibri_formula_t formula;
+    
+    kolibri_shared_t* shared;
+    REQUIRE(kolibri_shared_create(NULL, 256, 512 * 1024, &shared) == KOLIBRI_OK);
+    kolibri_core_t* coordinator = kolibri_init(NULL);
+    REQUIRE(coordinator);
+    for (uint32_t n = 0; n < 100; n++) {
+        make_formula(&formula, code, n, 1);
+        REQUIRE(kolibri_formula_create(coordinator, &formula) == KOLIBRI_OK);
+    }
+    REQUIRE(kolibri_attach_shared(coordinator, shared) == KOLIBRI_OK);
+    for (uint32_t n = 100; n < 120; n++) {
+        make_formula(&formula, code, n, 1);
+        REQUIRE(kolibri_formula_create(coordinator, &formula) == KOLIBRI_OK);
+    }
+    CHECK(kolibri_shared_count(shared) == 120);
+    
+    kolibri_shared_t* mapping;
+    REQUIRE(kolibri_shared_attach_fd(kolibri_shared_fd(shared), &mapping) == KOLIBRI_OK);
+    kolibri_core_t* worker = kolibri_init(NULL);
+    REQUIRE(worker);
+    REQUIRE(kolibri_attach_shared(worker, mapping) == KOLIBRI_OK);
+    
+    /* Code from one read survives the next, as crossover needs */
+    uint8_t id1[KOLIBRI_ID_SIZE], id2[KOLIBRI_ID_SIZE];
+    kolibri_formula_t parent1, parent2;
+    make_id(id1, 3);
+    make_id(id2, 104);
+    CHECK(kolibri_formula_get(worker, id1, &parent1) == KOLIBRI_OK);
+    CHECK(kolibri_formula_get(worker, id2, &parent2) == KOLIBRI_OK);
+    CHECK(parent1.code != parent2.code);
+    CHECK(consistent(&parent1, 3) && consistent(&parent2, 104));
+    
+    kolibri_formula_t child;
+    CHECK(kolibri_formula_crossover(worker, id1, id2, &child) == KOLIBRI_OK);
+    CHECK(child.code_size == parent1.code_size && memcmp(child.code, parent1.code, child.code_size) == 0);
+    
+    /* A new version in the segment reaches the worker */
+    make_formula(&formula, code, 3, 7);
+    REQUIRE(kolibri_formula_update(coordinator, &formula) == KOLIBRI_OK);
+    CHECK(kolibri_formula_get(worker, id1, &parent1) == KOLIBRI_OK);
+    CHECK(parent1.version == 7 && consistent(&parent1, 3));
+    CHECK(consistent(&parent2, 104));
+    
+    /* list covers what only the segment holds, once each */
+    make_formula(&formula, code, 500, 1);
+    REQUIRE(kolibri_formula_create(worker, &formula) == KOLIBRI_OK);
+    kolibri_formula_t* list;
+    uint32_t count;
+    REQUIRE(kolibri_formula_list(worker, &list, &count) == KOLIBRI_OK);
+    CHECK(count == 121);
+    int seen[121] = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t n;
+        memcpy(&n, list[i].id, sizeof(n));
+        uint32_t slot = n == 500 ? 120 : n;
+        CHECK(slot < 121 && !seen[slot]);
+        if (slot < 121) seen[slot] = 1;
+        CHECK(consistent(&list[i], n));
+    }
+    free(list);
+    
+    /* Forked workers read a consistent formula while the writer churns */
+    pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        int bad = 0;
+        for (uint32_t round = 0; round < 20000; round++) {
+            uint32_t n = round % 120;
+            uint8_t id[KOLIBRI_ID_SIZE];
+            make_id(id, n);
+            kolibri_formula_t read;
+            if (kolibri_formula_get(worker, id, &read) == KOLIBRI_OK && !consistent(&read, n)) bad++;
+        }
+        _exit(bad == 0 ? 0 : 1);
+    }
+    for (uint32_t version = 2; version < 200; version++) {
+        make_formula(&formula, code, version % 120, version);
+        CHECK(kolibri_formula_update(coordinator, &formula) == KOLIBRI_OK);
+    }
+    int status;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    
+    kolibri_destroy(worker);
+    kolibri_shared_close(mapping);
+    kolibri_destroy(coordinator);
+    kolibri_shared_close(shared);
+}
+
+/* A worker reading more code than KOLIBRI_SHARED_CODE_CACHE holds */
+static void test_code_cache(void) {
+    enum { COUNT = 2 * KOLIBRI_SHARED_CODE_CACHE / KOLIBRI_MAX_FORMULA_SIZE };
+    static uint8_t code[KOLIBRI_MAX_FORMULA_SIZE];
+    kolibri_formula_t formula;
+    
+    kolibri_shared_t* shared;
+    REQUIRE(kolibri_shared_create(NULL, 2 * COUNT, (COUNT + 8) * (KOLIBRI_MAX_FORMULA_SIZE + 256), &shared) == KOLIBRI_OK);
+    kolibri_core_t* coordinator = kolibri_init(NULL);
+    REQUIRE(coordinator);
+    REQUIRE(kolibri_attach_shared(coordinator, shared) == KOLIBRI_OK);
+    for (uint32_t n = 0; n < COUNT; n++) {
+        make_formula(&formula, code, n, 1);
+        formula.code_size = KOLIBRI_MAX_FORMULA_SIZE;
+        for (uint32_t i = 0; i < formula.code_size; i++) code[i] = (uint8_t)(n * 7 + i);
+        REQUIRE(kolibri_formula_create(coordinator, &formula) == KOLIBRI_OK);
+    }
+    
+    kolibri_shared_t* mapping;
+    REQUIRE(kolibri_shared_attach_fd(kolibri_shared_fd(shared), &mapping) == KOLIBRI_OK);
+    kolibri_core_t* worker = kolibri_init(NULL);
+    REQUIRE(worker);
+    REQUIRE(kolibri_attach_shared(worker, mapping) == KOLIBRI_OK);
+    
+    /* Each read leaves the previous one intact, twice round the segment */
+    int bad = 0;
+    kolibri_formula_t previous;
+    uint32_t previous_n = 0;
+    for (uint32_t k = 0; k < 2 * COUNT; k++) {
+        uint32_t n = k % COUNT;
+        uint8_t id[KOLIBRI_ID_SIZE];
+        make_id(id, n);
+        if (kolibri_formula_get(worker, id, &formula) != KOLIBRI_OK ||
+            formula.code_size != KOLIBRI_MAX_FORMULA_SIZE) {
+            bad++;
+            continue;
+        }
+        for (uint32_t i = 0; i < formula.code_size; i++) bad += formula.code[i] != (uint8_t)(n * 7 + i);
+        if (k > 0) {
+            for (uint32_t i = 0; i < previous.code_size; i++) bad += previous.code[i] != (uint8_t)(previous_n * 7 + i);
+        }
+        previous = formula;
+        previous_n = n;
+    }
+    CHECK(bad == 0);
+    
+    /* list holds all of the code at once */
+    kolibri_formula_t* list;
+    uint32_t count;
+    REQUIRE(kolibri_formula_list(worker, &list, &count) == KOLIBRI_OK);
+    CHECK(count == COUNT);
+    bad = 0;
+    for (uint32_t k = 0; k < count; k++) {
+        uint32_t n;
+        memcpy(&n, list[k].id, sizeof(n));
+        bad += list[k].code_size != KOLIBRI_MAX_FORMULA_SIZE;
+        for (uint32_t i = 0; i < list[k].code_size; i++) bad += list[k].code[i] != (uint8_t)(n * 7 + i);
+    }
+    CHECK(bad == 0);
+    free(list);
+    
+    kolibri_destroy(worker);
+    kolibri_shared_close(mapping);
+    kolibri_destroy(coordinator);
+    kolibri_shared_close(shared);
+}
+
+int main(void) {
+    test_segment();
+    test_core_read_through();
+    test_code_cache();
+    return TEST_RESULT();
+}
@@ -0,0 +1,220 @@
+/**
+ * KOLIBRI.AI Tests - Delta sync between two cores
+ */
+
+#include "kolibri_sync.h"
+#include "kolibri_analytics.h"
+#include "test_util.h"
+#include <string.h>
+#include <pthread.h>
+
+static const uint8_t private_key[32] = { 7, 1, 4, 2, 8, 5, 7, 1 };
+
+static void make_id(uint8_t* id, uint32_t n) {
+    memset(id, 0, KOLIBRI_ID_SIZE);
+    memcpy(id, &n, sizeof(n));
+    id[31] = 0x5A;
+}
+
+/* Formula n at a version; its code names both so every copy differs */
+static void make_formula(kolibri_formula_t* formula, char* code, uint32_t n, uint32_t version) {
+    memset(formula, 0, sizeof(*formula));
+    make_id(formula->id, n);
+    formula->version = version;
+    formula->input_count = 1;
+    strcpy(formula->inputs[0], "x");
+    formula->code_size = (uint32_t)sprintf(code, "y = x * %u + %u", n, version);
+    formula->code = (uint8_t*)code;
+}
+
+static int put(kolibri_core_t* core, uint32_t n, uint32_t version, int sign) {
+    kolibri_formula_t formula;
+    char code[64];
+    make_formula(&formula, code, n, version);
+    if (sign) kolibri_sign_formula(&formula, private_key);
+    return kolibri_formula_create(core, &formula);
+}
+
+static uint64_t formula_count(kolibri_core_t* core) {
+    kolibri_metrics_t metrics;
+    kolibri_get_metrics(core, &metrics);
+    return metrics.formula_count;
+}
+
+/* Both cores hold the same version and code for formulas 0..n-1 */
+static int same_formulas(kolibri_core_t* a, kolibri_core_t* b, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t id[KOLIBRI_ID_SIZE];
+        kolibri_formula_t fa, fb;
+        make_id(id, i);
+        int ra = kolibri_formula_get(a, id, &fa);
+        int rb = kolibri_formula_get(b, id, &fb);
+        if (ra != rb) return 0;
+        if (ra != KOLIBRI_OK) continue;
+        if (fa.version != fb.version || fa.code_size != fb.code_size ||
+            memcmp(fa.code, fb.code, fa.code_size) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+typedef struct {
+    kolibri_core_t* core;
+    kolibri_transport_t* transport;
+    kolibri_sync_stats_t stats;
+    int result;
+} responder_t;
+
+static void* respond(void* arg) {
+    responder_t* r = (responder_t*)arg;
+    r->result = kolibri_sync_respond(r->core, r->transport, &r->stats);
+    return NULL;
+}
+
+/* Run one session with a as initiator and b as responder */
+static int run_sync(kolibri_core_t* a, kolibri_core_t* b, kolibri_sync_stats_t* stats, int* responder_result) {
+    kolibri_transport_t* ta;
+    kolibri_transport_t* tb;
+    REQUIRE(kolibri_transport_pair(&ta, &tb) == KOLIBRI_OK);
+    
+    responder_t r = { b, tb, {0}, 0 };
+    pthread_t thread;
+    REQUIRE(pthread_create(&thread, NULL, respond, &r) == 0);
+    int result = kolibri_sync_initiate(a, ta, stats);
+    pthread_join(thread, NULL);
+    
+    kolibri_transport_destroy(ta);
+    kolibri_transport_destroy(tb);
+    *responder_result = r.result;
+    return result;
+}
+
+/* Shared formulas plus d/4 new and d/4 newer on each side */
+static void diverge(kolibri_core_t* a, kolibri_core_t* b, uint32_t n, uint32_t d) {
+    for (uint32_t i = 0; i < n; i++) {
+        REQUIRE(put(a, i, 1, 0) == KOLIBRI_OK);
+        REQUIRE(put(b, i, 1, 0) == KOLIBRI_OK);
+    }
+    for (uint32_t k = 0; k < d / 4; k++) {
+        REQUIRE(put(a, n + k, 1, 0) == KOLIBRI_OK);
+        REQUIRE(put(b, n + d + k, 1, 0) == KOLIBRI_OK);
+        REQUIRE(put(a, k, 2, 0) == KOLIBRI_OK);
+        REQUIRE(put(b, n / 2 + k, 3, 0) == KOLIBRI_OK);
+    }
+}
+
+static void test_reconcile(uint32_t n, uint32_t d, int expect_full_list) {
+    kolibri_core_t* a = kolibri_init(NULL);
+    kolibri_core_t* b = kolibri_init(NULL);
+    REQUIRE(a && b);
+    diverge(a, b, n, d);
+    
+    kolibri_sync_stats_t stats;
+    int responder_result;
+    CHECK(run_sync(a, b, &stats, &responder_result) == KOLIBRI_OK);
+    CHECK(responder_result == KOLIBRI_OK);
+    CHECK(stats.formulas_sent == d / 2);
+    CHECK(stats.formulas_received == d / 2);
+    CHECK(stats.full_list == (uint32_t)expect_full_list);
+    CHECK(formula_count(a) == n + d / 2);
+    CHECK(formula_count(b) == n + d / 2);
+    CHECK(same_formulas(a, b, n + 2 * d));
+    
+    /* A second session finds nothing to exchange */
+    CHECK(run_sync(a, b, &stats, &responder_result) == KOLIBRI_OK);
+    CHECK(responder_result == KOLIBRI_OK);
+    CHECK(stats.formulas_sent == 0 && stats.formulas_received == 0);
+    
+    kolibri_destroy(a);
+    kolibri_destroy(b);
+}
+
+/* A trusted key makes either side reject a batch holding one forged record
+ * without storing any of it */
+static void test_trusted_key(void) {
+    uint8_t public_key[32];
+    kolibri_derive_public_key(private_key, public_key);
+    
+    for (int forger = 0; forger < 2; forger++) {
+        kolibri_core_t* a = kolibri_init(NULL);
+        kolibri_core_t* b = kolibri_init(NULL);
+        REQUIRE(a && b);
+        kolibri_core_t* sender = forger == 0 ? a : b;
+        kolibri_core_t* receiver = forger == 0 ? b : a;
+        kolibri_set_trusted_key(receiver, public_key);
+        
+        for (uint32_t i = 0; i < 20; i++) REQUIRE(put(sender, i, 1, 1) == KOLIBRI_OK);
+        kolibri_formula_t forged;
+        char code[64];
+        make_formula(&forged, code, 20, 1);
+        kolibri_sign_formula(&forged, private_key);
+        forged.cost = 99; /* Signed over, so the signature no longer matches */
+        REQUIRE(kolibri_formula_create(sender, &forged) == KOLIBRI_OK);
+        
+        kolibri_sync_stats_t stats;
+        int responder_result;
+        int result = run_sync(a, b, &stats, &responder_result);
+        CHECK((receiver == a ? result : responder_result) == KOLIBRI_ERROR_SIGNATURE);
+        CHECK(formula_count(receiver) == 0);
+        
+        /* Without the forged record the same sync goes through */
+        uint8_t id[KOLIBRI_ID_SIZE];
+        make_id(id, 20);
+        REQUIRE(kolibri_formula_delete(sender, id) == KOLIBRI_OK);
+        CHECK(run_sync(a, b, &stats, &responder_result) == KOLIBRI_OK);
+        CHECK(responder_result == KOLIBRI_OK);
+        CHECK(formula_count(receiver) == 20);
+        
+        kolibri_destroy(a);
+        kolibri_destroy(b);
+    }
+}
+
+/* Received formulas are stored even when they duplicate local ones, or a
+ * refused record would be sent again by every later session */
+static void test_duplicate_threshold(void) {
+    kolibri_core_t* a = kolibri_init(NULL);
+    kolibri_core_t* b = kolibri_init(NULL);
+    REQUIRE(a && b);
+    for (uint32_t i = 0; i < 100; i++) {
+        kolibri_formula_t formula;
+        char code[64];
+        make_formula(&formula, code, i, 1);
+        REQUIRE(kolibri_formula_create(a, &formula) == KOLIBRI_OK);
+        make_id(formula.id, 100 + i); /* Same code under another ID */
+        REQUIRE(kolibri_formula_create(b, &formula) == KOLIBRI_OK);
+    }
+    REQUIRE(kolibri_set_duplicate_threshold(a, 1.0f) == KOLIBRI_OK);
+    REQUIRE(kolibri_set_duplicate_threshold(b, 0.5f) == KOLIBRI_OK);
+    
+    kolibri_sync_stats_t stats;
+    int responder_result;
+    CHECK(run_sync(a, b, &stats, &responder_result) == KOLIBRI_OK);
+    CHECK(responder_result == KOLIBRI_OK);
+    CHECK(stats.formulas_sent == 100 && stats.formulas_received == 100);
+    CHECK(formula_count(a) == 200 && formula_count(b) == 200);
+    CHECK(same_formulas(a, b, 200));
+    
+    CHECK(run_sync(a, b, &stats, &responder_result) == KOLIBRI_OK);
+    CHECK(responder_result == KOLIBRI_OK);
+    CHECK(stats.formulas_sent == 0 && stats.formulas_received == 0);
+    
+    /* Local creates are still refused */
+    kolibri_formula_t formula;
+    char code[64];
+    make_formula(&formula, code, 5, 1);
+    make_id(formula.id, 300);
+    CHECK(kolibri_formula_create(a, &formula) == KOLIBRI_ERROR_DUPLICATE);
+    
+    kolibri_destroy(a);
+    kolibri_destroy(b);
+}
+
+int main(void) {
+    test_reconcile(2000, 40, 0);
+    test_reconcile(10000, 8000, 1);
+    test_trusted_key();
+    test_duplicate_threshold();
+    return TEST_RESULT();
+}
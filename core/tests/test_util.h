@@ -0,0 +1,31 @@
+/**
+ * KOLIBRI.AI Tests - Minimal assertion helpers shared by the ctest programs
+ */
+
+#ifndef KOLIBRI_TEST_UTIL_H
+#define KOLIBRI_TEST_UTIL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int test_failures = 0;
+
+/* Report a failed condition and keep going */
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while (0)
+
+/* Report a failed condition and stop the test program */
+#define REQUIRE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: REQUIRE failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    } \
+} while (0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
+
+#endif /* KOLIBRI_TEST_UTIL_H */
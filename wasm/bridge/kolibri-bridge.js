@@ -8,6 +8,7 @@ export class KolibriWASM {
     this.module = null;
     this.core = null;
     this.chain = null;
+    this.ring = null;
   }
 
   async init(wasmPath = '/kolibri.wasm') {
@@ -47,6 +48,11 @@ export class KolibriWASM {
   }
 
   destroy() {
+    if (this.ring) {
+      this.ring.destroy();
+      this.ring = null;
+    }
+
     if (this.core) {
       this.module.ccall('kolibri_destroy', null, ['number'], [this.core]);
       this.core = null;
@@ -58,27 +64,26 @@ export class KolibriWASM {
     }
   }
 
-  createFormula(formula) {
+  // Submission/completion ring shared with the core (see kolibri_ring.h)
+  createRing(options) {
     if (!this.core) throw new Error('Core not initialized');
+    return new KolibriRing(this.module, this.core, options);
+  }
 
-    // Allocate formula structure in WASM memory
-    const formulaSize = 4096 + 256; // Approximate size
-    const formulaPtr = this.module._malloc(formulaSize);
-    
-    try {
-      // Fill formula structure
-      // (Simplified - in production would properly serialize all fields)
-      const result = this.module.ccall(
-        'kolibri_formula_create',
-        'number',
-        ['number', 'number'],
-        [this.core, formulaPtr]
-      );
+  createFormula(formula) {
+    if (!this.core) throw new Error('Core not initialized');
 
-      return result === 0;
-    } finally {
-      this.module._free(formulaPtr);
+    if (!this.ring) {
+      this.ring = this.createRing({ sqEntries: 64, cqEntries: 64, dataSize: 64 * 1024 });
     }
+
+    let result = -1;
+    this.ring.submitCreate(formula, (completion) => {
+      result = completion.result;
+    });
+    this.ring.flush();
+
+    return result === 0;
   }
 
   getMetrics() {
@@ -150,6 +155,312 @@ export class KolibriWASM {
   }
 }
 
+// Ring layout constants, mirroring kolibri_ring.h
+const RING_HEADER_SIZE = 192;
+const RING_SQE_SIZE = 64;
+const RING_CQE_SIZE = 16;
+// Index positions as u32 slots of the header
+const RING_SQ_TAIL = 16;
+const RING_CQ_HEAD = 17;
+const RING_SQ_HEAD = 32;
+const RING_CQ_TAIL = 33;
+const RING_FORMULA_HEADER_SIZE = 124;
+const RING_MAX_FORMULA_RECORD = RING_FORMULA_HEADER_SIZE + 2 * 16 * 64 + 8 * 32 + 32 * 32 + 4096;
+
+export const RING_OP_EXECUTE = 1;
+export const RING_OP_GET = 2;
+export const RING_OP_CREATE = 3;
+
+const textEncoder = new TextEncoder();
+const textDecoder = new TextDecoder();
+
+function toBytes(data) {
+  if (data instanceof Uint8Array) return data;
+  if (typeof data === 'string') return textEncoder.encode(data);
+  if (Array.isArray(data)) return Uint8Array.from(data);
+  return new Uint8Array(0);
+}
+
+// Length-prefixed string, truncated to the core's field size
+function stringBytes(s, capacity) {
+  const bytes = textEncoder.encode(s || '');
+  return bytes.subarray(0, Math.min(bytes.length, capacity - 1));
+}
+
+/**
+ * Encode a formula as a ring formula record.
+ * formula: { id, version, cost, fitness, timestamp, inputs, outputs,
+ *            provenances, tags, signature, code } where id, provenances,
+ *            signature and code are byte arrays (code may be a string).
+ */
+export function encodeFormulaRecord(formula) {
+  const inputs = (formula.inputs || []).slice(0, 16).map((s) => stringBytes(s, 64));
+  const outputs = (formula.outputs || []).slice(0, 16).map((s) => stringBytes(s, 64));
+  const tags = (formula.tags || []).slice(0, 32).map((s) => stringBytes(s, 32));
+  const provenances = (formula.provenances || []).slice(0, 8).map(toBytes);
+  const code = toBytes(formula.code);
+
+  let size = RING_FORMULA_HEADER_SIZE + provenances.length * 32 + code.length;
+  for (const s of [...inputs, ...outputs, ...tags]) size += 1 + s.length;
+
+  const record = new Uint8Array(size);
+  const view = new DataView(record.buffer);
+  if (formula.id) record.set(toBytes(formula.id).subarray(0, 32), 0);
+  view.setUint32(32, formula.version || 0, true);
+  view.setUint32(36, formula.cost || 0, true);
+  view.setFloat32(40, formula.fitness || 0, true);
+  view.setBigUint64(44, BigInt(formula.timestamp || 0), true);
+  view.setUint32(52, code.length, true);
+  record[56] = inputs.length;
+  record[57] = outputs.length;
+  record[58] = provenances.length;
+  record[59] = tags.length;
+  if (formula.signature) record.set(toBytes(formula.signature).subarray(0, 64), 60);
+
+  let offset = RING_FORMULA_HEADER_SIZE;
+  const putString = (s) => {
+    record[offset++] = s.length;
+    record.set(s, offset);
+    offset += s.length;
+  };
+  inputs.forEach(putString);
+  outputs.forEach(putString);
+  for (const p of provenances) {
+    record.set(p.subarray(0, 32), offset);
+    offset += 32;
+  }
+  tags.forEach(putString);
+  record.set(code, offset);
+
+  return record;
+}
+
+export function decodeFormulaRecord(bytes) {
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  const formula = {
+    id: bytes.slice(0, 32),
+    version: view.getUint32(32, true),
+    cost: view.getUint32(36, true),
+    fitness: view.getFloat32(40, true),
+    timestamp: Number(view.getBigUint64(44, true)),
+    signature: bytes.slice(60, 124),
+    inputs: [],
+    outputs: [],
+    provenances: [],
+    tags: []
+  };
+  const codeSize = view.getUint32(52, true);
+
+  let offset = RING_FORMULA_HEADER_SIZE;
+  const getString = () => {
+    const len = bytes[offset++];
+    const s = textDecoder.decode(bytes.subarray(offset, offset + len));
+    offset += len;
+    return s;
+  };
+  for (let i = 0; i < bytes[56]; i++) formula.inputs.push(getString());
+  for (let i = 0; i < bytes[57]; i++) formula.outputs.push(getString());
+  for (let i = 0; i < bytes[58]; i++) {
+    formula.provenances.push(bytes.slice(offset, offset + 32));
+    offset += 32;
+  }
+  for (let i = 0; i < bytes[59]; i++) formula.tags.push(getString());
+  formula.code = bytes.slice(offset, offset + codeSize);
+
+  return formula;
+}
+
+// values: [{ type, data }] with type 0=int, 1=float, 2=string, 3=binary
+export function encodeValueList(values) {
+  const parts = values.map((v) => ({ type: v.type || 0, data: toBytes(v.data) }));
+  const size = parts.reduce((n, v) => n + 5 + v.data.length, 4);
+  const bytes = new Uint8Array(size);
+  const view = new DataView(bytes.buffer);
+
+  view.setUint32(0, parts.length, true);
+  let offset = 4;
+  for (const v of parts) {
+    bytes[offset] = v.type;
+    view.setUint32(offset + 1, v.data.length, true);
+    bytes.set(v.data, offset + 5);
+    offset += 5 + v.data.length;
+  }
+
+  return bytes;
+}
+
+export function decodeValueList(bytes) {
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  const values = [];
+  let offset = 4;
+  for (let i = view.getUint32(0, true); i > 0; i--) {
+    const size = view.getUint32(offset + 1, true);
+    values.push({ type: bytes[offset], data: bytes.slice(offset + 5, offset + 5 + size) });
+    offset += 5 + size;
+  }
+  return values;
+}
+
+/**
+ * Batched access to the core through a submission/completion ring in WASM
+ * memory. submit* calls only write to memory; flush() crosses into the core
+ * once for everything queued and invokes each request's callback.
+ */
+export class KolibriRing {
+  constructor(module, core, { sqEntries = 256, cqEntries = 256, dataSize = 1 << 20 } = {}) {
+    this.module = module;
+    this.core = core;
+    this.sqEntries = sqEntries;
+    this.cqEntries = cqEntries;
+    this.dataSize = dataSize;
+
+    const size = module.ccall('kolibri_ring_size', 'number', ['number', 'number', 'number'],
+      [sqEntries, cqEntries, dataSize]);
+    this.ptr = size ? module._malloc(size) : 0;
+    if (!this.ptr || !module.ccall('kolibri_ring_init', 'number',
+      ['number', 'number', 'number', 'number', 'number'],
+      [this.ptr, size, sqEntries, cqEntries, dataSize])) {
+      if (this.ptr) module._free(this.ptr);
+      throw new Error('Failed to create ring');
+    }
+
+    this.sqOffset = RING_HEADER_SIZE;
+    this.cqOffset = this.sqOffset + sqEntries * RING_SQE_SIZE;
+    this.dataOffset = this.cqOffset + cqEntries * RING_CQE_SIZE;
+    this.dataUsed = 0;
+    this.nextUserData = 1;
+    this.pending = new Map();
+  }
+
+  // Views are re-created when memory growth replaces the buffer
+  view() {
+    const buffer = this.module.HEAPU8.buffer;
+    if (this.buffer !== buffer) {
+      this.buffer = buffer;
+      this.dataView = new DataView(buffer, this.ptr);
+      this.indices = new Uint32Array(buffer, this.ptr, RING_HEADER_SIZE / 4);
+    }
+    return this.dataView;
+  }
+
+  bytes(offset, length) {
+    return this.module.HEAPU8.subarray(this.ptr + offset, this.ptr + offset + length);
+  }
+
+  // Reserve data area space, flushing first if the batch has filled it
+  alloc(length) {
+    const aligned = (length + 7) & ~7;
+    if (aligned > this.dataSize) throw new Error('Request larger than ring data area');
+    if (this.dataUsed + aligned > this.dataSize) this.flush();
+    if (this.dataUsed + aligned > this.dataSize) throw new Error('Ring data area is full');
+    const offset = this.dataOffset + this.dataUsed;
+    this.dataUsed += aligned;
+    return offset;
+  }
+
+  submit(opcode, id, input, outLen, decode, callback) {
+    this.view();
+    if (((Atomics.load(this.indices, RING_SQ_TAIL) - Atomics.load(this.indices, RING_SQ_HEAD)) >>> 0) >=
+        this.sqEntries) {
+      this.flush();
+    }
+
+    // Input and output in one reservation so a flush cannot split them
+    const inSize = input ? (input.length + 7) & ~7 : 0;
+    const base = this.alloc(inSize + outLen);
+    const inOffset = input ? base : 0;
+    const outOffset = outLen ? base + inSize : 0;
+    if (input) this.bytes(inOffset, input.length).set(input);
+
+    const view = this.view();
+    const tail = this.indices[RING_SQ_TAIL];
+    const sqe = this.sqOffset + (tail & (this.sqEntries - 1)) * RING_SQE_SIZE;
+    const userData = this.nextUserData++;
+    this.bytes(sqe, RING_SQE_SIZE).fill(0);
+    view.setBigUint64(sqe, BigInt(userData), true);
+    view.setUint8(sqe + 8, opcode);
+    view.setUint32(sqe + 12, inOffset, true);
+    view.setUint32(sqe + 16, input ? input.length : 0, true);
+    view.setUint32(sqe + 20, outOffset, true);
+    view.setUint32(sqe + 24, outLen, true);
+    if (id) this.bytes(sqe + 32, 32).set(toBytes(id).subarray(0, 32));
+    Atomics.store(this.indices, RING_SQ_TAIL, (tail + 1) >>> 0);
+
+    this.pending.set(userData, { outOffset, decode, callback });
+    return userData;
+  }
+
+  submitExecute(id, values, callback, outLen = 4096) {
+    return this.submit(RING_OP_EXECUTE, id, encodeValueList(values), outLen,
+      (bytes) => ({ values: decodeValueList(bytes) }), callback);
+  }
+
+  submitGet(id, callback) {
+    return this.submit(RING_OP_GET, id, null, RING_MAX_FORMULA_RECORD,
+      (bytes) => ({ formula: decodeFormulaRecord(bytes) }), callback);
+  }
+
+  submitCreate(formula, callback) {
+    return this.submit(RING_OP_CREATE, null, encodeFormulaRecord(formula), 32,
+      (bytes) => ({ id: bytes.slice(0, 32) }), callback);
+  }
+
+  // Process everything queued, one call into the core per completion
+  // queue's worth, and run the callbacks; returns the completions reaped
+  flush() {
+    let total = 0;
+    while (this.pending.size > 0) {
+      const result = this.module._kolibri_ring_process(this.core, this.ptr, 0, 0);
+      if (result !== 0) throw new Error(`Ring processing failed: ${result}`);
+      const reaped = this.reap();
+      total += reaped;
+      if (reaped === 0) break;
+    }
+    if (this.pending.size === 0) this.dataUsed = 0;
+    return total;
+  }
+
+  reap() {
+    const view = this.view();
+    let head = this.indices[RING_CQ_HEAD];
+    const tail = Atomics.load(this.indices, RING_CQ_TAIL);
+    const done = [];
+
+    while (head !== tail) {
+      const cqe = this.cqOffset + (head & (this.cqEntries - 1)) * RING_CQE_SIZE;
+      const userData = Number(view.getBigUint64(cqe, true));
+      const result = view.getInt32(cqe + 8, true);
+      const len = view.getUint32(cqe + 12, true);
+      head = (head + 1) >>> 0;
+
+      const request = this.pending.get(userData);
+      if (!request) continue;
+      this.pending.delete(userData);
+
+      const completion = { result, len };
+      if (result === 0 && request.decode) {
+        Object.assign(completion, request.decode(this.bytes(request.outOffset, len)));
+      }
+      done.push([request.callback, completion]);
+    }
+
+    // Callbacks run after the slots are released, so they may submit more
+    Atomics.store(this.indices, RING_CQ_HEAD, head);
+    for (const [callback, completion] of done) {
+      if (callback) callback(completion);
+    }
+    return done.length;
+  }
+
+  destroy() {
+    if (this.ptr) {
+      this.module._free(this.ptr);
+      this.ptr = 0;
+    }
+    this.pending.clear();
+  }
+}
+
 // Worker pool for cluster execution
 export class KolibriCluster {
   constructor(size = 10) {
@@ -14,8 +14,8 @@ echo "Building Kolibri WASM module..."
 emcc \
     -O2 \
     -s WASM=1 \
-    -s EXPORTED_FUNCTIONS='["_kolibri_init","_kolibri_destroy","_kolibri_formula_create","_kolibri_formula_get","_kolibri_formula_update","_kolibri_formula_delete","_kolibri_formula_list","_kolibri_formula_execute","_kolibri_formula_mutate","_kolibri_formula_crossover","_kolibri_storage_export","_kolibri_storage_import","_kolibri_get_metrics","_kolibri_sign_formula","_kolibri_verify_formula","_chain_init","_chain_destroy","_chain_create_block","_chain_add_block","_chain_get_block","_chain_get_latest_block","_chain_verify_block","_chain_get_info","_chain_export","_chain_import","_malloc","_free"]' \
-    -s EXPORTED_RUNTIME_METHODS='["cwrap","ccall","getValue","setValue"]' \
+    -s EXPORTED_FUNCTIONS='["_kolibri_init","_kolibri_destroy","_kolibri_formula_create","_kolibri_formula_get","_kolibri_formula_update","_kolibri_formula_delete","_kolibri_formula_list","_kolibri_formula_execute","_kolibri_formula_mutate","_kolibri_formula_crossover","_kolibri_storage_export","_kolibri_storage_import","_kolibri_storage_export_pack","_kolibri_storage_import_pack","_kolibri_get_metrics","_kolibri_sign_formula","_kolibri_verify_formula","_kolibri_derive_public_key","_kolibri_verify_formula_batch","_kolibri_set_trusted_key","_kolibri_formula_find_similar","_kolibri_set_duplicate_threshold","_kolibri_generate_id","_kolibri_ring_size","_kolibri_ring_init","_kolibri_ring_process","_kolibri_tokenize","_kolibri_dict_build","_kolibri_dict_free","_kolibri_dict_lookup","_kolibri_dict_map","_kolibri_dict_count_matches","_kolibri_signal_init","_kolibri_signal_update","_kolibri_signal_normalize","_chain_init","_chain_destroy","_chain_create_block","_chain_add_block","_chain_get_block","_chain_get_latest_block","_chain_verify_block","_chain_get_info","_chain_export","_chain_import","_chain_export_pack","_chain_import_pack","_chain_verify_file","_malloc","_free"]' \
+    -s EXPORTED_RUNTIME_METHODS='["cwrap","ccall","getValue","setValue","HEAPU8"]' \
     -s ALLOW_MEMORY_GROWTH=1 \
     -s INITIAL_MEMORY=16777216 \
     -s MODULARIZE=1 \
@@ -23,6 +23,14 @@ emcc \
     -I"$SCRIPT_DIR/../core/include" \
     -I"$SCRIPT_DIR/../chain/include" \
     "$SCRIPT_DIR/../core/src/kolibri_core.c" \
+    "$SCRIPT_DIR/../core/src/kolibri_sha256.c" \
+    "$SCRIPT_DIR/../core/src/kolibri_ed25519.c" \
+    "$SCRIPT_DIR/../core/src/kolibri_pack.c" \
+    "$SCRIPT_DIR/../core/src/kolibri_sync.c" \
+    "$SCRIPT_DIR/../core/src/kolibri_analytics.c" \
+    "$SCRIPT_DIR/../core/src/kolibri_ring.c" \
+    "$SCRIPT_DIR/../core/src/kolibri_perception.c" \
+    "$SCRIPT_DIR/../core/src/kolibri_shared.c" \
     "$SCRIPT_DIR/../chain/src/kolibri_chain.c" \
     -o "$BUILD_DIR/kolibri.js"
 